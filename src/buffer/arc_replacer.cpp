@@ -0,0 +1,130 @@
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+void ARCReplacer::GhostList::PushBack(page_id_t page_id) {
+  list_.push_back(page_id);
+  map_[page_id] = --list_.end();
+}
+
+void ARCReplacer::GhostList::PopFront() {
+  map_.erase(list_.front());
+  list_.pop_front();
+}
+
+bool ARCReplacer::GhostList::Erase(page_id_t page_id) {
+  auto it = map_.find(page_id);
+  if (it == map_.end()) return false;
+  list_.erase(it->second);
+  map_.erase(it);
+  return true;
+}
+
+ARCReplacer::ARCReplacer(size_t num_pages) : capacity_(num_pages == 0 ? 1 : num_pages) {}
+
+ARCReplacer::~ARCReplacer() = default;
+
+bool ARCReplacer::Victim(frame_id_t *frame_id) {
+  if (evictable_count_ == 0) return false;
+  // REPLACE(p): shrink T1 while it is above its target, otherwise T2
+  ListType first = (!t1_.empty() && t1_.size() > p_) || t2_.empty() ? T1 : T2;
+  ListType second = first == T1 ? T2 : T1;
+  return EvictFrom(first, frame_id) || EvictFrom(second, frame_id);
+}
+
+bool ARCReplacer::EvictFrom(ListType list_type, frame_id_t *frame_id) {
+  auto &resident = Resident(list_type);
+  for (auto it = resident.begin(); it != resident.end(); ++it) {
+    FrameInfo &info = frames_[*it];
+    if (!info.evictable_) continue;
+    *frame_id = *it;
+    if (info.page_id_ != INVALID_PAGE_ID) {
+      (list_type == T1 ? b1_ : b2_).PushBack(info.page_id_);
+    }
+    resident.erase(it);
+    frames_.erase(*frame_id);
+    evictable_count_--;
+    TrimGhosts();
+    return true;
+  }
+  return false;
+}
+
+void ARCReplacer::Pin(frame_id_t frame_id) {
+  auto it = frames_.find(frame_id);
+  // frames are registered by Admit
+  if (it == frames_.end()) return;
+  FrameInfo &info = it->second;
+  if (info.evictable_) {
+    info.evictable_ = false;
+    evictable_count_--;
+  }
+  if (!info.referenced_) {
+    // the reference that loaded the page is not a re-reference
+    info.referenced_ = true;
+    return;
+  }
+  // a hit in T1 or T2 moves the frame to the MRU end of T2
+  Resident(info.list_).erase(info.pos_);
+  t2_.push_back(frame_id);
+  info.list_ = T2;
+  info.pos_ = --t2_.end();
+}
+
+void ARCReplacer::Unpin(frame_id_t frame_id) {
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) {
+    // unknown frame, admit it without a page id so it leaves no ghost behind
+    Admit(frame_id, INVALID_PAGE_ID);
+    it = frames_.find(frame_id);
+  }
+  if (!it->second.evictable_) {
+    it->second.evictable_ = true;
+    evictable_count_++;
+  }
+}
+
+void ARCReplacer::Admit(frame_id_t frame_id, page_id_t page_id) {
+  Remove(frame_id);
+  ListType list_type = T1;
+  if (page_id != INVALID_PAGE_ID) {
+    size_t b1_size = b1_.Size(), b2_size = b2_.Size();
+    if (b1_.Erase(page_id)) {
+      // recency was undervalued, grow T1
+      p_ = min(capacity_, p_ + max<size_t>(b2_size / b1_size, 1));
+      ghost_hits_++;
+      list_type = T2;
+    } else if (b2_.Erase(page_id)) {
+      // frequency was undervalued, shrink T1
+      size_t delta = max<size_t>(b1_size / b2_size, 1);
+      p_ = p_ > delta ? p_ - delta : 0;
+      ghost_hits_++;
+      list_type = T2;
+    }
+  }
+  auto &resident = Resident(list_type);
+  resident.push_back(frame_id);
+  frames_[frame_id] = {list_type, --resident.end(), page_id, false, false};
+  TrimGhosts();
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) return;
+  if (it->second.evictable_) evictable_count_--;
+  Resident(it->second.list_).erase(it->second.pos_);
+  frames_.erase(it);
+}
+
+void ARCReplacer::TrimGhosts() {
+  while (b1_.Size() > 0 && t1_.size() + b1_.Size() > capacity_) {
+    b1_.PopFront();
+  }
+  while (b2_.Size() > 0 && t1_.size() + t2_.size() + b1_.Size() + b2_.Size() > 2 * capacity_) {
+    b2_.PopFront();
+  }
+}
+
+size_t ARCReplacer::Size() {
+  return evictable_count_;
+}
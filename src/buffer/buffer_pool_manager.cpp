@@ -1,33 +1,98 @@
 #include "buffer/buffer_pool_manager.h"
 
+#include <sys/mman.h>
+
+#include <cstdlib>
+#include <new>
+
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 
 static const char EMPTY_PAGE_DATA[PAGE_SIZE] = { 0 };
 
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager* disk_manager)
-	: pool_size_(pool_size), disk_manager_(disk_manager) {
-	pages_ = new Page[pool_size_];
-	replacer_ = new LRUReplacer(pool_size_);
+/**
+ * @param num_pages upper bound of the frame ids passed to the replacer
+ * @param num_frames number of frames the replacer actually manages
+ */
+static Replacer* MakeReplacer(ReplacerType replacer_type, size_t num_pages, size_t num_frames, size_t replacer_k) {
+	switch (replacer_type) {
+		case ReplacerType::kARC:
+			return new ARCReplacer(num_frames);
+		case ReplacerType::kClock:
+			return new CLOCKReplacer(num_pages);
+		case ReplacerType::kLRUK:
+			return new LRUKReplacer(num_pages, replacer_k);
+		case ReplacerType::kLRU:
+		default:
+			return new LRUReplacer(num_pages);
+	}
+}
+
+/**
+ * Allocate the zeroed data of num_frames frames in one PAGE_SIZE aligned block, to be released with free().
+ */
+static char* AllocateFrameArena(size_t num_frames) {
+	size_t size = num_frames * PAGE_SIZE;
+	size_t alignment = PAGE_SIZE;
+	if (FRAME_ARENA_HUGE_PAGES && size >= HUGE_PAGE_SIZE) alignment = HUGE_PAGE_SIZE;
+	// aligned_alloc wants a multiple of the alignment
+	size_t alloc_size = (size + alignment - 1) / alignment * alignment;
+	if (alloc_size == 0) alloc_size = alignment;
+	auto arena = static_cast<char*>(aligned_alloc(alignment, alloc_size));
+	if (arena == nullptr) throw std::bad_alloc();
+	if (alignment == HUGE_PAGE_SIZE && madvise(arena, alloc_size, MADV_HUGEPAGE) != 0) {
+		// only a hint, the kernel may be built without transparent huge pages
+		LOG(INFO) << "madvise(MADV_HUGEPAGE) failed for the buffer pool frames, using regular pages";
+	}
+	memset(arena, 0, size);
+	return arena;
+}
+
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager* disk_manager, size_t num_shards,
+                                     ReplacerType replacer_type, size_t replacer_k)
+	: pool_size_(pool_size),
+	  disk_manager_(disk_manager),
+	  disk_scheduler_(std::make_shared<DiskScheduler>(disk_manager)),
+	  pending_reads_(pool_size),
+	  num_shards_(num_shards == 0 ? 1 : num_shards) {
+	frame_arena_ = AllocateFrameArena(pool_size_);
+	pages_ = static_cast<Page*>(::operator new(pool_size_ * sizeof(Page)));
+	for (size_t i = 0; i < pool_size_; i++) {
+		new (&pages_[i]) Page(frame_arena_ + i * PAGE_SIZE);
+	}
+	shards_ = new Shard[num_shards_];
+	for (size_t i = 0; i < num_shards_; i++) {
+		// frame ids are global, so every replacer must accept ids up to pool_size_
+		size_t num_frames = pool_size_ / num_shards_ + (i < pool_size_ % num_shards_ ? 1 : 0);
+		shards_[i].replacer_ = MakeReplacer(replacer_type, pool_size_, num_frames, replacer_k);
+	}
 	for (size_t i = 0; i < pool_size_; i++) {
-		free_list_.emplace_back(i);
+		shards_[i % num_shards_].free_list_.emplace_back(i);
 	}
 }
 
 BufferPoolManager::~BufferPoolManager() {
-	for (auto page : page_table_) {
-		FlushPage(page.first);
+	StopPrefetcher();
+	StopBackgroundFlusher();
+	for (size_t i = 0; i < num_shards_; i++) {
+		for (auto page : shards_[i].page_table_) {
+			FlushPage(page.first);
+		}
+		delete shards_[i].replacer_;
+	}
+	delete[] shards_;
+	for (size_t i = 0; i < pool_size_; i++) {
+		pages_[i].~Page();
 	}
-	delete[] pages_;
-	delete replacer_;
+	::operator delete(pages_);
+	free(frame_arena_);
 }
 
 /**
  * TODO: Student Implement (finished)
- * @brief: Flushes all the pages in the buffer pool to disk
- * @note: This function is not thread safe
- * @note: This function should be called by the disk manager when a page is read from disk
- * @param page_id: the page id of the page that was read from disk
+ * @brief: Fetches the requested page from the buffer pool, reading it from disk if it is not cached
+ * @note: Only the shard owning page_id is latched, so fetches of pages in other shards proceed in parallel
+ * @param page_id: the page id of the page to fetch
  */
 Page* BufferPoolManager::FetchPage(page_id_t page_id) {
 	// 1.    Search the page table for the requested page (P).
@@ -37,37 +102,37 @@ Page* BufferPoolManager::FetchPage(page_id_t page_id) {
 	// 2.    If R is dirty, write it back to the disk.
 	// 3.    Delete R from the page table and insert P.
 	// 4.    Update P's metadata, read in the page content from disk, and then return a pointer to P.
-	if (page_table_.find(page_id) != page_table_.end()) {
-		frame_id_t frame_id = page_table_[page_id];
+	Shard* shard = ShardOf(page_id);
+	if (shard == nullptr) return nullptr;
+	scoped_lock<recursive_mutex> lock(shard->latch_);
+	auto it = shard->page_table_.find(page_id);
+	if (it != shard->page_table_.end()) {
+		frame_id_t frame_id = it->second;
+		// read-ahead may still be loading the page
+		if (pending_reads_[frame_id].valid()) pending_reads_[frame_id].wait();
 		pages_[frame_id].pin_count_++;
-		replacer_->Pin(frame_id);
+		shard->replacer_->Pin(frame_id);
+		shard->hit_count_++;
 		return &pages_[frame_id];
 	}
-	frame_id_t frame_id = INVALID_FRAME_ID;
-	if (!free_list_.empty()) {
-		frame_id = free_list_.front();
-		free_list_.pop_front();
-	}
-	else {
-		if (!replacer_->Victim(&frame_id)) return nullptr;
-	}
-	if (pages_[frame_id].IsDirty()) FlushPage(pages_[frame_id].GetPageId());
-	page_table_.erase(pages_[frame_id].GetPageId());
-	page_table_[page_id] = frame_id;
-	pages_[frame_id].ResetMemory();
+	frame_id_t frame_id = TryToFindFreePage(*shard);
+	if (frame_id == INVALID_FRAME_ID) return nullptr;
+	shard->miss_count_++;
+	shard->page_table_[page_id] = frame_id;
 	pages_[frame_id].pin_count_ = 1;
 	pages_[frame_id].is_dirty_ = false;
 	pages_[frame_id].page_id_ = page_id;
-	disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
-	replacer_->Pin(frame_id);
+	disk_scheduler_->ReadPage(page_id, pages_[frame_id].GetData());
+	shard->replacer_->Admit(frame_id, page_id);
+	shard->replacer_->Pin(frame_id);
 	return &pages_[frame_id];
 }
 
 /**
  * TODO: Student Implement (finished)
- * @note: This function is not thread safe
- * @note: This function should be called by the disk manager when a page is written to disk
- * @param page_id: the page id of the page that was written to disk
+ * @brief: Allocates a new page on disk and pins it in the buffer pool
+ * @note: The page id is allocated before the owning shard is known; it is given back if that shard is full
+ * @param page_id: output parameter for the id of the new page
  */
 Page* BufferPoolManager::NewPage(page_id_t& page_id) {
 	// 0.   Make sure you call AllocatePage!
@@ -75,52 +140,96 @@ Page* BufferPoolManager::NewPage(page_id_t& page_id) {
 	// 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
 	// 3.   Update P's metadata, zero out memory and add P to the page table.
 	// 4.   Set the page ID output parameter. Return a pointer to P.
-	if (free_list_.empty() && replacer_->Size() == 0) return nullptr;
-	frame_id_t frame_id = INVALID_FRAME_ID;
-	if (!free_list_.empty()) {
-		frame_id = free_list_.front();
-		free_list_.pop_front();
+	page_id_t new_page_id = AllocatePage();
+	if (new_page_id == INVALID_PAGE_ID) return nullptr;
+	Page* page = NewPageWithId(new_page_id);
+	if (page == nullptr) {
+		DeallocatePage(new_page_id);
+		return nullptr;
 	}
-	else {
-		if (!replacer_->Victim(&frame_id)) return nullptr;
+	page_id = new_page_id;
+	return page;
+}
+
+Page* BufferPoolManager::NewPage(page_id_t& page_id, PageRun& run) {
+	if (run.next_ == run.end_) {
+		page_id_t start = disk_manager_->AllocatePageRun(DEFAULT_PAGE_RUN_SIZE);
+		if (start == INVALID_PAGE_ID) return NewPage(page_id);
+		run.next_ = start;
+		run.end_ = start + DEFAULT_PAGE_RUN_SIZE;
 	}
-	if (pages_[frame_id].IsDirty()) FlushPage(pages_[frame_id].GetPageId());
-	page_table_.erase(pages_[frame_id].GetPageId());
-	page_id = AllocatePage();
-	page_table_[page_id] = frame_id;
-	pages_[frame_id].ResetMemory();
+	// the page id stays in the run if no frame is available
+	Page* page = NewPageWithId(run.next_);
+	if (page == nullptr) return nullptr;
+	page_id = run.next_++;
+	return page;
+}
+
+void BufferPoolManager::ReleasePageRun(PageRun& run) {
+	for (page_id_t page_id = run.next_; page_id != run.end_; page_id++) {
+		disk_manager_->DeAllocatePage(page_id);
+	}
+	run.next_ = run.end_ = INVALID_PAGE_ID;
+}
+
+Page* BufferPoolManager::NewPageWithId(page_id_t page_id) {
+	Shard* shard = ShardOf(page_id);
+	if (shard == nullptr) return nullptr;
+	scoped_lock<recursive_mutex> lock(shard->latch_);
+	auto it = shard->page_table_.find(page_id);
+	if (it != shard->page_table_.end()) {
+		// a stale copy left behind by read-ahead racing with the deallocation of this page
+		frame_id_t stale_frame_id = it->second;
+		if (pages_[stale_frame_id].GetPinCount() != 0) return nullptr;
+		shard->replacer_->Remove(stale_frame_id);
+		shard->page_table_.erase(it);
+		pages_[stale_frame_id].page_id_ = INVALID_PAGE_ID;
+		pages_[stale_frame_id].is_dirty_ = false;
+		shard->free_list_.push_back(stale_frame_id);
+	}
+	frame_id_t frame_id = TryToFindFreePage(*shard);
+	if (frame_id == INVALID_FRAME_ID) return nullptr;
+	shard->page_table_[page_id] = frame_id;
 	pages_[frame_id].pin_count_ = 1;
 	pages_[frame_id].is_dirty_ = false;
 	pages_[frame_id].page_id_ = page_id;
-	replacer_->Pin(frame_id);
+	shard->replacer_->Admit(frame_id, page_id);
+	shard->replacer_->Pin(frame_id);
 	return &pages_[frame_id];
 }
 
 /**
  * TODO: Student Implement (finished)
  * @brief: delete the page from the buffer pool and from the disk
- * @note: This function is not thread safe
- * @note: This function should be called by the disk manager when a page is written to disk
- * @param page_id: the page id of the page that was written to disk
+ * @param page_id: the page id of the page to delete
+ * @return false if the page is still pinned, true otherwise
  */
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
 	// 0.   Make sure you call DeallocatePage!
 	// 1.   Search the page table for the requested page (P).
-	// 1.   If P does not exist, return true.
+	// 1.   If P does not exist, deallocate it on disk and return true.
 	// 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
 	// 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-	if (page_table_.find(page_id) == page_table_.end()) return true;
-	frame_id_t frame_id = page_table_[page_id];
+	Shard* shard = ShardOf(page_id);
+	if (shard == nullptr) return false;
+	scoped_lock<recursive_mutex> lock(shard->latch_);
+	auto it = shard->page_table_.find(page_id);
+	if (it == shard->page_table_.end()) {
+		// not cached, but it still has to be given back on disk
+		if (!disk_manager_->IsPageFree(page_id)) DeallocatePage(page_id);
+		return true;
+	}
+	frame_id_t frame_id = it->second;
 	if (pages_[frame_id].GetPinCount() != 0) return false;
-	if (pages_[frame_id].IsDirty()) FlushPage(page_id);
+	if (pages_[frame_id].IsDirty()) FlushFrame(frame_id);
 	DeallocatePage(page_id);
-	page_table_.erase(page_id);
+	shard->page_table_.erase(it);
 	pages_[frame_id].ResetMemory();
 	pages_[frame_id].pin_count_ = 0;
 	pages_[frame_id].is_dirty_ = false;
 	pages_[frame_id].page_id_ = INVALID_PAGE_ID;
-	free_list_.push_back(frame_id);
-	replacer_->Pin(frame_id);
+	shard->free_list_.push_back(frame_id);
+	shard->replacer_->Remove(frame_id);
 	return true;
 }
 
@@ -139,29 +248,289 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
  * @return True if the page was successfully unpinned, false otherwise.
  */
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
-	if (page_table_.find(page_id) == page_table_.end()) return false;
-	frame_id_t frame_id = page_table_[page_id];
+	Shard* shard = ShardOf(page_id);
+	if (shard == nullptr) return false;
+	scoped_lock<recursive_mutex> lock(shard->latch_);
+	auto it = shard->page_table_.find(page_id);
+	if (it == shard->page_table_.end()) return false;
+	frame_id_t frame_id = it->second;
 	if (pages_[frame_id].GetPinCount() == 0) return false;
 	if (is_dirty) pages_[frame_id].is_dirty_ = true;
-	if (!--pages_[frame_id].pin_count_) replacer_->Unpin(frame_id);
+	if (!--pages_[frame_id].pin_count_) shard->replacer_->Unpin(frame_id);
 	return true;
 }
 
 /**
  * TODO: Student Implement (finished)
  * @brief: flushes the page to disk
- * @note: This function is not thread safe
  * @param page_id: the page id of the page to flush
  * @return true if the operation is successful, false otherwise
  */
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
-	if (page_table_.find(page_id) == page_table_.end()) return false;
-	frame_id_t frame_id = page_table_[page_id];
-	disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
-	pages_[frame_id].is_dirty_ = false;
+	Shard* shard = ShardOf(page_id);
+	if (shard == nullptr) return false;
+	scoped_lock<recursive_mutex> lock(shard->latch_);
+	auto it = shard->page_table_.find(page_id);
+	if (it == shard->page_table_.end()) return false;
+	FlushFrame(it->second);
 	return true;
 }
 
+size_t BufferPoolManager::GetHitCount() {
+	size_t count = 0;
+	for (size_t i = 0; i < num_shards_; i++) {
+		scoped_lock<recursive_mutex> lock(shards_[i].latch_);
+		count += shards_[i].hit_count_;
+	}
+	return count;
+}
+
+size_t BufferPoolManager::GetMissCount() {
+	size_t count = 0;
+	for (size_t i = 0; i < num_shards_; i++) {
+		scoped_lock<recursive_mutex> lock(shards_[i].latch_);
+		count += shards_[i].miss_count_;
+	}
+	return count;
+}
+
+size_t BufferPoolManager::GetGhostHitCount() {
+	size_t count = 0;
+	for (size_t i = 0; i < num_shards_; i++) {
+		scoped_lock<recursive_mutex> lock(shards_[i].latch_);
+		count += shards_[i].replacer_->GetGhostHitCount();
+	}
+	return count;
+}
+
+void BufferPoolManager::PrefetchPages(page_id_t start, size_t n, NextPageFunc next_page) {
+	if (start == INVALID_PAGE_ID || n == 0) return;
+	{
+		scoped_lock<std::mutex> lock(prefetch_latch_);
+		if (!prefetch_running_) {
+			prefetch_running_ = true;
+			prefetch_thread_ = std::thread(&BufferPoolManager::PrefetchLoop, this);
+		}
+		// old hints are the least useful ones
+		if (prefetch_queue_.size() >= MAX_PREFETCH_REQUESTS) prefetch_queue_.pop_front();
+		prefetch_queue_.push_back({start, n, std::move(next_page)});
+	}
+	prefetch_cv_.notify_one();
+}
+
+size_t BufferPoolManager::GetPrefetchCount() {
+	return prefetch_count_;
+}
+
+void BufferPoolManager::PrefetchLoop() {
+	std::unique_lock<std::mutex> lock(prefetch_latch_);
+	while (true) {
+		prefetch_cv_.wait(lock, [this]() { return !prefetch_running_ || !prefetch_queue_.empty(); });
+		if (!prefetch_running_) return;
+		PrefetchRequest request = std::move(prefetch_queue_.front());
+		prefetch_queue_.pop_front();
+		lock.unlock();
+		Prefetch(request);
+		lock.lock();
+	}
+}
+
+void BufferPoolManager::StopPrefetcher() {
+	{
+		scoped_lock<std::mutex> lock(prefetch_latch_);
+		if (!prefetch_running_) return;
+		prefetch_running_ = false;
+		prefetch_queue_.clear();
+	}
+	prefetch_cv_.notify_one();
+	prefetch_thread_.join();
+}
+
+/**
+ * Without next_page the pages of a request are independent, so all reads are scheduled before waiting for any.
+ * A chain has to be followed one page at a time, but the shard latch is still released while a read is in flight.
+ */
+void BufferPoolManager::Prefetch(const PrefetchRequest& request) {
+	std::vector<std::pair<page_id_t, std::shared_future<bool>>> reads;
+	page_id_t page_id = request.start_;
+	for (size_t i = 0; i < request.n_ && page_id != INVALID_PAGE_ID; i++) {
+		std::shared_future<bool> read;
+		page_id_t next_page_id = INVALID_PAGE_ID;
+		PrefetchStatus status = StartPrefetch(page_id, request.next_page_, next_page_id, read);
+		if (status == PrefetchStatus::kStop) break;
+		if (status == PrefetchStatus::kLoading) {
+			if (request.next_page_) {
+				read.wait();
+				next_page_id = FinishPrefetch(page_id, request.next_page_);
+			}
+			else {
+				reads.emplace_back(page_id, std::move(read));
+			}
+		}
+		page_id = next_page_id;
+	}
+	for (auto& read : reads) {
+		read.second.wait();
+		FinishPrefetch(read.first, nullptr);
+	}
+}
+
+/**
+ * The next page id of a resident page is read without the page latch, it is only a hint: a wrong id at worst loads
+ * a useless page, and pages that are free on disk are never loaded.
+ */
+BufferPoolManager::PrefetchStatus BufferPoolManager::StartPrefetch(page_id_t page_id, const NextPageFunc& next_page,
+                                                                   page_id_t& next_page_id,
+                                                                   std::shared_future<bool>& read) {
+	Shard* shard = ShardOf(page_id);
+	if (shard == nullptr) return PrefetchStatus::kStop;
+	scoped_lock<recursive_mutex> lock(shard->latch_);
+	auto it = shard->page_table_.find(page_id);
+	if (it != shard->page_table_.end()) {
+		next_page_id = next_page ? next_page(pages_[it->second].GetData()) : page_id + 1;
+		return PrefetchStatus::kResident;
+	}
+	if (disk_manager_->IsPageFree(page_id)) return PrefetchStatus::kStop;
+	frame_id_t frame_id = TryToFindFreePage(*shard);
+	if (frame_id == INVALID_FRAME_ID) return PrefetchStatus::kStop;
+	shard->page_table_[page_id] = frame_id;
+	// the pin held by read-ahead keeps the frame from being evicted before the read completes
+	pages_[frame_id].pin_count_ = 1;
+	pages_[frame_id].is_dirty_ = false;
+	pages_[frame_id].page_id_ = page_id;
+	read = disk_scheduler_->ScheduleRead(page_id, pages_[frame_id].GetData()).share();
+	pending_reads_[frame_id] = read;
+	shard->replacer_->Admit(frame_id, page_id);
+	// the next page of a chain is only known once the read has completed
+	if (!next_page) next_page_id = page_id + 1;
+	return PrefetchStatus::kLoading;
+}
+
+page_id_t BufferPoolManager::FinishPrefetch(page_id_t page_id, const NextPageFunc& next_page) {
+	Shard* shard = ShardOf(page_id);
+	if (shard == nullptr) return INVALID_PAGE_ID;
+	scoped_lock<recursive_mutex> lock(shard->latch_);
+	frame_id_t frame_id = shard->page_table_[page_id];
+	pending_reads_[frame_id] = std::shared_future<bool>();
+	page_id_t next_page_id = next_page ? next_page(pages_[frame_id].GetData()) : page_id + 1;
+	if (!--pages_[frame_id].pin_count_) shard->replacer_->Unpin(frame_id);
+	// only counted once the read-ahead pin is released, so a finished prefetch leaves nothing pinned
+	prefetch_count_++;
+	return next_page_id;
+}
+
+void BufferPoolManager::StartBackgroundFlusher(double target_clean_ratio, uint32_t interval_ms) {
+	scoped_lock<std::mutex> lock(flusher_latch_);
+	if (flusher_running_) return;
+	flusher_running_ = true;
+	flusher_clean_ratio_ = target_clean_ratio;
+	flusher_interval_ms_ = interval_ms;
+	flusher_thread_ = std::thread(&BufferPoolManager::BackgroundFlusherLoop, this);
+}
+
+void BufferPoolManager::StopBackgroundFlusher() {
+	{
+		scoped_lock<std::mutex> lock(flusher_latch_);
+		if (!flusher_running_) return;
+		flusher_running_ = false;
+	}
+	flusher_cv_.notify_one();
+	flusher_thread_.join();
+}
+
+size_t BufferPoolManager::GetBackgroundFlushCount() {
+	return background_flush_count_;
+}
+
+void BufferPoolManager::BackgroundFlusherLoop() {
+	std::unique_lock<std::mutex> lock(flusher_latch_);
+	while (flusher_running_) {
+		lock.unlock();
+		FlushDirtyFrames();
+		lock.lock();
+		flusher_cv_.wait_for(lock, std::chrono::milliseconds(flusher_interval_ms_));
+	}
+}
+
+/**
+ * The shard latch is taken per written frame rather than per shard, so a foreground thread waits for at most one
+ * page write. The write itself must stay under the latch: once the frame is marked clean it may be evicted and read
+ * back, and that read must not overtake the write.
+ */
+void BufferPoolManager::FlushDirtyFrames() {
+	for (size_t i = 0; i < num_shards_; i++) {
+		Shard& shard = shards_[i];
+		size_t num_frames = 0, num_clean = 0;
+		{
+			scoped_lock<recursive_mutex> lock(shard.latch_);
+			for (size_t frame_id = i; frame_id < pool_size_; frame_id += num_shards_) {
+				num_frames++;
+				if (pages_[frame_id].page_id_ == INVALID_PAGE_ID ||
+				    (pages_[frame_id].pin_count_ == 0 && !pages_[frame_id].is_dirty_)) {
+					num_clean++;
+				}
+			}
+		}
+		for (size_t frame_id = i; frame_id < pool_size_ && num_clean < flusher_clean_ratio_ * num_frames;
+		     frame_id += num_shards_) {
+			scoped_lock<recursive_mutex> lock(shard.latch_);
+			Page& page = pages_[frame_id];
+			if (page.page_id_ == INVALID_PAGE_ID || page.pin_count_ != 0 || !page.is_dirty_) continue;
+			FlushFrame(frame_id);
+			background_flush_count_++;
+			num_clean++;
+		}
+	}
+}
+
+frame_id_t BufferPoolManager::TryToFindFreePage(Shard& shard) {
+	frame_id_t frame_id = INVALID_FRAME_ID;
+	if (!shard.free_list_.empty()) {
+		frame_id = shard.free_list_.front();
+		shard.free_list_.pop_front();
+	}
+	else {
+		if (!shard.replacer_->Victim(&frame_id)) return INVALID_FRAME_ID;
+		if (pages_[frame_id].IsDirty()) {
+			// the frame is reused right away, so the scheduler writes a copy while the caller reads the new page
+			disk_scheduler_->ScheduleWriteCopy(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
+			pages_[frame_id].is_dirty_ = false;
+			// the background writer is falling behind
+			flusher_cv_.notify_one();
+		}
+		shard.page_table_.erase(pages_[frame_id].GetPageId());
+	}
+	pages_[frame_id].ResetMemory();
+	return frame_id;
+}
+
+void BufferPoolManager::FlushFrame(frame_id_t frame_id) {
+	disk_scheduler_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
+	pages_[frame_id].is_dirty_ = false;
+}
+
+BasicPageGuard BufferPoolManager::FetchPageBasic(page_id_t page_id) {
+	return BasicPageGuard(this, FetchPage(page_id));
+}
+
+ReadPageGuard BufferPoolManager::FetchPageRead(page_id_t page_id) {
+	Page* page = FetchPage(page_id);
+	if (page == nullptr) return ReadPageGuard();
+	page->RLatch();
+	return ReadPageGuard(this, page);
+}
+
+WritePageGuard BufferPoolManager::FetchPageWrite(page_id_t page_id) {
+	Page* page = FetchPage(page_id);
+	if (page == nullptr) return WritePageGuard();
+	page->WLatch();
+	return WritePageGuard(this, page);
+}
+
+BasicPageGuard BufferPoolManager::NewPageGuarded(page_id_t& page_id, PageRun* run) {
+	return BasicPageGuard(this, run == nullptr ? NewPage(page_id) : NewPage(page_id, *run));
+}
+
 page_id_t BufferPoolManager::AllocatePage() {
 	int next_page_id = disk_manager_->AllocatePage();
 	return next_page_id;
@@ -178,10 +547,14 @@ bool BufferPoolManager::IsPageFree(page_id_t page_id) {
 // Only used for debug
 bool BufferPoolManager::CheckAllUnpinned() {
 	bool res = true;
-	for (size_t i = 0; i < pool_size_; i++) {
-		if (pages_[i].pin_count_ != 0) {
-			res = false;
-			LOG(ERROR) << "page " << pages_[i].page_id_ << " pin count:" << pages_[i].pin_count_ << endl;
+	for (size_t i = 0; i < num_shards_; i++) {
+		scoped_lock<recursive_mutex> lock(shards_[i].latch_);
+		for (size_t frame_id = i; frame_id < pool_size_; frame_id += num_shards_) {
+			if (pages_[frame_id].pin_count_ != 0) {
+				res = false;
+				LOG(ERROR) << "page " << pages_[frame_id].page_id_ << " pin count:" << pages_[frame_id].pin_count_
+				           << endl;
+			}
 		}
 	}
 	return res;
@@ -2,9 +2,9 @@
 #include "glog/logging.h"
 
 CLOCKReplacer::CLOCKReplacer(size_t num_pages) : capacity(num_pages) {
-    clock_status.resize(num_pages + 1);
-    for (frame_id_t i = 1; i <= num_pages; i++) clock_status[i] = EMPTY;
-    clock_hand = 1;
+    // frame ids 0 .. num_pages are all accepted
+    clock_status.resize(num_pages + 1, EMPTY);
+    clock_hand = 0;
     size = 0;
 }
 
@@ -12,17 +12,19 @@ CLOCKReplacer::~CLOCKReplacer() = default;
 
 bool CLOCKReplacer::Victim(frame_id_t *frame_id) {
     if (size == 0) return frame_id = nullptr, false;
-    for (int i = 0; i <= capacity; ++i) {
+    // the first sweep may only clear reference bits, the second one is guaranteed to find a victim
+    for (size_t i = 0; i < 2 * clock_status.size(); ++i) {
         if (clock_status[clock_hand] == USED) {
             clock_status[clock_hand] = UNUSED;
         } else if (clock_status[clock_hand] == UNUSED) {
             clock_status[clock_hand] = EMPTY;
             *frame_id = clock_hand;
-            clock_hand = clock_hand % capacity + 1;
+            clock_hand = (clock_hand + 1) % clock_status.size();
             return --size, true;
         }
-        clock_hand = clock_hand % capacity + 1;
+        clock_hand = (clock_hand + 1) % clock_status.size();
     }
+    return false;
 }
 
 void CLOCKReplacer::Pin(frame_id_t frame_id) {
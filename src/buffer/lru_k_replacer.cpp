@@ -0,0 +1,56 @@
+#include "buffer/lru_k_replacer.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k) : k_(k == 0 ? 1 : k) {
+  frames_.reserve(num_pages);
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  auto &candidates = inf_frames_.empty() ? k_frames_ : inf_frames_;
+  if (candidates.empty()) return false;
+  *frame_id = candidates.begin()->second;
+  candidates.erase(candidates.begin());
+  // the frame will hold another page, its history is meaningless from now on
+  frames_.erase(*frame_id);
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  if (info.evictable_) {
+    SetOf(info).erase(KeyOf(info, frame_id));
+    info.evictable_ = false;
+  }
+  info.history_.push_back(current_timestamp_++);
+  if (info.history_.size() > k_) info.history_.pop_front();
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) {
+    // never accessed through Pin, treat the unpin as its first access
+    it = frames_.emplace(frame_id, FrameInfo()).first;
+    it->second.history_.push_back(current_timestamp_++);
+  }
+  FrameInfo &info = it->second;
+  if (info.evictable_) return;
+  info.evictable_ = true;
+  SetOf(info).insert(KeyOf(info, frame_id));
+}
+
+void LRUKReplacer::Admit(frame_id_t frame_id, __attribute__((unused)) page_id_t page_id) {
+  Remove(frame_id);
+  frames_[frame_id].admitted_ = current_timestamp_++;
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) return;
+  if (it->second.evictable_) SetOf(it->second).erase(KeyOf(it->second, frame_id));
+  frames_.erase(it);
+}
+
+size_t LRUKReplacer::Size() {
+  return inf_frames_.size() + k_frames_.size();
+}
@@ -0,0 +1,69 @@
+#include "buffer/page_guard.h"
+
+#include "buffer/buffer_pool_manager.h"
+
+BasicPageGuard::BasicPageGuard(BasicPageGuard&& that) noexcept
+	: bpm_(that.bpm_), page_(that.page_), is_dirty_(that.is_dirty_) {
+	that.bpm_ = nullptr;
+	that.page_ = nullptr;
+	that.is_dirty_ = false;
+}
+
+BasicPageGuard& BasicPageGuard::operator=(BasicPageGuard&& that) noexcept {
+	if (this == &that) return *this;
+	Drop();
+	bpm_ = that.bpm_;
+	page_ = that.page_;
+	is_dirty_ = that.is_dirty_;
+	that.bpm_ = nullptr;
+	that.page_ = nullptr;
+	that.is_dirty_ = false;
+	return *this;
+}
+
+void BasicPageGuard::Drop() {
+	if (page_ != nullptr) bpm_->UnpinPage(page_->GetPageId(), is_dirty_);
+	bpm_ = nullptr;
+	page_ = nullptr;
+	is_dirty_ = false;
+}
+
+ReadPageGuard BasicPageGuard::UpgradeRead() {
+	ReadPageGuard guard;
+	if (page_ == nullptr) return guard;
+	page_->RLatch();
+	guard.guard_ = std::move(*this);
+	return guard;
+}
+
+WritePageGuard BasicPageGuard::UpgradeWrite() {
+	WritePageGuard guard;
+	if (page_ == nullptr) return guard;
+	page_->WLatch();
+	guard.guard_ = std::move(*this);
+	return guard;
+}
+
+ReadPageGuard& ReadPageGuard::operator=(ReadPageGuard&& that) noexcept {
+	if (this == &that) return *this;
+	Drop();
+	guard_ = std::move(that.guard_);
+	return *this;
+}
+
+void ReadPageGuard::Drop() {
+	if (guard_.page_ != nullptr) guard_.page_->RUnlatch();
+	guard_.Drop();
+}
+
+WritePageGuard& WritePageGuard::operator=(WritePageGuard&& that) noexcept {
+	if (this == &that) return *this;
+	Drop();
+	guard_ = std::move(that.guard_);
+	return *this;
+}
+
+void WritePageGuard::Drop() {
+	if (guard_.page_ != nullptr) guard_.page_->WUnlatch();
+	guard_.Drop();
+}
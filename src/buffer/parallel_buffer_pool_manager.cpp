@@ -0,0 +1,149 @@
+#include "buffer/parallel_buffer_pool_manager.h"
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager* disk_manager,
+                                                     ReplacerType replacer_type, size_t replacer_k)
+	: BufferPoolManager(disk_manager), total_pool_size_(0) {
+	if (num_instances == 0) num_instances = 1;
+	for (size_t i = 0; i < num_instances; i++) {
+		// spread the remainder over the first instances so no frame is lost
+		size_t instance_size = pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0);
+		instances_.push_back(new BufferPoolManager(instance_size, disk_manager, 1, replacer_type, replacer_k));
+		// the instance has not started its scheduler's workers yet, they are only started by the first request
+		instances_.back()->disk_scheduler_ = disk_scheduler_;
+		total_pool_size_ += instance_size;
+	}
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+	// the read-ahead thread calls into the instances
+	StopPrefetcher();
+	for (auto instance : instances_) {
+		delete instance;
+	}
+}
+
+Page* ParallelBufferPoolManager::FetchPage(page_id_t page_id) {
+	return InstanceOf(page_id)->FetchPage(page_id);
+}
+
+bool ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+	return InstanceOf(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPage(page_id_t page_id) {
+	return InstanceOf(page_id)->FlushPage(page_id);
+}
+
+/**
+ * The page id decides the instance, so the id is allocated first and then handed to its instance. If that instance
+ * has no evictable frame, the id is kept and the next id is allocated, until a page is created or every instance has
+ * been tried. The ids that were kept are given back to the disk manager at the end.
+ */
+Page* ParallelBufferPoolManager::NewPage(page_id_t& page_id) {
+	std::vector<page_id_t> skipped;
+	std::vector<bool> tried(instances_.size(), false);
+	size_t tried_count = 0;
+	Page* page = nullptr;
+	while (tried_count < instances_.size()) {
+		page_id_t new_page_id = disk_manager_->AllocatePage();
+		if (new_page_id == INVALID_PAGE_ID) break;
+		page = NewPageWithId(new_page_id);
+		if (page != nullptr) {
+			page_id = new_page_id;
+			break;
+		}
+		skipped.push_back(new_page_id);
+		size_t instance = static_cast<size_t>(new_page_id) % instances_.size();
+		if (!tried[instance]) {
+			tried[instance] = true;
+			tried_count++;
+		}
+	}
+	for (auto skipped_id : skipped) {
+		disk_manager_->DeAllocatePage(skipped_id);
+	}
+	return page;
+}
+
+Page* ParallelBufferPoolManager::NewPageWithId(page_id_t page_id) {
+	return InstanceOf(page_id)->NewPageWithId(page_id);
+}
+
+bool ParallelBufferPoolManager::DeletePage(page_id_t page_id) {
+	return InstanceOf(page_id)->DeletePage(page_id);
+}
+
+bool ParallelBufferPoolManager::IsPageFree(page_id_t page_id) {
+	return disk_manager_->IsPageFree(page_id);
+}
+
+bool ParallelBufferPoolManager::CheckAllUnpinned() {
+	bool res = true;
+	for (auto instance : instances_) {
+		res = instance->CheckAllUnpinned() && res;
+	}
+	return res;
+}
+
+size_t ParallelBufferPoolManager::GetHitCount() {
+	size_t count = 0;
+	for (auto instance : instances_) {
+		count += instance->GetHitCount();
+	}
+	return count;
+}
+
+size_t ParallelBufferPoolManager::GetMissCount() {
+	size_t count = 0;
+	for (auto instance : instances_) {
+		count += instance->GetMissCount();
+	}
+	return count;
+}
+
+size_t ParallelBufferPoolManager::GetGhostHitCount() {
+	size_t count = 0;
+	for (auto instance : instances_) {
+		count += instance->GetGhostHitCount();
+	}
+	return count;
+}
+
+void ParallelBufferPoolManager::StartBackgroundFlusher(double target_clean_ratio, uint32_t interval_ms) {
+	for (auto instance : instances_) {
+		instance->StartBackgroundFlusher(target_clean_ratio, interval_ms);
+	}
+}
+
+void ParallelBufferPoolManager::StopBackgroundFlusher() {
+	for (auto instance : instances_) {
+		instance->StopBackgroundFlusher();
+	}
+}
+
+size_t ParallelBufferPoolManager::GetBackgroundFlushCount() {
+	size_t count = 0;
+	for (auto instance : instances_) {
+		count += instance->GetBackgroundFlushCount();
+	}
+	return count;
+}
+
+size_t ParallelBufferPoolManager::GetPrefetchCount() {
+	size_t count = 0;
+	for (auto instance : instances_) {
+		count += instance->GetPrefetchCount();
+	}
+	return count;
+}
+
+BufferPoolManager::PrefetchStatus ParallelBufferPoolManager::StartPrefetch(page_id_t page_id,
+                                                                           const NextPageFunc& next_page,
+                                                                           page_id_t& next_page_id,
+                                                                           std::shared_future<bool>& read) {
+	return InstanceOf(page_id)->StartPrefetch(page_id, next_page, next_page_id, read);
+}
+
+page_id_t ParallelBufferPoolManager::FinishPrefetch(page_id_t page_id, const NextPageFunc& next_page) {
+	return InstanceOf(page_id)->FinishPrefetch(page_id, next_page);
+}
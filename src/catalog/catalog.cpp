@@ -23,7 +23,7 @@
  * @throws An assertion error if the size of the serialized data exceeds the page size.
  */
 void CatalogMeta::SerializeTo(char* buf) const {
-	ASSERT(GetSerializedSize() <= PAGE_SIZE, "Failed to serialize catalog metadata to disk.");
+	ASSERT(GetSerializedSize() <= PAGE_USABLE_SIZE, "Failed to serialize catalog metadata to disk.");
 	MACH_WRITE_UINT32(buf, CATALOG_METADATA_MAGIC_NUM);
 	buf += 4;
 	MACH_WRITE_UINT32(buf, table_meta_pages_.size());
@@ -343,15 +343,10 @@ dberr_t CatalogManager::DropTable(const string& table_name) {
 		return DB_TABLE_NOT_EXIST;
 
 	table_id_t table_id = table->second;
-	page_id_t page_id = tables_.find(table_id)->second->GetRootPageId();
 
 	table_names_.erase(table);
-	while (page_id != INVALID_PAGE_ID) {
-		auto page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(page_id)->GetData());
-		page_id = page->GetNextPageId();
-		buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-		buffer_pool_manager_->DeletePage(page_id);
-	}
+	// frees the page chain and the free space map of the heap
+	tables_.find(table_id)->second->GetTableHeap()->FreeTableHeap();
 	tables_.erase(table_id);
 	catalog_meta_->DeleteTableMetaPage(buffer_pool_manager_, table_id);
 
@@ -1,12 +1,12 @@
 #include "catalog/indexes.h"
 
 IndexMetadata::IndexMetadata(const index_id_t index_id, const std::string& index_name, const table_id_t table_id,
-	const std::vector<uint32_t>& key_map)
-	: index_id_(index_id), index_name_(index_name), table_id_(table_id), key_map_(key_map) {}
+	const std::vector<uint32_t>& key_map, KeyEncoding key_encoding)
+	: index_id_(index_id), index_name_(index_name), table_id_(table_id), key_map_(key_map), key_encoding_(key_encoding) {}
 
 IndexMetadata* IndexMetadata::Create(const index_id_t index_id, const string& index_name, const table_id_t table_id,
-	const vector<uint32_t>& key_map) {
-	return new IndexMetadata(index_id, index_name, table_id, key_map);
+	const vector<uint32_t>& key_map, KeyEncoding key_encoding) {
+	return new IndexMetadata(index_id, index_name, table_id, key_map, key_encoding);
 }
 
 /**
@@ -15,7 +15,7 @@ IndexMetadata* IndexMetadata::Create(const index_id_t index_id, const string& in
  * @return: The size of the serialized data in bytes.
  * @throws: An assertion error if the serialized size exceeds the page size.
  * @note: This function serializes the IndexMetadata object by writing its member variables to the character buffer.
- * @note: The serialized data includes the magic number, index ID, index name, table ID, key count, and key mapping in the table.
+ * @note: The serialized data includes the magic number, index ID, index name, table ID, key count, key mapping in the table and key encoding.
  * @note: The serialized data can be used to store the IndexMetadata object in a file or send it over a network.
  *
  * Example usage:
@@ -28,9 +28,9 @@ IndexMetadata* IndexMetadata::Create(const index_id_t index_id, const string& in
 uint32_t IndexMetadata::SerializeTo(char* buf) const {
 	char* p = buf;
 	uint32_t ofs = GetSerializedSize();
-	ASSERT(ofs <= PAGE_SIZE, "Failed to serialize index info.");
+	ASSERT(ofs <= PAGE_USABLE_SIZE, "Failed to serialize index info.");
 	// magic num
-	MACH_WRITE_UINT32(buf, INDEX_METADATA_MAGIC_NUM);
+	MACH_WRITE_UINT32(buf, INDEX_METADATA_ENCODING_MAGIC_NUM);
 	buf += 4;
 	// index id
 	MACH_WRITE_TO(index_id_t, buf, index_id_);
@@ -51,6 +51,9 @@ uint32_t IndexMetadata::SerializeTo(char* buf) const {
 		MACH_WRITE_UINT32(buf, col_index);
 		buf += 4;
 	}
+	// key encoding
+	MACH_WRITE_UINT32(buf, static_cast<uint32_t>(key_encoding_));
+	buf += 4;
 	ASSERT(buf - p == ofs, "Unexpected serialize size.");
 	return ofs;
 }
@@ -66,7 +69,8 @@ uint32_t IndexMetadata::GetSerializedSize() const {
 		+ index_name_.length()	// index name
 		+ 4						// table id
 		+ 4						// key count
-		+ key_map_.size() * sizeof(uint32_t);	// key mapping in table
+		+ key_map_.size() * sizeof(uint32_t)	// key mapping in table
+		+ 4;					// key encoding
 }
 
 
@@ -75,7 +79,8 @@ uint32_t IndexMetadata::GetSerializedSize() const {
  *
  * This function takes a buffer containing serialized index metadata and creates an IndexMetadata object
  * by extracting the relevant information from the buffer. The deserialized index metadata includes the
- * magic number, index ID, index name, table ID, index key count, and key mapping in the table.
+ * magic number, index ID, index name, table ID, index key count, key mapping in the table and key encoding. Metadata
+ * written before the key encoding was recorded has the old magic number, its index keys are KeyEncoding::kRow.
  *
  * @param buf A pointer to the buffer containing the serialized index metadata.
  * @param index_meta A reference to a pointer to IndexMetadata object. This pointer will be updated to
@@ -90,7 +95,8 @@ uint32_t IndexMetadata::DeserializeFrom(char* buf, IndexMetadata*& index_meta) {
 	// magic num
 	uint32_t magic_num = MACH_READ_UINT32(buf);
 	buf += 4;
-	ASSERT(magic_num == INDEX_METADATA_MAGIC_NUM, "Failed to deserialize index info.");
+	ASSERT(magic_num == INDEX_METADATA_MAGIC_NUM || magic_num == INDEX_METADATA_ENCODING_MAGIC_NUM,
+		"Failed to deserialize index info.");
 	// index id
 	index_id_t index_id = MACH_READ_FROM(index_id_t, buf);
 	buf += 4;
@@ -112,8 +118,14 @@ uint32_t IndexMetadata::DeserializeFrom(char* buf, IndexMetadata*& index_meta) {
 		buf += 4;
 		key_map.push_back(key_index);
 	}
+	// key encoding
+	KeyEncoding key_encoding = KeyEncoding::kRow;
+	if (magic_num == INDEX_METADATA_ENCODING_MAGIC_NUM) {
+		key_encoding = static_cast<KeyEncoding>(MACH_READ_UINT32(buf));
+		buf += 4;
+	}
 	// allocate space for index meta data
-	index_meta = new IndexMetadata(index_id, index_name, table_id, key_map);
+	index_meta = new IndexMetadata(index_id, index_name, table_id, key_map, key_encoding);
 	return buf - p;
 }
 
@@ -128,15 +140,21 @@ uint32_t IndexMetadata::DeserializeFrom(char* buf, IndexMetadata*& index_meta) {
  */
 Index* IndexInfo::CreateIndex(BufferPoolManager* buffer_pool_manager, const string& index_type) {
 	size_t max_size = 0;
-	uint32_t column_cnt = key_schema_->GetColumns().size();
-	size_t size_bitmap = (column_cnt % 8) ? column_cnt / 8 + 1 : column_cnt / 8;
-	// column_cnt + bitmap
-	max_size += 4 + sizeof(unsigned char) * size_bitmap;
-	for (auto col : key_schema_->GetColumns()) {
-		// length of char column
-		if (col->GetType() == TypeId::kTypeChar)
-			max_size += 4;
-		max_size += col->GetLength();
+	KeyEncoding key_encoding = meta_data_->GetKeyEncoding();
+	if (key_encoding == KeyEncoding::kMemcomparable) {
+		max_size = KeyManager::GetMemcomparableSize(key_schema_);
+	}
+	else {
+		uint32_t column_cnt = key_schema_->GetColumns().size();
+		size_t size_bitmap = (column_cnt % 8) ? column_cnt / 8 + 1 : column_cnt / 8;
+		// column_cnt + bitmap
+		max_size += 4 + sizeof(unsigned char) * size_bitmap;
+		for (auto col : key_schema_->GetColumns()) {
+			// length of char column
+			if (col->GetType() == TypeId::kTypeChar)
+				max_size += 4;
+			max_size += col->GetLength();
+		}
 	}
 
 	if (index_type == "bptree") {
@@ -153,5 +171,5 @@ Index* IndexInfo::CreateIndex(BufferPoolManager* buffer_pool_manager, const stri
 	else {
 		return nullptr;
 	}
-	return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager);
+	return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager, key_encoding);
 }
@@ -3,7 +3,7 @@
 uint32_t TableMetadata::SerializeTo(char* buf) const {
 	char* p = buf;
 	uint32_t ofs = GetSerializedSize();
-	ASSERT(ofs <= PAGE_SIZE, "Failed to serialize table info.");
+	ASSERT(ofs <= PAGE_USABLE_SIZE, "Failed to serialize table info.");
 	// magic num
 	MACH_WRITE_UINT32(buf, TABLE_METADATA_MAGIC_NUM);
 	buf += 4;
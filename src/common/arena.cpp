@@ -0,0 +1,41 @@
+#include "common/arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+void Arena::Reset() {
+  while (head_ != nullptr) {
+    Block *prev = head_->prev_;
+    upstream_->deallocate(head_, head_->size_, alignof(std::max_align_t));
+    head_ = prev;
+  }
+  cur_ = end_ = nullptr;
+  next_block_size_ = block_size_;
+  block_count_ = 0;
+  bytes_allocated_ = 0;
+}
+
+void *Arena::do_allocate(size_t bytes, size_t alignment) {
+  auto aligned = [alignment](char *p) {
+    auto addr = reinterpret_cast<uintptr_t>(p);
+    return reinterpret_cast<char *>((addr + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1));
+  };
+  char *p = cur_ == nullptr ? nullptr : aligned(cur_);
+  if (p == nullptr || p + bytes > end_) {
+    // the rest of the current block is wasted, requests are small compared to a block
+    size_t needed = sizeof(Block) + bytes + alignment;
+    size_t size = std::max(next_block_size_, needed);
+    auto block = static_cast<Block *>(upstream_->allocate(size, alignof(std::max_align_t)));
+    block->prev_ = head_;
+    block->size_ = size;
+    head_ = block;
+    cur_ = reinterpret_cast<char *>(block + 1);
+    end_ = reinterpret_cast<char *>(block) + size;
+    next_block_size_ = std::min(next_block_size_ * 2, MAX_BLOCK_SIZE);
+    block_count_++;
+    p = aligned(cur_);
+  }
+  cur_ = p + bytes;
+  bytes_allocated_ += bytes;
+  return p;
+}
@@ -0,0 +1,85 @@
+#include "common/crc32c.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace {
+
+constexpr uint32_t CRC32C_POLY = 0x82F63B78;  // reflected Castagnoli polynomial
+
+struct Crc32cTable {
+  uint32_t entries_[256];
+
+  Crc32cTable() {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int j = 0; j < 8; j++) {
+        crc = (crc >> 1) ^ (crc & 1 ? CRC32C_POLY : 0);
+      }
+      entries_[i] = crc;
+    }
+  }
+};
+
+const Crc32cTable crc32c_table;
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) uint32_t Crc32cHardware(const char *data, size_t len, uint32_t crc) {
+  uint64_t crc64 = ~crc;
+  for (; len >= 8; data += 8, len -= 8) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  auto crc32 = static_cast<uint32_t>(crc64);
+  for (; len > 0; data++, len--) {
+    crc32 = _mm_crc32_u8(crc32, static_cast<uint8_t>(*data));
+  }
+  return ~crc32;
+}
+
+bool DetectHardwareCrc32c() { return __builtin_cpu_supports("sse4.2"); }
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+uint32_t Crc32cHardware(const char *data, size_t len, uint32_t crc) {
+  crc = ~crc;
+  for (; len >= 8; data += 8, len -= 8) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc = __crc32cd(crc, word);
+  }
+  for (; len > 0; data++, len--) {
+    crc = __crc32cb(crc, static_cast<uint8_t>(*data));
+  }
+  return ~crc;
+}
+
+bool DetectHardwareCrc32c() { return true; }
+#else
+uint32_t Crc32cHardware(const char *data, size_t len, uint32_t crc) { return Crc32cSoftware(data, len, crc); }
+
+bool DetectHardwareCrc32c() { return false; }
+#endif
+
+// decided once, Crc32c is called for every page read and written
+const bool hardware_crc32c = DetectHardwareCrc32c();
+
+}  // namespace
+
+uint32_t Crc32cSoftware(const char *data, size_t len, uint32_t crc) {
+  crc = ~crc;
+  for (; len > 0; data++, len--) {
+    crc = (crc >> 8) ^ crc32c_table.entries_[(crc ^ static_cast<uint8_t>(*data)) & 0xFF];
+  }
+  return ~crc;
+}
+
+uint32_t Crc32c(const char *data, size_t len, uint32_t crc) {
+  return hardware_crc32c ? Crc32cHardware(data, len, crc) : Crc32cSoftware(data, len, crc);
+}
+
+bool Crc32cIsHardwareAccelerated() { return hardware_crc32c; }
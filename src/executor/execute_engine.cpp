@@ -144,6 +144,8 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
 			return ExecuteExecfile(ast, context.get());
 		case kNodeQuit:
 			return ExecuteQuit(ast, context.get());
+		case kNodeVacuum:
+			return ExecuteVacuum(ast, context.get());
 		default:
 			break;
 	}
@@ -271,6 +273,9 @@ dberr_t ExecuteEngine::ExecuteDropDatabase(pSyntaxNode ast, ExecuteContext* cont
 	remove(("./databases/" + db_name).c_str());
 	delete dbs_[db_name];
 	dbs_.erase(db_name);
+	for (auto it = vacuum_cursors_.begin(); it != vacuum_cursors_.end();) {
+		it = it->first.first == db_name ? vacuum_cursors_.erase(it) : std::next(it);
+	}
 	if (db_name == current_db_) current_db_ = "";
 	return DB_SUCCESS;
 }
@@ -489,8 +494,13 @@ dberr_t ExecuteEngine::ExecuteDropTable(pSyntaxNode ast, ExecuteContext* context
 	CatalogManager* catalog = context->GetCatalog();
 
 	string table_name = ast->child_->val_;
+	TableInfo* table = nullptr;
+	dberr_t res = catalog->GetTable(table_name, table);
+	if (res != DB_SUCCESS) return res;
+	// the id may be given to the next table
+	vacuum_cursors_.erase({ current_db_, table->GetTableId() });
 	std::vector<IndexInfo*> index_info;
-	dberr_t res = catalog->GetTableIndexes(table_name, index_info);
+	res = catalog->GetTableIndexes(table_name, index_info);
 	if (res != DB_SUCCESS) return res;
 
 	for (auto& index : index_info) {
@@ -788,3 +798,85 @@ dberr_t ExecuteEngine::ExecuteQuit(pSyntaxNode ast, ExecuteContext* context) {
 #endif
 	return DB_QUIT;
 }
+
+/**
+ * @brief: the VACUUM [table] statement.
+ *
+ * Reclaims the space of deleted tuples of one table, or of all tables, and compacts each table heap by moving the
+ * tuples of its last pages into free space of earlier pages. The indexes of a table are updated for every moved
+ * tuple. Freed pages at the end of the database file are then given back to the file system.
+ *
+ * One statement works through at most DEFAULT_VACUUM_STEPS pages, so it does not hold up the statements after it on
+ * a large table. Where it stopped is kept, and the next VACUUM of the table continues from there.
+ *
+ * @param ast The syntax node representing the VACUUM statement.
+ * @param context The execution context.
+ * @return DB_FAILED if no database is selected, DB_TABLE_NOT_EXIST if the table does not exist, DB_SUCCESS otherwise.
+ */
+dberr_t ExecuteEngine::ExecuteVacuum(pSyntaxNode ast, ExecuteContext* context) {
+#ifdef ENABLE_EXECUTE_DEBUG
+	LOG(INFO) << "ExecuteVacuum" << std::endl;
+#endif
+	if (current_db_.empty() || context == nullptr) {
+		std::cout << "No database selected" << endl;
+		return DB_FAILED;
+	}
+	auto st = std::chrono::high_resolution_clock::now();
+	CatalogManager* catalog = context->GetCatalog();
+
+	std::vector<TableInfo*> table_info;
+	if (ast->child_ != nullptr) {
+		TableInfo* table = nullptr;
+		dberr_t res = catalog->GetTable(ast->child_->val_, table);
+		if (res != DB_SUCCESS) return res;
+		table_info.push_back(table);
+	} else {
+		dberr_t res = catalog->GetTables(table_info);
+		if (res != DB_SUCCESS) return res;
+	}
+
+	uint32_t freed_pages = 0;
+	uint32_t steps = 0;
+	uint32_t unfinished = 0;
+	for (auto& table : table_info) {
+		if (steps == DEFAULT_VACUUM_STEPS) {
+			unfinished++;
+			continue;
+		}
+		std::vector<IndexInfo*> index_info;
+		// a loaded table without indexes has no index entry in the catalog, which is not an error here
+		catalog->GetTableIndexes(table->GetTableName(), index_info);
+		Schema* schema = table->GetSchema();
+		auto on_move = [&](const RowId& old_rid, Row& row) {
+			for (auto& index : index_info) {
+				Row key;
+				row.GetKeyFromRow(schema, index->GetIndexKeySchema(), key);
+				index->GetIndex()->RemoveEntry(key, old_rid, context->GetTransaction());
+				index->GetIndex()->InsertEntry(key, row.GetRowId(), context->GetTransaction());
+			}
+		};
+		std::pair<std::string, table_id_t> cursor_key{ current_db_, table->GetTableId() };
+		TableHeap::VacuumCursor& cursor = vacuum_cursors_[cursor_key];
+		uint32_t freed_before = cursor.freed_pages_;
+		bool more = true;
+		while (steps < DEFAULT_VACUUM_STEPS && more) {
+			more = table->GetTableHeap()->VacuumStep(cursor, on_move, context->GetTransaction());
+			steps++;
+		}
+		freed_pages += cursor.freed_pages_ - freed_before;
+		if (more) {
+			unfinished++;
+		} else {
+			vacuum_cursors_.erase(cursor_key);
+		}
+	}
+	size_t shrunk = dbs_[current_db_]->disk_mgr_->ShrinkFile();
+
+	auto ed = std::chrono::high_resolution_clock::now();
+	std::cout << "Vacuum OK, " << freed_pages << " page(s) freed, file shrank by " << shrunk / PAGE_SIZE << " page(s)";
+	if (unfinished > 0) {
+		std::cout << ", " << unfinished << " table(s) not done yet, run VACUUM again to continue";
+	}
+	std::cout << " (" << std::chrono::duration<double, std::milli>(ed - st).count() / 1000 << " sec)" << std::endl;
+	return DB_SUCCESS;
+}
@@ -10,7 +10,6 @@ IndexScanExecutor::IndexScanExecutor(ExecuteContext* exec_ctx, const IndexScanPl
 
 void IndexScanExecutor::Init() {
 	exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
-	auto first_row = table_info_->GetTableHeap()->Begin(nullptr);
 	result_ = IndexScan(plan_->GetPredicate());
 	is_schema_same_ = SchemaEqual(table_info_->GetSchema(), plan_->OutputSchema());
 }
@@ -34,14 +33,8 @@ bool IndexScanExecutor::SchemaEqual(const Schema* table_schema, const Schema* ou
 
 void IndexScanExecutor::TupleTransfer(const Schema* table_schema, const Schema* output_schema, const Row* row,
 	Row* output_row) {
-	const auto& output_columns = output_schema->GetColumns();
-	std::vector<Field> dest_row;
-	dest_row.reserve(output_columns.size());
-	for (const auto column : output_columns) {
-		auto idx = column->GetTableInd();
-		dest_row.emplace_back(*row->GetField(idx));
-	}
-	*output_row = Row(dest_row);
+	// built in place, the caller reuses output_row for every tuple
+	row->ProjectTo(output_schema, *output_row);
 }
 
 vector<RowId> IndexScanExecutor::IndexScan(AbstractExpressionRef predicate) {
@@ -86,12 +79,16 @@ bool IndexScanExecutor::Next(Row *row, RowId *rid) {
   auto predicate = plan_->GetPredicate();
   auto table_schema = table_info_->GetSchema();
   while (cursor_ < result_.size()) {
-    auto p_row = new Row(result_[cursor_]);
-    table_info_->GetTableHeap()->GetTuple(p_row, nullptr);
+    // one row is reused for all tuples, it keeps the capacity of its buffers
+    auto p_row = &tuple_;
+    p_row->SetRowId(result_[cursor_]);
+    if (!table_info_->GetTableHeap()->GetTuple(p_row, nullptr)) {
+      cursor_++;
+      continue;
+    }
     if (plan_->need_filter_) {
       if (!predicate->Evaluate(p_row).CompareEquals(Field(kTypeInt, 1))) {
         cursor_++;
-        delete p_row;
         continue;
       }
     }
@@ -101,7 +98,6 @@ bool IndexScanExecutor::Next(Row *row, RowId *rid) {
     } else {
       *row = *p_row;
     }
-    delete p_row;
     cursor_++;
     return true;
   }
@@ -16,27 +16,63 @@ void InsertExecutor::Init() {
 }
 
 bool InsertExecutor::Next([[maybe_unused]] Row* row, RowId* rid) {
+	if (!loaded_) {
+		loaded_ = true;
+		inserted_ = InsertAll();
+	}
+	if (cursor_ < inserted_) {
+		cursor_++;
+		return true;
+	}
+	return false;
+}
+
+size_t InsertExecutor::InsertAll() {
+	std::vector<Row> rows;
 	Row insert_row;
 	RowId insert_rid;
-	if (child_executor_->Next(&insert_row, &insert_rid)) {
+	while (child_executor_->Next(&insert_row, &insert_rid)) {
+		bool exists = false;
 		for (auto info : index_info_) {
 			Row key_row;
 			insert_row.GetKeyFromRow(table_info_->GetSchema(), info->GetIndexKeySchema(), key_row);
 			std::vector<RowId> result;
 			if (!key_row.GetFields().empty() &&
 				info->GetIndex()->ScanKey(key_row, result, exec_ctx_->GetTransaction()) == DB_SUCCESS) {
-				std::cout << "key already exists" << std::endl;
-				return false;
+				exists = true;
+				break;
 			}
 		}
-		if (table_info_->GetTableHeap()->InsertTuple(insert_row, exec_ctx_->GetTransaction())) {
-			Row key_row;
-			for (auto info : index_info_) {  // 更新索引
-				insert_row.GetKeyFromRow(schema_, info->GetIndexKeySchema(), key_row);
-				info->GetIndex()->InsertEntry(key_row, insert_row.GetRowId(), exec_ctx_->GetTransaction());
+		if (exists) {
+			std::cout << "key already exists" << std::endl;
+			break;
+		}
+		rows.push_back(insert_row);
+	}
+	TableHeap* table_heap = table_info_->GetTableHeap();
+	size_t inserted = table_heap->InsertTuples(rows, exec_ctx_->GetTransaction());
+	for (size_t i = 0; i < inserted; i++) {
+		Row key_row;
+		size_t indexed = 0;
+		for (; indexed < index_info_.size(); indexed++) {  // 更新索引
+			rows[i].GetKeyFromRow(schema_, index_info_[indexed]->GetIndexKeySchema(), key_row);
+			if (index_info_[indexed]->GetIndex()->InsertEntry(key_row, rows[i].GetRowId(),
+			                                                  exec_ctx_->GetTransaction()) != DB_SUCCESS) {
+				break;
 			}
-			return true;
 		}
+		if (indexed == index_info_.size()) continue;
+		// the key repeats one of an earlier row of this insert, take back this row and all after it
+		std::cout << "key already exists" << std::endl;
+		for (size_t j = 0; j < indexed; j++) {
+			rows[i].GetKeyFromRow(schema_, index_info_[j]->GetIndexKeySchema(), key_row);
+			index_info_[j]->GetIndex()->RemoveEntry(key_row, rows[i].GetRowId(), exec_ctx_->GetTransaction());
+		}
+		for (size_t j = i; j < inserted; j++) {
+			table_heap->MarkDelete(rows[j].GetRowId(), exec_ctx_->GetTransaction());
+			table_heap->ApplyDelete(rows[j].GetRowId(), exec_ctx_->GetTransaction());
+		}
+		inserted = i;
 	}
-	return false;
-}
\ No newline at end of file
+	return inserted;
+}
@@ -6,7 +6,7 @@
 SeqScanExecutor::SeqScanExecutor(ExecuteContext* exec_ctx, const SeqScanPlanNode* plan)
 	: AbstractExecutor(exec_ctx),
 	plan_(plan),
-	iterator_(nullptr, RowId(INVALID_PAGE_ID, 0), nullptr),
+	batch_(exec_ctx->GetArena()),
 	is_schema_same_(false) {}
 
 bool SeqScanExecutor::SchemaEqual(const Schema* table_schema, const Schema* output_schema) {
@@ -28,44 +28,43 @@ bool SeqScanExecutor::SchemaEqual(const Schema* table_schema, const Schema* outp
 
 void SeqScanExecutor::TupleTransfer(const Schema* table_schema, const Schema* output_schema, const Row* row,
 	Row* output_row) {
-	const auto& output_columns = output_schema->GetColumns();
-	std::vector<Field> dest_row;
-	dest_row.reserve(output_columns.size());
-	for (const auto column : output_columns) {
-		auto idx = column->GetTableInd();
-		dest_row.emplace_back(*row->GetField(idx));
-	}
-	*output_row = Row(dest_row);
+	// built in place, the caller reuses output_row for every tuple
+	row->ProjectTo(output_schema, *output_row);
 }
 
 void SeqScanExecutor::Init() {
 	exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
-	auto first_row = table_info_->GetTableHeap()->Begin(nullptr);
-	iterator_ = (table_info_->GetTableHeap()->Begin(exec_ctx_->GetTransaction()));
+	batch_.size_ = 0;
+	batch_.started_ = false;
+	pos_ = 0;
+	auto predicate = plan_->GetPredicate();
+	if (predicate != nullptr) {
+		filter_ = [predicate](const RowView& row) {
+			return predicate->EvaluateView(&row).CompareEquals(Field(kTypeInt, 1)) != CmpBool::kFalse;
+		};
+	}
+	else {
+		filter_ = nullptr;
+	}
 	schema_ = plan_->OutputSchema();
 	is_schema_same_ = SchemaEqual(table_info_->GetSchema(), schema_);
 }
 
 bool SeqScanExecutor::Next(Row* row, RowId* rid) {
-	auto predicate = plan_->GetPredicate();
-	auto table_schema = table_info_->GetSchema();
-	while (iterator_ != table_info_->GetTableHeap()->End()) {
-		auto p_row = &(*iterator_);
-		if (predicate != nullptr) {
-			if (!predicate->Evaluate(p_row).CompareEquals(Field(kTypeInt, 1))) {
-				iterator_++;
-				continue;
-			}
-		}
-		*rid = iterator_->GetRowId();
-		if (!is_schema_same_) {
-			TupleTransfer(table_schema, schema_, p_row, row);
-		}
-		else {
-			*row = *p_row;
+	auto table_heap = table_info_->GetTableHeap();
+	while (pos_ >= batch_.size_) {
+		pos_ = 0;
+		if (!table_heap->NextBatch(batch_, exec_ctx_->GetTransaction(), filter_)) {
+			return false;
 		}
-		iterator_++;
-		return true;
 	}
-	return false;
+	const Row* p_row = &batch_.rows_[pos_++];
+	*rid = p_row->GetRowId();
+	if (!is_schema_same_) {
+		TupleTransfer(table_info_->GetSchema(), schema_, p_row, row);
+	}
+	else {
+		*row = *p_row;
+	}
+	return true;
 }
@@ -0,0 +1,92 @@
+#ifndef MINISQL_ARC_REPLACER_H
+#define MINISQL_ARC_REPLACER_H
+
+#include <list>
+#include <unordered_map>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy.
+ *
+ * Resident frames are kept in two LRU lists: T1 holds pages seen once since they were loaded, T2 pages seen at least
+ * twice. When a frame is evicted, its page id is remembered in the ghost list B1 or B2. Loading a page that is still
+ * in a ghost list (a ghost hit) shifts the target size p of T1: a B1 hit means recency was undervalued, a B2 hit means
+ * frequency was. The split between scan-like and reuse-heavy workloads therefore tunes itself.
+ *
+ * Ghost lists need page ids, which the BufferPoolManager passes through Admit whenever it loads a page into a frame.
+ * The first Pin after Admit is the reference that loaded the page and does not promote it to T2, so pages brought in
+ * by read-ahead and then scanned once stay in T1.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * Create a new ARCReplacer.
+   * @param num_pages the number of frames the replacer manages, i.e. the cache size c
+   */
+  explicit ARCReplacer(size_t num_pages);
+
+  /**
+   * Destroys the ARCReplacer.
+   */
+  ~ARCReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void Admit(frame_id_t frame_id, page_id_t page_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  size_t GetGhostHitCount() override { return ghost_hits_; }
+
+  /** @return the current target size of T1 */
+  size_t GetTarget() const { return p_; }
+
+ private:
+  enum ListType { T1, T2 };
+
+  struct FrameInfo {
+    ListType list_;
+    list<frame_id_t>::iterator pos_;
+    page_id_t page_id_;
+    bool evictable_;
+    bool referenced_;  // pinned at least once since Admit
+  };
+
+  struct GhostList {
+    list<page_id_t> list_;
+    unordered_map<page_id_t, list<page_id_t>::iterator> map_;
+
+    void PushBack(page_id_t page_id);
+    void PopFront();
+    bool Erase(page_id_t page_id);
+    size_t Size() const { return list_.size(); }
+  };
+
+  /** Evict the least recently used unpinned frame of a resident list. */
+  bool EvictFrom(ListType list_type, frame_id_t *frame_id);
+
+  /** Trim the ghost lists so that |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c. */
+  void TrimGhosts();
+
+  inline list<frame_id_t> &Resident(ListType list_type) { return list_type == T1 ? t1_ : t2_; }
+
+  size_t capacity_;
+  size_t p_{0};
+  size_t evictable_count_{0};
+  size_t ghost_hits_{0};
+  list<frame_id_t> t1_, t2_;
+  GhostList b1_, b2_;
+  unordered_map<frame_id_t, FrameInfo> frames_;
+};
+
+#endif  // MINISQL_ARC_REPLACER_H
@@ -1,38 +1,179 @@
 #ifndef MINISQL_BUFFER_POOL_MANAGER_H
 #define MINISQL_BUFFER_POOL_MANAGER_H
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_guard.h"
 #include "page/disk_file_meta_page.h"
 #include "page/page.h"
 #include "storage/disk_manager.h"
+#include "storage/disk_scheduler.h"
 
 using namespace std;
 
+/**
+ * Logical pages [next_, end_) that are reserved on disk for one table heap or index and not used yet. Its owner
+ * creates pages with NewPage(page_id, run) and gives the rest back with ReleasePageRun when it goes away.
+ */
+struct PageRun {
+	page_id_t next_{INVALID_PAGE_ID};
+	page_id_t end_{INVALID_PAGE_ID};
+};
+
+/**
+ * BufferPoolManager caches disk pages in a fixed number of frames.
+ *
+ * The page table is split into num_shards independent shards, each owning its own latch, page table, free list,
+ * replacer and a disjoint subset of the frames (frame f belongs to shard f % num_shards). A page is always cached by
+ * shard page_id % num_shards, so threads touching pages of different shards never contend on the same latch.
+ *
+ * The replacement policy is chosen at construction time, replacer_k is only used by ReplacerType::kLRUK.
+ *
+ * An optional background writer (StartBackgroundFlusher) writes dirty unpinned frames back ahead of eviction, so that
+ * FetchPage/NewPage rarely have to write a dirty victim themselves.
+ *
+ * PrefetchPages loads pages on a background thread without pinning them, so that a following FetchPage is a hit.
+ *
+ * All page I/O goes through a DiskScheduler. A dirty victim is copied out and written back asynchronously, so the
+ * write overlaps with reading the page that replaces it; the scheduler keeps I/O of one page in order, so a later
+ * read of the victim still sees the written data. Read-ahead keeps its frames pinned while their reads are in flight
+ * without holding the shard latch, a FetchPage hitting such a frame waits for the read.
+ *
+ * The data of all frames is carved from a single PAGE_SIZE aligned arena, so frames can be read and written by a
+ * DiskManager opened with direct_io without a bounce buffer. With FRAME_ARENA_HUGE_PAGES, arenas of at least
+ * HUGE_PAGE_SIZE are aligned to it and advised to be backed by transparent huge pages.
+ */
 class BufferPoolManager {
+	friend class ParallelBufferPoolManager;
+
 	public:
-	explicit BufferPoolManager(size_t pool_size, DiskManager* disk_manager);
+	/** Reads the id of the page following a page in a page chain, INVALID_PAGE_ID at the end of the chain. */
+	using NextPageFunc = std::function<page_id_t(const char* page_data)>;
+
+	explicit BufferPoolManager(size_t pool_size, DiskManager* disk_manager, size_t num_shards = 1,
+	                           ReplacerType replacer_type = ReplacerType::kLRU, size_t replacer_k = 2);
+
+	virtual ~BufferPoolManager();
+
+	virtual Page* FetchPage(page_id_t page_id);
+
+	virtual bool UnpinPage(page_id_t page_id, bool is_dirty);
+
+	virtual bool FlushPage(page_id_t page_id);
+
+	virtual Page* NewPage(page_id_t& page_id);
+
+	virtual bool DeletePage(page_id_t page_id);
+
+	/**
+	 * Create the next page of run. When the run is used up, a new run of DEFAULT_PAGE_RUN_SIZE adjacent pages is
+	 * reserved first, so the pages of one owner are laid out sequentially on disk. Falls back to NewPage if the
+	 * file has no such run left.
+	 */
+	Page* NewPage(page_id_t& page_id, PageRun& run);
+
+	/** Give the unused pages of run back to the disk manager. */
+	void ReleasePageRun(PageRun& run);
 
-	~BufferPoolManager();
+	virtual bool IsPageFree(page_id_t page_id);
+
+	virtual bool CheckAllUnpinned();
+
+	/**
+	 * Guarded variants of FetchPage/NewPage: the pin (and latch) is released when the guard goes out of scope.
+	 * The returned guard is empty if the page could not be fetched or created.
+	 */
+	BasicPageGuard FetchPageBasic(page_id_t page_id);
+
+	ReadPageGuard FetchPageRead(page_id_t page_id);
+
+	WritePageGuard FetchPageWrite(page_id_t page_id);
+
+	BasicPageGuard NewPageGuarded(page_id_t& page_id, PageRun* run = nullptr);
+
+	/** @return the number of frames managed by this buffer pool */
+	virtual size_t GetPoolSize() const { return pool_size_; }
+
+	/** @return the number of FetchPage calls served without reading from disk */
+	virtual size_t GetHitCount();
+
+	/** @return the number of FetchPage calls that had to read the page from disk */
+	virtual size_t GetMissCount();
+
+	/**
+	 * Start the background writer. Every interval_ms, or sooner when an eviction had to write a dirty victim, it
+	 * writes dirty unpinned frames of each shard back until at least target_clean_ratio of the shard's frames are
+	 * free or clean. Does nothing if the writer is already running.
+	 */
+	virtual void StartBackgroundFlusher(double target_clean_ratio = DEFAULT_FLUSHER_CLEAN_RATIO,
+	                                    uint32_t interval_ms = DEFAULT_FLUSHER_INTERVAL_MS);
 
-	Page* FetchPage(page_id_t page_id);
+	/** Stop the background writer and wait for it to exit. Called by the destructor. */
+	virtual void StopBackgroundFlusher();
 
-	bool UnpinPage(page_id_t page_id, bool is_dirty);
+	/** @return the number of pages written by the background writer */
+	virtual size_t GetBackgroundFlushCount();
 
-	bool FlushPage(page_id_t page_id);
+	/**
+	 * Asynchronously load up to n pages that are not in the pool yet, starting at start. The following pages are
+	 * found through next_page, or are start + 1, start + 2 ... if it is empty. Prefetched pages stay unpinned and
+	 * are not counted as accessed by the replacer. Requests are dropped when the read-ahead queue is full.
+	 */
+	virtual void PrefetchPages(page_id_t start, size_t n, NextPageFunc next_page = nullptr);
 
-	Page* NewPage(page_id_t& page_id);
+	/** @return the number of pages read from disk by read-ahead whose read has completed */
+	virtual size_t GetPrefetchCount();
 
-	bool DeletePage(page_id_t page_id);
+	/** @return the number of ghost list hits reported by the replacers (only ReplacerType::kARC has ghost lists) */
+	virtual size_t GetGhostHitCount();
 
-	bool IsPageFree(page_id_t page_id);
+	protected:
+	/** Used by subclasses that delegate to other buffer pools and own no frames themselves. */
+	explicit BufferPoolManager(DiskManager* disk_manager)
+		: pool_size_(0),
+		  pages_(nullptr),
+		  frame_arena_(nullptr),
+		  disk_manager_(disk_manager),
+		  disk_scheduler_(std::make_shared<DiskScheduler>(disk_manager)),
+		  num_shards_(0),
+		  shards_(nullptr) {}
 
-	bool CheckAllUnpinned();
+	/** Outcome of StartPrefetch. */
+	enum class PrefetchStatus { kResident, kLoading, kStop };
 
 	private:
+	struct PrefetchRequest {
+		page_id_t start_;
+		size_t n_;
+		NextPageFunc next_page_;
+	};
+
+	/**
+	 * A slice of the buffer pool guarded by a single latch.
+	 */
+	struct Shard {
+		unordered_map<page_id_t, frame_id_t> page_table_;  // to keep track of pages
+		Replacer* replacer_{nullptr};                      // to find an unpinned page for replacement
+		list<frame_id_t> free_list_;                       // to find a free page for replacement
+		recursive_mutex latch_;                            // to protect shared data structure
+		size_t hit_count_{0};                              // FetchPage served from the pool
+		size_t miss_count_{0};                             // FetchPage read from disk
+	};
+
 	/**
 	 * Allocate new page (operations like create index/table) For now just keep an increasing counter
 	 */
@@ -43,16 +184,85 @@ class BufferPoolManager {
 	 */
 	void DeallocatePage(page_id_t page_id);
 
-	frame_id_t TryToFindFreePage();
+	/** @return the shard responsible for caching page_id, nullptr for a pool that delegates and has no shards */
+	inline Shard* ShardOf(page_id_t page_id) {
+		return num_shards_ == 0 ? nullptr : &shards_[static_cast<size_t>(page_id) % num_shards_];
+	}
 
-	private:
-	size_t pool_size_;                                 // number of pages in buffer pool
-	Page* pages_;                                      // array of pages
-	DiskManager* disk_manager_;                        // pointer to the disk manager.
-	unordered_map<page_id_t, frame_id_t> page_table_;  // to keep track of pages
-	Replacer* replacer_;                               // to find an unpinned page for replacement
-	list<frame_id_t> free_list_;                       // to find a free page for replacement
-	recursive_mutex latch_;                            // to protect shared data structure
+	/**
+	 * Pick a frame from the shard's free list or its replacer, writing the old content back if dirty.
+	 * Caller must hold shard.latch_.
+	 * @return the frame id, or INVALID_FRAME_ID if every frame of the shard is pinned
+	 */
+	frame_id_t TryToFindFreePage(Shard& shard);
+
+	/**
+	 * Pin a zeroed frame for a page id that has already been allocated on disk.
+	 * @return nullptr if every frame of the owning shard is pinned, the page id is NOT given back in that case
+	 */
+	virtual Page* NewPageWithId(page_id_t page_id);
+
+	/** Write the frame back to disk. Caller must hold the latch of the shard owning the frame. */
+	void FlushFrame(frame_id_t frame_id);
+
+	/**
+	 * Start loading one page for read-ahead.
+	 * @return kResident if the page is already cached, next_page_id is set from it in that case;
+	 *         kLoading if the read was scheduled, wait for read and call FinishPrefetch (next_page_id is only set if
+	 *         next_page is empty);
+	 *         kStop if the page is free on disk or the shard has no evictable frame
+	 */
+	virtual PrefetchStatus StartPrefetch(page_id_t page_id, const NextPageFunc& next_page, page_id_t& next_page_id,
+	                                     std::shared_future<bool>& read);
+
+	/**
+	 * Release the frame of a page loaded by StartPrefetch once its read has completed.
+	 * @return the next page of the chain
+	 */
+	virtual page_id_t FinishPrefetch(page_id_t page_id, const NextPageFunc& next_page);
+
+	/** Load one read-ahead request, independent pages are read in parallel. */
+	void Prefetch(const PrefetchRequest& request);
+
+	/** Main loop of the read-ahead thread. */
+	void PrefetchLoop();
+
+	/** Stop the read-ahead thread and wait for it to exit. */
+	void StopPrefetcher();
+
+	/** One round of the background writer over all shards. */
+	void FlushDirtyFrames();
+
+	/** Main loop of the background writer thread. */
+	void BackgroundFlusherLoop();
+
+	protected:
+	size_t pool_size_;           // number of pages in buffer pool
+	Page* pages_;                // array of pages
+	char* frame_arena_;          // data of all frames, pool_size_ * PAGE_SIZE bytes
+	DiskManager* disk_manager_;  // pointer to the disk manager.
+	std::shared_ptr<DiskScheduler> disk_scheduler_;  // asynchronous page I/O, shared by parallel instances
+	std::vector<std::shared_future<bool>> pending_reads_;  // per frame, read-ahead still in flight
+	size_t num_shards_;          // number of page table shards
+	Shard* shards_;              // array of shards
+
+	// background writer
+	std::thread flusher_thread_;
+	std::mutex flusher_latch_;
+	std::condition_variable flusher_cv_;
+	bool flusher_running_{false};
+	double flusher_clean_ratio_{0};
+	uint32_t flusher_interval_ms_{0};
+	std::atomic<size_t> background_flush_count_{0};
+
+	// read-ahead
+	static constexpr size_t MAX_PREFETCH_REQUESTS = 16;
+	std::thread prefetch_thread_;
+	std::mutex prefetch_latch_;
+	std::condition_variable prefetch_cv_;
+	std::deque<PrefetchRequest> prefetch_queue_;
+	bool prefetch_running_{false};
+	std::atomic<size_t> prefetch_count_{0};
 };
 
 #endif  // MINISQL_BUFFER_POOL_MANAGER_H
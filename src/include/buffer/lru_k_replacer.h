@@ -0,0 +1,77 @@
+#ifndef MINISQL_LRU_K_REPLACER_H
+#define MINISQL_LRU_K_REPLACER_H
+
+#include <deque>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The backward k-distance of a frame is the time since its k-th most recent access. The frame with the largest
+ * backward k-distance is evicted first. Frames with fewer than k accesses have an infinite distance and are evicted
+ * before all others, oldest first access first. A single sequential scan therefore only competes with pages that were
+ * touched once, and cannot push out pages that are accessed repeatedly (e.g. B+ tree internal pages).
+ *
+ * Every Pin counts as one access. A frame admitted without being pinned (read-ahead) has no access yet and is ordered
+ * by its admission time.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of accesses tracked per frame
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = 2);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void Admit(frame_id_t frame_id, page_id_t page_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+ private:
+  struct FrameInfo {
+    deque<size_t> history_;  // timestamps of the last k accesses, oldest first
+    size_t admitted_{0};     // timestamp of the admission, orders frames without accesses
+    bool evictable_{false};
+  };
+
+  /** @return the set a frame with this history is ordered in while evictable */
+  inline set<pair<size_t, frame_id_t>> &SetOf(const FrameInfo &info) {
+    return info.history_.size() < k_ ? inf_frames_ : k_frames_;
+  }
+
+  /** @return the position of a frame in its set */
+  inline pair<size_t, frame_id_t> KeyOf(const FrameInfo &info, frame_id_t frame_id) {
+    return {info.history_.empty() ? info.admitted_ : info.history_.front(), frame_id};
+  }
+
+  size_t k_;
+  size_t current_timestamp_{0};
+  unordered_map<frame_id_t, FrameInfo> frames_;
+  // evictable frames with less than k accesses, ordered by their first access
+  set<pair<size_t, frame_id_t>> inf_frames_;
+  // evictable frames with k accesses, ordered by their k-th most recent access
+  set<pair<size_t, frame_id_t>> k_frames_;
+};
+
+#endif  // MINISQL_LRU_K_REPLACER_H
@@ -0,0 +1,183 @@
+#ifndef MINISQL_PAGE_GUARD_H
+#define MINISQL_PAGE_GUARD_H
+
+#include "page/page.h"
+
+class BufferPoolManager;
+class ReadPageGuard;
+class WritePageGuard;
+
+/**
+ * BasicPageGuard owns one pin of a buffer pool page and unpins it when it goes out of scope, with the dirty flag set
+ * if the page was ever accessed through AsMut/GetDataMut or MarkDirty. It takes no page latch.
+ *
+ * Guards are move-only. A default constructed or moved-from guard is empty and does nothing on destruction.
+ */
+class BasicPageGuard {
+	public:
+	BasicPageGuard() = default;
+
+	BasicPageGuard(BufferPoolManager* bpm, Page* page) : bpm_(bpm), page_(page) {}
+
+	BasicPageGuard(const BasicPageGuard&) = delete;
+
+	BasicPageGuard& operator=(const BasicPageGuard&) = delete;
+
+	BasicPageGuard(BasicPageGuard&& that) noexcept;
+
+	BasicPageGuard& operator=(BasicPageGuard&& that) noexcept;
+
+	~BasicPageGuard() { Drop(); }
+
+	/** Unpin the page now. The guard is empty afterwards. */
+	void Drop();
+
+	/** Take the read latch and turn this guard into a ReadPageGuard. This guard is empty afterwards. */
+	ReadPageGuard UpgradeRead();
+
+	/** Take the write latch and turn this guard into a WritePageGuard. This guard is empty afterwards. */
+	WritePageGuard UpgradeWrite();
+
+	/** @return true if the guard holds a page */
+	bool IsValid() const { return page_ != nullptr; }
+
+	explicit operator bool() const { return IsValid(); }
+
+	page_id_t PageId() const { return page_ == nullptr ? INVALID_PAGE_ID : page_->GetPageId(); }
+
+	BufferPoolManager* GetBufferPoolManager() const { return bpm_; }
+
+	/** For page types that derive from Page, e.g. TablePage. Call MarkDirty after modifying it. */
+	Page* GetPage() const { return page_; }
+
+	const char* GetData() const { return page_->GetData(); }
+
+	char* GetDataMut() {
+		is_dirty_ = true;
+		return page_->GetData();
+	}
+
+	template <class T>
+	const T* As() const {
+		return reinterpret_cast<const T*>(page_->GetData());
+	}
+
+	template <class T>
+	T* AsMut() {
+		is_dirty_ = true;
+		return reinterpret_cast<T*>(page_->GetData());
+	}
+
+	/** Unpin the page as dirty even if it was only accessed through As/GetData. */
+	void MarkDirty() { is_dirty_ = true; }
+
+	private:
+	friend class ReadPageGuard;
+	friend class WritePageGuard;
+
+	BufferPoolManager* bpm_{nullptr};
+	Page* page_{nullptr};
+	bool is_dirty_{false};
+};
+
+/**
+ * ReadPageGuard holds a pin and the read latch of a page, both are released on destruction.
+ */
+class ReadPageGuard {
+	public:
+	ReadPageGuard() = default;
+
+	/** The page must already be read latched. */
+	ReadPageGuard(BufferPoolManager* bpm, Page* page) : guard_(bpm, page) {}
+
+	ReadPageGuard(const ReadPageGuard&) = delete;
+
+	ReadPageGuard& operator=(const ReadPageGuard&) = delete;
+
+	ReadPageGuard(ReadPageGuard&& that) noexcept = default;
+
+	ReadPageGuard& operator=(ReadPageGuard&& that) noexcept;
+
+	~ReadPageGuard() { Drop(); }
+
+	/** Release the read latch and unpin the page now. The guard is empty afterwards. */
+	void Drop();
+
+	bool IsValid() const { return guard_.IsValid(); }
+
+	explicit operator bool() const { return IsValid(); }
+
+	page_id_t PageId() const { return guard_.PageId(); }
+
+	/** For page types that derive from Page, e.g. TablePage. */
+	Page* GetPage() const { return guard_.GetPage(); }
+
+	const char* GetData() const { return guard_.GetData(); }
+
+	template <class T>
+	const T* As() const {
+		return guard_.As<T>();
+	}
+
+	private:
+	friend class BasicPageGuard;
+
+	BasicPageGuard guard_;
+};
+
+/**
+ * WritePageGuard holds a pin and the write latch of a page, both are released on destruction. Like BasicPageGuard,
+ * the page is unpinned as dirty once it was accessed through AsMut/GetDataMut or MarkDirty.
+ */
+class WritePageGuard {
+	public:
+	WritePageGuard() = default;
+
+	/** The page must already be write latched. */
+	WritePageGuard(BufferPoolManager* bpm, Page* page) : guard_(bpm, page) {}
+
+	WritePageGuard(const WritePageGuard&) = delete;
+
+	WritePageGuard& operator=(const WritePageGuard&) = delete;
+
+	WritePageGuard(WritePageGuard&& that) noexcept = default;
+
+	WritePageGuard& operator=(WritePageGuard&& that) noexcept;
+
+	~WritePageGuard() { Drop(); }
+
+	/** Release the write latch and unpin the page now. The guard is empty afterwards. */
+	void Drop();
+
+	bool IsValid() const { return guard_.IsValid(); }
+
+	explicit operator bool() const { return IsValid(); }
+
+	page_id_t PageId() const { return guard_.PageId(); }
+
+	/** For page types that derive from Page, e.g. TablePage. Call MarkDirty after modifying it. */
+	Page* GetPage() const { return guard_.GetPage(); }
+
+	const char* GetData() const { return guard_.GetData(); }
+
+	char* GetDataMut() { return guard_.GetDataMut(); }
+
+	template <class T>
+	const T* As() const {
+		return guard_.As<T>();
+	}
+
+	template <class T>
+	T* AsMut() {
+		return guard_.AsMut<T>();
+	}
+
+	void MarkDirty() { guard_.MarkDirty(); }
+
+	private:
+	friend class BasicPageGuard;
+
+	BasicPageGuard guard_;
+};
+
+#endif  // MINISQL_PAGE_GUARD_H
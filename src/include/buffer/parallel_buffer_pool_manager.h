@@ -0,0 +1,80 @@
+#ifndef MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+#define MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+
+/**
+ * ParallelBufferPoolManager splits the buffer pool into num_instances independent BufferPoolManager instances that
+ * share one disk manager. Page page_id always lives in instance page_id % num_instances.
+ *
+ * New page ids are handed out by the disk manager in increasing order, so consecutive NewPage calls land on
+ * consecutive instances. If the instance of the next id is full, NewPage moves on to the following ids, so a page is
+ * created as long as any instance has a free frame.
+ *
+ * All instances share one DiskScheduler, so the number of I/O threads does not grow with the number of instances.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+	public:
+	ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager* disk_manager,
+	                          ReplacerType replacer_type = ReplacerType::kLRU, size_t replacer_k = 2);
+
+	~ParallelBufferPoolManager() override;
+
+	Page* FetchPage(page_id_t page_id) override;
+
+	bool UnpinPage(page_id_t page_id, bool is_dirty) override;
+
+	bool FlushPage(page_id_t page_id) override;
+
+	Page* NewPage(page_id_t& page_id) override;
+
+	using BufferPoolManager::NewPage;
+
+	bool DeletePage(page_id_t page_id) override;
+
+	bool IsPageFree(page_id_t page_id) override;
+
+	bool CheckAllUnpinned() override;
+
+	size_t GetPoolSize() const override { return total_pool_size_; }
+
+	size_t GetHitCount() override;
+
+	size_t GetMissCount() override;
+
+	size_t GetGhostHitCount() override;
+
+	/** Starts one background writer per instance. */
+	void StartBackgroundFlusher(double target_clean_ratio = DEFAULT_FLUSHER_CLEAN_RATIO,
+	                            uint32_t interval_ms = DEFAULT_FLUSHER_INTERVAL_MS) override;
+
+	void StopBackgroundFlusher() override;
+
+	size_t GetBackgroundFlushCount() override;
+
+	size_t GetPrefetchCount() override;
+
+	/** @return the number of buffer pool instances */
+	size_t GetNumInstances() const { return instances_.size(); }
+
+	private:
+	Page* NewPageWithId(page_id_t page_id) override;
+
+	PrefetchStatus StartPrefetch(page_id_t page_id, const NextPageFunc& next_page, page_id_t& next_page_id,
+	                             std::shared_future<bool>& read) override;
+
+	page_id_t FinishPrefetch(page_id_t page_id, const NextPageFunc& next_page) override;
+
+	/** @return the instance responsible for page_id */
+	inline BufferPoolManager* InstanceOf(page_id_t page_id) {
+		return instances_[static_cast<size_t>(page_id) % instances_.size()];
+	}
+
+	private:
+	std::vector<BufferPoolManager*> instances_;
+	size_t total_pool_size_;
+};
+
+#endif  // MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
@@ -5,6 +5,11 @@
 
 #include "common/config.h"
 
+/**
+ * Replacement policies a BufferPoolManager can be built with.
+ */
+enum class ReplacerType { kLRU = 0, kClock, kLRUK, kARC };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -33,8 +38,26 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Tells the replacer which page has just been loaded into a pinned frame. Policies that remember evicted pages
+   * (ghost lists) need this, the others ignore it.
+   * @param frame_id the id of the frame
+   * @param page_id the id of the page now held by the frame
+   */
+  virtual void Admit(__attribute__((unused)) frame_id_t frame_id, __attribute__((unused)) page_id_t page_id) {}
+
+  /**
+   * Forgets everything about a frame, e.g. because its page was deleted. The frame is not victimized afterwards
+   * until it is unpinned again.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
+
+  /** @return the number of loaded pages that were found in a ghost list, 0 for policies without ghost lists */
+  virtual size_t GetGhostHitCount() { return 0; }
 };
 
 #endif  // MINISQL_REPLACER_H
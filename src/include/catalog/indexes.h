@@ -14,8 +14,12 @@ class IndexMetadata {
   friend class IndexInfo;
 
  public:
+  /**
+   * New indexes compare their keys with memcmp, see KeyEncoding.
+   */
   static IndexMetadata *Create(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                               const std::vector<uint32_t> &key_map);
+                               const std::vector<uint32_t> &key_map,
+                               KeyEncoding key_encoding = KeyEncoding::kMemcomparable);
 
   uint32_t SerializeTo(char *buf) const;
 
@@ -33,18 +37,24 @@ class IndexMetadata {
 
   inline index_id_t GetIndexId() const { return index_id_; }
 
+  inline KeyEncoding GetKeyEncoding() const { return key_encoding_; }
+
  private:
   IndexMetadata() = delete;
 
   explicit IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                         const std::vector<uint32_t> &key_map);
+                         const std::vector<uint32_t> &key_map, KeyEncoding key_encoding);
 
  private:
+  // metadata written before the key encoding was recorded, its index keys are kRow
   static constexpr uint32_t INDEX_METADATA_MAGIC_NUM = 344528;
+  // followed by the key encoding after the key mapping
+  static constexpr uint32_t INDEX_METADATA_ENCODING_MAGIC_NUM = 344529;
   index_id_t index_id_;
   std::string index_name_;
   table_id_t table_id_;
   std::vector<uint32_t> key_map_; /** The mapping of index key to tuple key */
+  KeyEncoding key_encoding_;
 };
 
 /**
@@ -0,0 +1,63 @@
+#ifndef MINISQL_ARENA_H
+#define MINISQL_ARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+
+#include "common/macros.h"
+
+/**
+ * A bump pointer memory resource. Memory is carved from blocks taken from the upstream resource, deallocate does
+ * nothing and all blocks are given back at once by Reset() or when the arena is destroyed, so memory from an arena
+ * must not be used after that.
+ *
+ * Containers use it through std::pmr, e.g. a Row constructed with an arena keeps its fields and char data there. The
+ * blocks grow from block_size up to MAX_BLOCK_SIZE, a larger request gets a block of its own. Not thread safe.
+ */
+class Arena : public std::pmr::memory_resource {
+ public:
+  static constexpr size_t DEFAULT_BLOCK_SIZE = 4096;
+  static constexpr size_t MAX_BLOCK_SIZE = 1 << 20;
+
+  explicit Arena(size_t block_size = DEFAULT_BLOCK_SIZE,
+                 std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+      : block_size_(block_size), next_block_size_(block_size), upstream_(upstream) {}
+
+  ~Arena() override { Reset(); }
+
+  DISALLOW_COPY_AND_MOVE(Arena);
+
+  /** Give all blocks back to the upstream resource, everything allocated from the arena is freed. */
+  void Reset();
+
+  /** @return the number of blocks taken from the upstream resource since the last Reset() */
+  size_t GetBlockCount() const { return block_count_; }
+
+  /** @return the number of bytes handed out since the last Reset() */
+  size_t GetBytesAllocated() const { return bytes_allocated_; }
+
+ protected:
+  void *do_allocate(size_t bytes, size_t alignment) override;
+
+  void do_deallocate(void * /*p*/, size_t /*bytes*/, size_t /*alignment*/) override {}
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+ private:
+  // header of a block, followed by its memory
+  struct Block {
+    Block *prev_;
+    size_t size_;  // including the header
+  };
+
+  Block *head_{nullptr};
+  char *cur_{nullptr};
+  char *end_{nullptr};
+  size_t block_size_;
+  size_t next_block_size_;
+  std::pmr::memory_resource *upstream_;
+  size_t block_count_{0};
+  size_t bytes_allocated_{0};
+};
+
+#endif  // MINISQL_ARENA_H
@@ -9,12 +9,23 @@ static constexpr int INVALID_FRAME_ID = -1;  // invalid recovery id
 static constexpr int INVALID_TXN_ID = -1;    // invalid recovery id
 static constexpr int INVALID_LSN = -1;       // invalid log sequence number
 
-static constexpr int META_PAGE_ID = 0;          // physical page id of the disk file meta info
+static constexpr int META_PAGE_ID = 0;          // physical page id of the first disk file meta page
 static constexpr int CATALOG_META_PAGE_ID = 0;  // logical page id of the catalog meta data
 static constexpr int INDEX_ROOTS_PAGE_ID = 1;   // logical page id of the index roots
 
 static constexpr int PAGE_SIZE = 4096;                  // size of a data page in byte
+static constexpr int PAGE_CHECKSUM_SIZE = 4;            // CRC32C stamped into the last bytes of a data page on write
+static constexpr int PAGE_USABLE_SIZE = PAGE_SIZE - PAGE_CHECKSUM_SIZE;  // bytes of a data page free for its content
 static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;  // default size of buffer pool
+static constexpr int DEFAULT_BUFFER_POOL_INSTANCES = 1;  // default number of buffer pool instances
+static constexpr double DEFAULT_FLUSHER_CLEAN_RATIO = 0.25;  // share of frames the background writer keeps clean
+static constexpr uint32_t DEFAULT_FLUSHER_INTERVAL_MS = 10;  // background writer wake-up interval
+static constexpr uint32_t DEFAULT_PREFETCH_PAGES = 8;       // pages read ahead by sequential table scans
+static constexpr size_t DEFAULT_DISK_SCHEDULER_WORKERS = 4;  // I/O worker threads of the disk scheduler
+static constexpr uint32_t DEFAULT_PAGE_RUN_SIZE = 64;         // contiguous pages reserved at once by a table or index
+static constexpr uint32_t DEFAULT_VACUUM_STEPS = 1024;        // table heap pages one VACUUM statement works through
+static constexpr bool FRAME_ARENA_HUGE_PAGES = true;          // advise huge pages for buffer pool frames
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;     // alignment of a frame arena backed by huge pages
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
 static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;  // max length of varchar
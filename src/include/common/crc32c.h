@@ -0,0 +1,21 @@
+#ifndef MINISQL_CRC32C_H
+#define MINISQL_CRC32C_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * CRC32C (Castagnoli) of len bytes, continuing from crc (0 for a new checksum).
+ *
+ * Uses the SSE4.2 crc32 instruction on x86-64 and the CRC32 extension on AArch64 when the CPU has them, a table
+ * driven implementation otherwise. Both produce the same value.
+ */
+uint32_t Crc32c(const char *data, size_t len, uint32_t crc = 0);
+
+/** Table driven CRC32C, used when the CPU has no crc32 instruction. */
+uint32_t Crc32cSoftware(const char *data, size_t len, uint32_t crc = 0);
+
+/** @return true if Crc32c uses a crc32 instruction */
+bool Crc32cIsHardwareAccelerated();
+
+#endif  // MINISQL_CRC32C_H
@@ -7,6 +7,7 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
+#include "common/arena.h"
 #include "common/macros.h"
 #include "concurrency/txn.h"
 
@@ -34,6 +35,13 @@ class ExecuteContext {
   /** @return the buffer pool manager */
   BufferPoolManager *GetBufferPoolManager() { return bpm_; }
 
+  /**
+   * @return the arena of the query, buffers the executors keep while the query runs, e.g. the page batch of a scan,
+   * are placed there and freed together with the context. The arena only grows, so temporaries of a single tuple do
+   * not belong there, executors reuse member rows for them.
+   */
+  Arena *GetArena() { return &arena_; }
+
  private:
   /** The recovery context associated with this executor context */
   Txn *transaction_;
@@ -41,6 +49,8 @@ class ExecuteContext {
   CatalogManager *catalog_;
   /** The buffer pool manager associated with this executor context */
   BufferPoolManager *bpm_;
+  /** Memory for the temporary rows of the query */
+  Arena arena_;
 };
 
 #endif  // MINISQL_EXECUTE_CONTEXT_H
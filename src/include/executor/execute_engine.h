@@ -1,6 +1,7 @@
 #ifndef MINISQL_EXECUTE_ENGINE_H
 #define MINISQL_EXECUTE_ENGINE_H
 
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -12,6 +13,7 @@
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/abstract_plan.h"
 #include "record/row.h"
+#include "storage/table_heap.h"
 
 extern "C" {
 #include "parser/parser.h"
@@ -73,9 +75,13 @@ class ExecuteEngine {
 
   dberr_t ExecuteQuit(pSyntaxNode ast, ExecuteContext *context);
 
+  dberr_t ExecuteVacuum(pSyntaxNode ast, ExecuteContext *context);
+
  private:
   std::unordered_map<std::string, DBStorageEngine *> dbs_; /** all opened databases */
   std::string current_db_;                                 /** current database */
+  /** where VACUUM stopped in each table of each database, the next VACUUM continues there */
+  std::map<std::pair<std::string, table_id_t>, TableHeap::VacuumCursor> vacuum_cursors_;
 };
 
 #endif  // MINISQL_EXECUTE_ENGINE_H
@@ -46,5 +46,7 @@ class IndexScanExecutor : public AbstractExecutor {
   TableInfo *table_info_{};
   vector<RowId> result_;
   size_t cursor_ = 0;
+  // the tuple read for the current row id
+  Row tuple_;
   bool is_schema_same_;
 };
\ No newline at end of file
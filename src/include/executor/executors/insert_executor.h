@@ -35,6 +35,7 @@ class InsertExecutor : public AbstractExecutor {
    * @return `true` if a row was produced, `false` if there are no more rows
    *
    * NOTE: InsertExecutor::Next() does not use the `rid` out-parameter.
+   * NOTE: the first call inserts all rows of the child executor at once, following calls yield one per row inserted.
    */
   bool Next([[maybe_unused]] Row *row, RowId *rid) override;
 
@@ -48,6 +49,16 @@ class InsertExecutor : public AbstractExecutor {
   TableInfo *table_info_{};
   const Schema *schema_{};
   std::vector<IndexInfo *> index_info_;
+  bool loaded_{false};
+  size_t inserted_{0};
+  size_t cursor_{0};
+
+  /**
+   * Pull all rows from the child executor and insert them with TableHeap::InsertTuples. Stops at the first row whose
+   * key already exists, the rows before it stay inserted.
+   * @return the number of rows inserted
+   */
+  size_t InsertAll();
 };
 
 #endif  // MINISQL_INSERT_EXECUTOR_H
@@ -13,6 +13,8 @@
 
 /**
  * The SeqScanExecutor executor executes a sequential table scan.
+ * The table is read a page at a time, the predicate is evaluated on the tuples in place and only the tuples passing it
+ * are copied out of the page.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -45,7 +47,10 @@ class SeqScanExecutor : public AbstractExecutor {
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
   TableInfo *table_info_{};
-  TableIterator iterator_;
+  // rows of the current page that passed the predicate, rows before pos_ have been returned
+  TableBatch batch_;
+  size_t pos_{0};
+  RowFilter filter_;
   const Schema *schema_{};
   bool is_schema_same_;
 };
@@ -48,8 +48,9 @@ class UpdateExecutor : public AbstractExecutor {
    * Given a row, creates a new, updated row
    * based on the `UpdateInfo` provided in the plan.
    * @param src_row The row to be updated
+   * @param[out] dest_row The updated row, its buffers are reused
    */
-  Row GenerateUpdatedTuple(const Row &src_row);
+  void GenerateUpdatedTuple(const Row &src_row, Row &dest_row);
 
   /** The update plan node to be executed */
   const UpdatePlanNode *plan_;
@@ -59,6 +60,12 @@ class UpdateExecutor : public AbstractExecutor {
   std::vector<IndexInfo *> index_info_;
   /** The child executor to obtain value from */
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** Rows and values of the current tuple, reused for every tuple */
+  Row src_row_;
+  Row dest_row_;
+  Row src_key_row_;
+  Row dest_key_row_;
+  std::vector<Field> values_;
 };
 
 #endif  // MINISQL_UPDATE_EXECUTOR_H
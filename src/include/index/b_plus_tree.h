@@ -1,6 +1,7 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <fstream>
 #include <queue>
 #include <string>
 #include <vector>
@@ -29,6 +30,9 @@ class BPlusTree {
   explicit BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &comparator,
                      int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE);
 
+  // gives the reserved but unused pages back
+  ~BPlusTree();
+
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
 
@@ -48,7 +52,7 @@ class BPlusTree {
   IndexIterator End();
 
   // expose for test purpose
-  Page *FindLeafPage(const GenericKey *key, page_id_t page_id = INVALID_PAGE_ID, bool leftMost = false);
+  BasicPageGuard FindLeafPage(const GenericKey *key, page_id_t page_id = INVALID_PAGE_ID, bool leftMost = false);
 
   // used to check whether all pages are unpinned
   bool Check();
@@ -61,8 +65,8 @@ class BPlusTree {
       return;
     }
     out << "digraph G {" << std::endl;
-    Page *root_page = buffer_pool_manager_->FetchPage(root_page_id_);
-    auto *node = reinterpret_cast<BPlusTreePage *>(root_page->GetData());
+    BasicPageGuard root_guard = buffer_pool_manager_->FetchPageBasic(root_page_id_);
+    auto *node = const_cast<BPlusTreePage *>(root_guard.As<BPlusTreePage>());
     ToGraph(node, buffer_pool_manager_, out, schema);
     out << "}" << std::endl;
   }
@@ -74,12 +78,12 @@ class BPlusTree {
 
   void InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node, Txn *transaction = nullptr);
 
-  LeafPage *Split(LeafPage *node, Txn *transaction);
+  BasicPageGuard Split(LeafPage *node, Txn *transaction);
 
-  InternalPage *Split(InternalPage *node, Txn *transaction);
+  BasicPageGuard Split(InternalPage *node, Txn *transaction);
 
   template <typename N>
-  bool CoalesceOrRedistribute(N *&node, Txn *transaction = nullptr);
+  bool CoalesceOrRedistribute(BasicPageGuard &node_guard, Txn *transaction = nullptr);
 
   bool Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
                 Txn *transaction = nullptr);
@@ -87,9 +91,9 @@ class BPlusTree {
   bool Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
                 Txn *transaction = nullptr);
 
-  void Redistribute(LeafPage *neighbor_node, LeafPage *node, int index);
+  void Redistribute(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index);
 
-  void Redistribute(InternalPage *neighbor_node, InternalPage *node, int index);
+  void Redistribute(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index);
 
   bool AdjustRoot(BPlusTreePage *node);
 
@@ -107,6 +111,8 @@ class BPlusTree {
   KeyManager processor_;
   int leaf_max_size_;
   int internal_max_size_;
+  // pages reserved for the growth of this tree, so that its nodes are laid out close together on disk
+  PageRun page_run_;
 };
 
 #endif  // MINISQL_B_PLUS_TREE_H
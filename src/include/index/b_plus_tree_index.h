@@ -7,7 +7,8 @@
 
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager);
+  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager,
+                 KeyEncoding key_encoding = KeyEncoding::kRow);
 
   dberr_t InsertEntry(const Row &key, RowId row_id, Txn *txn) override;
 
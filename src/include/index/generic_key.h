@@ -2,15 +2,30 @@
 #define MINISQL_GENERIC_KEY_H
 
 #include <cstring>
+#include <memory>
 
 #include "record/field.h"
 #include "record/row.h"
+#include "record/row_codec.h"
 
 class GenericKey {
   friend class KeyManager;
   char data[0];
 };
 
+/**
+ * How the key row is laid out in a GenericKey, the rest of the key_size bytes are 0 either way.
+ *
+ * kRow: the key row serialized by Row::SerializeTo. Comparing two keys deserializes both.
+ * kMemcomparable: every column of the key schema at a fixed offset, encoded so that memcmp orders keys as their
+ * fields compare. A column is a null flag byte, 0 for null, so null sorts first, then the value, all 0 for null:
+ *  - INT: the value with its sign bit flipped, big endian
+ *  - FLOAT: the bits with the sign bit flipped if positive, all bits flipped if negative, big endian; -0 is stored as 0
+ *  - CHAR(n): the chars padded with 0 to n bytes, then the length big endian, which orders a string before the
+ *    strings it is a prefix of
+ */
+enum class KeyEncoding : uint32_t { kRow = 0, kMemcomparable = 1 };
+
 class KeyManager {
  public: /**/
   [[nodiscard]] inline GenericKey *InitKey() const {
@@ -18,21 +33,151 @@ class KeyManager {
   }
 
   inline void SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const {
-    // initialize to 0
-    [[maybe_unused]] uint32_t size = key.GetSerializedSize(schema);
+    if (encoding_ == KeyEncoding::kMemcomparable) {
+      ASSERT(key.GetFieldCount() == key_schema_->GetColumnCount(), "field nums not match.");
+      memset(key_buf->data, 0, key_size_);
+      EncodeKey(key_buf->data, key);
+      return;
+    }
+    // the codec is built for key_schema_, other schemas go through the row
+    const RowCodec *codec = schema == codec_->GetSchema() ? codec_.get() : nullptr;
+    [[maybe_unused]] uint32_t size = codec != nullptr ? codec->GetSerializedSize(key) : key.GetSerializedSize(schema);
     ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
     ASSERT(size <= (uint32_t)key_size_, "Index key size exceed max key size.");
+    // initialize to 0
     memset(key_buf->data, 0, key_size_);
-    key.SerializeTo(key_buf->data, schema);
+    if (codec != nullptr) {
+      codec->SerializeTo(key, key_buf->data);
+    } else {
+      key.SerializeTo(key_buf->data, schema);
+    }
   }
 
   inline void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const {
-    [[maybe_unused]] uint32_t ofs = key.DeserializeFrom(const_cast<char *>(key_buf->data), schema);
+    if (encoding_ == KeyEncoding::kMemcomparable) {
+      DecodeKey(key_buf->data, key);
+      return;
+    }
+    [[maybe_unused]] uint32_t ofs = schema == codec_->GetSchema()
+                                        ? codec_->DeserializeFrom(key_buf->data, key)
+                                        : key.DeserializeFrom(const_cast<char *>(key_buf->data), schema);
     ASSERT(ofs <= (uint32_t)key_size_, "Index key size exceed max key size.");
   }
 
+  /**
+   * Comparators for the key widths index keys are rounded to, see IndexInfo::CreateIndex. The width is a constant,
+   * so the compiler inlines and unrolls the compare and copy of a key.
+   */
+  template <size_t N>
+  struct FixedComparator {
+    static constexpr size_t Size() { return N; }
+
+    int Compare(const GenericKey *lhs, const GenericKey *rhs) const { return memcmp(lhs->data, rhs->data, N); }
+
+    void Copy(char *dest, const GenericKey *src) const { memcpy(dest, src->data, N); }
+  };
+
+  /**
+   * A single INT column in the kMemcomparable encoding: the null flag and the value are the first 5 bytes and the rest
+   * is 0, so the first 8 bytes read big endian order the keys.
+   */
+  struct IntComparator : FixedComparator<16> {
+    int Compare(const GenericKey *lhs, const GenericKey *rhs) const {
+      uint64_t l, r;
+      memcpy(&l, lhs->data, sizeof(l));
+      memcpy(&r, rhs->data, sizeof(r));
+      l = __builtin_bswap64(l);
+      r = __builtin_bswap64(r);
+      return (l > r) - (l < r);
+    }
+  };
+
+  /** Any other key: kRow keys, or memcomparable keys of an unusual width. */
+  struct GenericComparator {
+    const KeyManager *manager_;
+
+    size_t Size() const { return manager_->key_size_; }
+
+    int Compare(const GenericKey *lhs, const GenericKey *rhs) const {
+      if (manager_->encoding_ == KeyEncoding::kMemcomparable) {
+        return memcmp(lhs->data, rhs->data, manager_->key_size_);
+      }
+      return manager_->CompareRowKeys(lhs, rhs);
+    }
+
+    void Copy(char *dest, const GenericKey *src) const { memcpy(dest, src->data, manager_->key_size_); }
+  };
+
+  /**
+   * Call f with the comparator of the keys, chosen once when the key manager is built. f gets the comparator as its
+   * concrete type, so a function template such as a page search is instantiated for every kind of key.
+   * @return what f returns
+   */
+  template <typename Func>
+  inline decltype(auto) Dispatch(Func &&f) const {
+    switch (comparator_) {
+      case ComparatorKind::kInt:
+        return f(IntComparator{});
+      case ComparatorKind::kFixed16:
+        return f(FixedComparator<16>{});
+      case ComparatorKind::kFixed32:
+        return f(FixedComparator<32>{});
+      case ComparatorKind::kFixed64:
+        return f(FixedComparator<64>{});
+      case ComparatorKind::kFixed128:
+        return f(FixedComparator<128>{});
+      case ComparatorKind::kFixed256:
+        return f(FixedComparator<256>{});
+      default:
+        return f(GenericComparator{this});
+    }
+  }
+
   // compare
   [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const {
+    return Dispatch([lhs, rhs](const auto &comparator) { return comparator.Compare(lhs, rhs); });
+  }
+
+  inline int GetKeySize() const { return key_size_; }
+
+  inline KeyEncoding GetKeyEncoding() const { return encoding_; }
+
+  /** @return whether every CHAR field of key fits the length of its column, a longer one has no room in a key */
+  [[nodiscard]] bool FitsKey(const Row &key) const;
+
+  /** Copy key to clamped with every CHAR field cut to the length of its column. */
+  void ClampKey(const Row &key, Row &clamped) const;
+
+  /** @return the number of bytes a key of key_schema takes in the kMemcomparable encoding */
+  static uint32_t GetMemcomparableSize(const Schema *key_schema);
+
+  KeyManager(const KeyManager &other) {
+    this->key_schema_ = other.key_schema_;
+    this->key_size_ = other.key_size_;
+    this->codec_ = other.codec_;
+    this->encoding_ = other.encoding_;
+    this->comparator_ = other.comparator_;
+  }
+
+  // constructor
+  KeyManager(Schema *key_schema, size_t key_size, KeyEncoding encoding = KeyEncoding::kRow)
+      : key_size_(key_size),
+        key_schema_(key_schema),
+        codec_(std::make_shared<RowCodec>(key_schema)),
+        encoding_(encoding),
+        comparator_(ChooseComparator()) {
+    ASSERT(encoding != KeyEncoding::kMemcomparable || GetMemcomparableSize(key_schema) <= key_size,
+           "Index key size exceed max key size.");
+  }
+
+ private:
+  enum class ComparatorKind { kGeneric, kInt, kFixed16, kFixed32, kFixed64, kFixed128, kFixed256 };
+
+  /** @return the fastest comparator for key_schema_, key_size_ and encoding_ */
+  ComparatorKind ChooseComparator() const;
+
+  // compare two kRow keys field by field
+  [[nodiscard]] int CompareRowKeys(const GenericKey *lhs, const GenericKey *rhs) const {
     //    ASSERT(malloc_usable_size((void *)&lhs) == malloc_usable_size((void *)&rhs), "key size not match.");
     uint32_t column_count = key_schema_->GetColumnCount();
     Row lhs_key(INVALID_ROWID);
@@ -56,19 +201,18 @@ class KeyManager {
     return 0;
   }
 
-  inline int GetKeySize() const { return key_size_; }
 
-  KeyManager(const KeyManager &other) {
-    this->key_schema_ = other.key_schema_;
-    this->key_size_ = other.key_size_;
-  }
+  /** Write key in the kMemcomparable encoding to buf, which is zeroed. */
+  void EncodeKey(char *buf, const Row &key) const;
 
-  // constructor
-  KeyManager(Schema *key_schema, size_t key_size) : key_size_(key_size), key_schema_(key_schema) {}
+  void DecodeKey(const char *buf, Row &key) const;
 
- private:
   int key_size_;
   Schema *key_schema_;
+  // shared by the copies of a key manager, e.g. the one of the tree of an index
+  std::shared_ptr<const RowCodec> codec_;
+  KeyEncoding encoding_;
+  ComparatorKind comparator_;
 };
 
 #endif  // MINISQL_GENERIC_KEY_H
@@ -1,6 +1,7 @@
 #ifndef MINISQL_INDEX_ITERATOR_H
 #define MINISQL_INDEX_ITERATOR_H
 
+#include "buffer/page_guard.h"
 #include "page/b_plus_tree_leaf_page.h"
 
 class IndexIterator {
@@ -10,9 +11,12 @@ class IndexIterator {
   // you may define your own constructor based on your member variables
   explicit IndexIterator();
 
-  explicit IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index = 0);
+  /** The iterator keeps the leaf page pinned through the guard until it moves past it. */
+  explicit IndexIterator(BasicPageGuard &&guard, int index = 0);
 
-  ~IndexIterator();
+  IndexIterator(IndexIterator &&) noexcept = default;
+
+  IndexIterator &operator=(IndexIterator &&) noexcept = default;
 
   /** Return the key/value pair this iterator is currently pointing at. */
   std::pair<GenericKey *, RowId> operator*();
@@ -27,7 +31,7 @@ class IndexIterator {
   bool operator!=(const IndexIterator &itr) const;
 
  private:
-  page_id_t current_page_id{INVALID_PAGE_ID};
+  BasicPageGuard guard_;
   LeafPage *page{nullptr};
   int item_index{0};
   BufferPoolManager *buffer_pool_manager{nullptr};
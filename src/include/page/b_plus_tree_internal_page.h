@@ -64,13 +64,17 @@ class BPlusTreeInternalPage : public BPlusTreePage {
                          BufferPoolManager *buffer_pool_manager);
 
  private:
+  /** The search behind Lookup, instantiated for each comparator of KeyManager::Dispatch. */
+  template <typename Comparator>
+  page_id_t LookupWith(const GenericKey *key, const Comparator &comparator);
+
   void CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool_manager);
 
   void CopyLastFrom(GenericKey *key, page_id_t value, BufferPoolManager *buffer_pool_manager);
 
   void CopyFirstFrom(page_id_t value, BufferPoolManager *buffer_pool_manager);
 
-  char data_[PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE];
+  char data_[PAGE_USABLE_SIZE - INTERNAL_PAGE_HEADER_SIZE];
 };
 
 using InternalPage = BPlusTreeInternalPage;
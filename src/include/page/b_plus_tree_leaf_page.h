@@ -74,6 +74,19 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
  private:
+  /**
+   * The searches behind KeyIndex, Insert, Lookup and RemoveAndDeleteRecord, instantiated for each comparator of
+   * KeyManager::Dispatch so that the key width is a constant where the comparator knows it.
+   */
+  template <typename Comparator>
+  int KeyIndexOf(const GenericKey *key, const Comparator &comparator);
+
+  template <typename Comparator>
+  int InsertWith(GenericKey *key, const RowId &value, const Comparator &comparator);
+
+  template <typename Comparator>
+  int FindKey(const GenericKey *key, const Comparator &comparator);
+
   void CopyNFrom(void *src, int size);
 
   void CopyLastFrom(GenericKey *key, const RowId value);
@@ -82,7 +95,7 @@ class BPlusTreeLeafPage : public BPlusTreePage {
 
   page_id_t next_page_id_{INVALID_PAGE_ID};
 
-  char data_[PAGE_SIZE - LEAF_PAGE_HEADER_SIZE];
+  char data_[PAGE_USABLE_SIZE - LEAF_PAGE_HEADER_SIZE];
 };
 
 using LeafPage = BPlusTreeLeafPage;
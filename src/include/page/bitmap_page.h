@@ -20,6 +20,13 @@ class BitmapPage {
    */
   bool AllocatePage(uint32_t &page_offset);
 
+  /**
+   * Allocate n adjacent pages, the first fit above the lowest free page is taken.
+   * @param page_offset Index in extent of the first page of the run.
+   * @return true if a run of n free pages was found.
+   */
+  bool AllocateRun(uint32_t n, uint32_t &page_offset);
+
   /**
    * @return true if successfully de-allocate a page.
    */
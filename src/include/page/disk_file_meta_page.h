@@ -2,13 +2,40 @@
 #define MINISQL_DISK_FILE_META_PAGE_H
 
 #include <cstdint>
+#include <limits>
 
 #include "page/bitmap_page.h"
 
-static constexpr page_id_t MAX_VALID_PAGE_ID = (PAGE_SIZE - 8) / 4 * BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
+// number of valid logical page ids, a whole number of extents below the page_id_t limit
+static constexpr page_id_t MAX_VALID_PAGE_ID =
+    std::numeric_limits<page_id_t>::max() / BitmapPage<PAGE_SIZE>::GetMaxSupportedSize() *
+    BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
 
+/**
+ * Version of the on-disk format, stored in the first meta page of a file. A file of another version is refused.
+ * 0: files written before the format was versioned
+ * 1: data pages end with a CRC32C checksum of their content
+ * 2: the table page header records the free space map of a table heap, free space map pages start with a magic
+ * 3: the table page header records the chain of free slots and the bytes of deleted tuples
+ */
+static constexpr uint32_t DISK_FILE_FORMAT_VERSION = 3;
+
+/**
+ * Meta page of one extent group: the number of extents of the group and the used pages of each of them. A file holds
+ * a chain of groups, the next group starts right after the last extent of a full one.
+ *
+ * The last word of the page holds the format version, in the meta page of the first group only.
+ */
 class DiskFileMetaPage {
  public:
+  /** @return the format version of the file, 0 if it was written before the format was versioned */
+  uint32_t GetFormatVersion() {
+    uint32_t word = *FormatVersionWord();
+    return (word & FORMAT_MAGIC_MASK) == FORMAT_MAGIC ? word & ~FORMAT_MAGIC_MASK : 0;
+  }
+
+  void SetFormatVersion(uint32_t version) { *FormatVersionWord() = FORMAT_MAGIC | version; }
+
   uint32_t GetExtentNums() { return num_extents_; }
 
   uint32_t GetAllocatedPages() { return num_allocated_pages_; }
@@ -21,9 +48,18 @@ class DiskFileMetaPage {
   }
 
  public:
-  uint32_t num_allocated_pages_{0}; // total number of allocated pages
+  uint32_t num_allocated_pages_{0}; // number of allocated pages in the extents of this group
   uint32_t num_extents_{0}; // each extent consists with a bit map and BIT_MAP_SIZE pages
   uint32_t extent_used_page_[0]; // number of used pages in each extent
+
+ private:
+  // in a file written before versions the word is the used page count of an extent or 0, which never has these bits
+  static constexpr uint32_t FORMAT_MAGIC = 0x4d530000;
+  static constexpr uint32_t FORMAT_MAGIC_MASK = 0xffff0000;
+
+  uint32_t *FormatVersionWord() {
+    return reinterpret_cast<uint32_t *>(reinterpret_cast<char *>(this) + PAGE_SIZE - sizeof(uint32_t));
+  }
 };
 
 #endif  // MINISQL_DISK_FILE_META_PAGE_H
@@ -0,0 +1,61 @@
+#ifndef MINISQL_FREE_SPACE_MAP_PAGE_H
+#define MINISQL_FREE_SPACE_MAP_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+/**
+ * A page of the free space map of a table heap. The pages of one map form a chain, each records the free space
+ * category of up to CAPACITY heap pages. A page id read from elsewhere is only trusted as a map page if it starts
+ * with MAGIC_NUM.
+ *
+ * Format (size in byte):
+ *  ----------------------------------------------------------------------------------------------------------------
+ * | Magic (4) | NextPageId (4) | Count (4) | HeapPageId_1 (4) | ... | HeapPageId_n (4) | Category_1 (1) | ... |
+ *  ----------------------------------------------------------------------------------------------------------------
+ */
+class FreeSpaceMapPage {
+ public:
+  static constexpr uint32_t MAGIC_NUM = 0x46534d50;
+  static constexpr uint32_t CAPACITY = (PAGE_USABLE_SIZE - 12) / (sizeof(page_id_t) + sizeof(uint8_t));
+
+  void Init() {
+    magic_num_ = MAGIC_NUM;
+    next_page_id_ = INVALID_PAGE_ID;
+    count_ = 0;
+  }
+
+  /** @return true if the page was initialized as a map page and its count is in range */
+  bool IsValid() const { return magic_num_ == MAGIC_NUM && count_ <= CAPACITY; }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  uint32_t GetCount() const { return count_; }
+
+  void SetCount(uint32_t count) { count_ = count; }
+
+  page_id_t GetHeapPageId(uint32_t slot) const { return heap_page_ids_[slot]; }
+
+  uint8_t GetCategory(uint32_t slot) const { return categories_[slot]; }
+
+  void SetCategory(uint32_t slot, uint8_t category) { categories_[slot] = category; }
+
+  void SetEntry(uint32_t slot, page_id_t heap_page_id, uint8_t category) {
+    heap_page_ids_[slot] = heap_page_id;
+    categories_[slot] = category;
+  }
+
+ private:
+  uint32_t magic_num_;
+  page_id_t next_page_id_;
+  uint32_t count_;
+  page_id_t heap_page_ids_[CAPACITY];
+  uint8_t categories_[CAPACITY];
+};
+
+static_assert(sizeof(FreeSpaceMapPage) <= PAGE_USABLE_SIZE);
+
+#endif  // MINISQL_FREE_SPACE_MAP_PAGE_H
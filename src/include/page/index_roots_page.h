@@ -30,7 +30,7 @@ class IndexRootsPage {
   int GetIndexCount() { return count_; }
 
  private:
-  static constexpr int MAX_INDEX_COUNT = (PAGE_SIZE - 4) / 8;
+  static constexpr int MAX_INDEX_COUNT = (PAGE_USABLE_SIZE - 4) / 8;
 
   int FindIndex(const index_id_t index_id);
 
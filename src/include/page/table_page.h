@@ -12,12 +12,24 @@
  *  ----------------------------------------------------------------------------
  *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
  *  ----------------------------------------------------------------------------
- *  ----------------------------------------------------------------
- *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
- *  ----------------------------------------------------------------
+ *  ------------------------------------------------------------------------------------------
+ *  | TupleCount (4) | FreeSpaceMapPageId (4) | FirstFreeSlot (4) | FragmentedBytes (4) | ... |
+ *  ------------------------------------------------------------------------------------------
+ *  ---------------------------------------------------
+ *  | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
+ *  ---------------------------------------------------
+ *
+ *  FreeSpaceMapPageId is only used in the first page of a table heap, it is the first page of its free space map.
+ *  The header layout is part of the disk file format, a file of an older DISK_FILE_FORMAT_VERSION is refused by the
+ *  DiskManager, and the map page is still checked by FreeSpaceMap::Load before it is trusted.
+ *
+ *  Slots freed by ApplyDelete (size 0) form a chain starting at FirstFreeSlot, linked through their offset field, so
+ *  an insert reuses one without scanning the slots. The bytes of a deleted tuple are left in place as a hole and
+ *  counted in FragmentedBytes; Compact() moves the tuples together once an insert or update needs that space.
  **/
 
 #include <cstring>
+#include <vector>
 
 #include "common/macros.h"
 #include "common/rowid.h"
@@ -25,6 +37,8 @@
 #include "concurrency/txn.h"
 #include "page/page.h"
 #include "record/row.h"
+#include "record/row_codec.h"
+#include "record/row_view.h"
 #include "recovery/log_manager.h"
 
 class TablePage : public Page {
@@ -37,6 +51,11 @@ class TablePage : public Page {
 
   page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
 
+  /** @return the next page id stored in the raw data of a table page, used to follow the chain without a Page */
+  static page_id_t ReadNextPageId(const char *page_data) {
+    return *reinterpret_cast<const page_id_t *>(page_data + OFFSET_NEXT_PAGE_ID);
+  }
+
   void SetPrevPageId(page_id_t prev_page_id) {
     memcpy(GetData() + OFFSET_PREV_PAGE_ID, &prev_page_id, sizeof(page_id_t));
   }
@@ -45,18 +64,57 @@ class TablePage : public Page {
     memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
   }
 
-  bool InsertTuple(Row &row, Schema *schema, Txn *txn, LockManager *lock_manager, LogManager *log_manager);
+  page_id_t GetFreeSpaceMapPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_FREE_SPACE_MAP); }
+
+  void SetFreeSpaceMapPageId(page_id_t page_id) {
+    memcpy(GetData() + OFFSET_FREE_SPACE_MAP, &page_id, sizeof(page_id_t));
+  }
+
+  /** @return the bytes available for new tuples and their slots, including holes left by deleted tuples */
+  uint32_t GetFreeSpaceRemaining() { return GetContiguousFreeSpace() + GetFragmentedBytes(); }
+
+  /**
+   * Move all tuples together at the end of the page, so the holes of deleted tuples become contiguous free space.
+   * Row ids do not change.
+   */
+  void Compact();
+
+  /** @return the free space a page needs to take a tuple of serialized_size bytes */
+  static uint32_t GetSpaceNeeded(uint32_t serialized_size) { return serialized_size + SIZE_TUPLE; }
+
+  /**
+   * The tuple methods take the schema of the rows, and optionally a codec of that schema that is used instead of the
+   * Row methods to serialize them, as a table heap does.
+   */
+  bool InsertTuple(Row &row, Schema *schema, Txn *txn, LockManager *lock_manager, LogManager *log_manager,
+                   const RowCodec *codec = nullptr);
 
   bool MarkDelete(const RowId &rid, Txn *txn, LockManager *lock_manager, LogManager *log_manager);
 
   int UpdateTuple(Row &new_row, Row *old_row, Schema *schema, Txn *txn, LockManager *lock_manager,
-                   LogManager *log_manager);
+                   LogManager *log_manager, const RowCodec *codec = nullptr);
 
   void ApplyDelete(const RowId &rid, Txn *txn, LogManager *log_manager);
 
   void RollbackDelete(const RowId &rid, Txn *txn, LogManager *log_manager);
 
-  bool GetTuple(Row *row, Schema *schema, Txn *txn, LockManager *lock_manager);
+  /**
+   * Apply the delete of every tuple that is marked deleted, so that their space can be reused.
+   * @return the number of tuples removed
+   */
+  uint32_t ApplyMarkedDeletes(Txn *txn, LogManager *log_manager);
+
+  bool GetTuple(Row *row, Schema *schema, Txn *txn, LockManager *lock_manager, const RowCodec *codec = nullptr);
+
+  /**
+   * Read all tuples that are not deleted into rows[0..count), in slot order. Rows already in rows are reused, rows is
+   * only grown when the page has more tuples than it holds.
+   * @param codec codec of schema, needed with a filter for the layout of the tuples
+   * @param filter if given, only the tuples it keeps are read, it sees each tuple in place through a RowView
+   * @return count, the number of tuples read
+   */
+  uint32_t GetTuples(std::pmr::vector<Row> &rows, Schema *schema, Txn *txn, LockManager *lock_manager,
+                     const RowCodec *codec = nullptr, const RowFilter &filter = nullptr);
 
   bool GetFirstTupleRid(RowId *first_rid);
 
@@ -73,7 +131,16 @@ class TablePage : public Page {
 
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
-  uint32_t GetFreeSpaceRemaining() {
+  uint32_t GetFirstFreeSlot() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FIRST_FREE_SLOT); }
+
+  void SetFirstFreeSlot(uint32_t slot_num) { memcpy(GetData() + OFFSET_FIRST_FREE_SLOT, &slot_num, sizeof(uint32_t)); }
+
+  uint32_t GetFragmentedBytes() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FRAGMENTED_BYTES); }
+
+  void SetFragmentedBytes(uint32_t bytes) { memcpy(GetData() + OFFSET_FRAGMENTED_BYTES, &bytes, sizeof(uint32_t)); }
+
+  /** @return the free bytes between the slot array and the tuples */
+  uint32_t GetContiguousFreeSpace() {
     return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
   }
 
@@ -102,17 +169,23 @@ class TablePage : public Page {
  private:
   static_assert(sizeof(page_id_t) == 4);
   static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
-  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
+  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 36;
   static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
   static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
   static constexpr size_t OFFSET_FREE_SPACE = 16;
   static constexpr size_t OFFSET_TUPLE_COUNT = 20;
-  static constexpr size_t OFFSET_TUPLE_OFFSET = 24;
-  static constexpr size_t OFFSET_TUPLE_SIZE = 28;
+  static constexpr size_t OFFSET_FREE_SPACE_MAP = 24;
+  static constexpr size_t OFFSET_FIRST_FREE_SLOT = 28;
+  static constexpr size_t OFFSET_FRAGMENTED_BYTES = 32;
+  static constexpr size_t OFFSET_TUPLE_OFFSET = 36;
+  static constexpr size_t OFFSET_TUPLE_SIZE = 40;
+  static constexpr uint32_t NO_FREE_SLOT = UINT32_MAX;
+  static_assert(OFFSET_TUPLE_OFFSET == SIZE_TABLE_PAGE_HEADER && SIZE_TABLE_PAGE_HEADER == 36,
+                "The table page header is part of the disk file format, bump DISK_FILE_FORMAT_VERSION to change it.");
 
  public:
-  static constexpr size_t SIZE_MAX_ROW = PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE;
+  static constexpr size_t SIZE_MAX_ROW = PAGE_USABLE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE;
   static constexpr int TUPLE_UPDATED = 0;
   static constexpr int SLOT_NUM_INVALID = 1;
   static constexpr int TUPLE_DELETED = 2;
@@ -18,6 +18,10 @@ class Field {
 
   friend class TypeFloat;
 
+  friend class RowCodec;
+
+  friend class KeyManager;
+
  public:
   explicit Field(const TypeId type) : type_id_(type), len_(FIELD_NULL_LEN), is_null_(true) {}
 
@@ -129,7 +133,7 @@ class Field {
     std::swap(first.manage_data_, second.manage_data_);
   }
 
-  std::string toString() {
+  std::string toString() const {
     if (is_null_)
       return "NULL";
     else if (type_id_ == kTypeInt)
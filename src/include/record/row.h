@@ -2,6 +2,7 @@
 #define MINISQL_ROW_H
 
 #include <memory>
+#include <memory_resource>
 #include <vector>
 
 #include "common/macros.h"
@@ -19,65 +20,97 @@
  * | Field Nums | Null bitmap |
  * -------------------------------------------
  *
+ *  In memory the fields of a row are stored by value in one vector, and the data of all its char fields is stored in
+ *  one buffer they point into. So building, copying or deserializing a row allocates at most these two, and a row
+ *  that is reused, e.g. in a TableBatch, keeps their capacity and does not allocate at all. Moving a row moves both.
  *
+ *  Both come from the memory resource of the row, the default heap unless one is given, e.g. the arena of a query.
+ *  Row is allocator aware, so a std::pmr::vector<Row> places its rows in its own resource. A copy made with the copy
+ *  constructor uses the default heap again.
  */
 class Row {
+  friend class RowCodec;
+
  public:
+  using allocator_type = std::pmr::polymorphic_allocator<char>;
+
   /**
    * Row used for insert
    * Field integrity should check by upper level
    */
-  Row(std::vector<Field> &fields) {
-    // deep copy
-    for (auto &field : fields) {
-      fields_.push_back(new Field(field));
-    }
+  Row(const std::vector<Field> &fields, const allocator_type &alloc = {}) : fields_(alloc), chars_(alloc) {
+    AssignFields(static_cast<uint32_t>(fields.size()), [&](uint32_t i) -> const Field & { return fields[i]; });
+  }
+
+  Row(const std::pmr::vector<Field> &fields, const allocator_type &alloc = {}) : fields_(alloc), chars_(alloc) {
+    AssignFields(static_cast<uint32_t>(fields.size()), [&](uint32_t i) -> const Field & { return fields[i]; });
   }
 
   void destroy() {
-    if (!fields_.empty()) {
-      for (auto field : fields_) {
-        delete field;
-      }
-      fields_.clear();
-    }
+    fields_.clear();
+    chars_.clear();
   }
 
-  ~Row() { destroy(); };
+  ~Row() = default;
 
   /**
    * Row used for deserialize
    */
   Row() = default;
 
+  explicit Row(const allocator_type &alloc) : fields_(alloc), chars_(alloc) {}
+
   /**
    * Row used for deserialize and update
    */
-  Row(RowId rid) : rid_(rid) {}
+  Row(RowId rid, const allocator_type &alloc = {}) : rid_(rid), fields_(alloc), chars_(alloc) {}
 
   /**
    * Row copy function, deep copy
    */
-  Row(const Row &other) {
-    destroy();
-    rid_ = other.rid_;
-    for (auto &field : other.fields_) {
-      fields_.push_back(new Field(*field));
-    }
+  Row(const Row &other, const allocator_type &alloc = {}) : rid_(other.rid_), fields_(alloc), chars_(alloc) {
+    AssignFields(other.GetFieldCount(), [&](uint32_t i) -> const Field & { return other.fields_[i]; });
+  }
+
+  /**
+   * Row move function, the char fields keep pointing into the moved buffer
+   */
+  Row(Row &&other) noexcept
+      : rid_(other.rid_), fields_(std::move(other.fields_)), chars_(std::move(other.chars_)) {}
+
+  /**
+   * Move into another memory resource, this copies unless the resources are the same
+   */
+  Row(Row &&other, const allocator_type &alloc) : rid_(other.rid_), fields_(alloc), chars_(alloc) {
+    *this = std::move(other);
   }
 
   /**
    * Assign operator, deep copy
    */
   Row &operator=(const Row &other) {
-    destroy();
-    rid_ = other.rid_;
-    for (auto &field : other.fields_) {
-      fields_.push_back(new Field(*field));
+    if (this != &other) {
+      rid_ = other.rid_;
+      AssignFields(other.GetFieldCount(), [&](uint32_t i) -> const Field & { return other.fields_[i]; });
     }
     return *this;
   }
 
+  /**
+   * The row keeps its memory resource, so the buffers of other are only taken if it has the same one
+   */
+  Row &operator=(Row &&other) noexcept {
+    if (this == &other) return *this;
+    if (get_allocator() != other.get_allocator()) return *this = other;
+    // the resources are the same, so the buffers can be exchanged
+    rid_ = other.rid_;
+    fields_.swap(other.fields_);
+    chars_.swap(other.chars_);
+    return *this;
+  }
+
+  allocator_type get_allocator() const { return chars_.get_allocator(); }
+
   /**
    * Note: Make sure that bytes write to buf is equal to GetSerializedSize()
    */
@@ -94,22 +127,76 @@ class Row {
 
   void GetKeyFromRow(const Schema *schema, const Schema *key_schema, Row &key_row);
 
+  /**
+   * Replace the fields of output_row by copies of the fields of this row at the table indexes of the columns of
+   * output_schema. output_row keeps its buffers, so a row reused for every tuple does not allocate.
+   */
+  void ProjectTo(const Schema *output_schema, Row &output_row) const;
+
+  /**
+   * Replace the fields of this row by copies of fields, keeping the buffers of the row
+   */
+  void SetFields(const std::vector<Field> &fields) {
+    AssignFields(static_cast<uint32_t>(fields.size()), [&](uint32_t i) -> const Field & { return fields[i]; });
+  }
+
   inline const RowId GetRowId() const { return rid_; }
 
   inline void SetRowId(RowId rid) { rid_ = rid; }
 
-  inline std::vector<Field *> &GetFields() { return fields_; }
+  inline std::pmr::vector<Field> &GetFields() { return fields_; }
+
+  inline Field *GetField(uint32_t idx) {
+    ASSERT(idx < fields_.size(), "Failed to access field");
+    return &fields_[idx];
+  }
 
-  inline Field *GetField(uint32_t idx) const {
+  inline const Field *GetField(uint32_t idx) const {
     ASSERT(idx < fields_.size(), "Failed to access field");
-    return fields_[idx];
+    return &fields_[idx];
   }
 
   inline size_t GetFieldCount() const { return fields_.size(); }
 
  private:
+  /**
+   * Replace the fields of this row by copies of get_field(0..count), the data of char fields is copied into chars_.
+   * get_field must not return fields of this row.
+   */
+  template <typename GetField>
+  void AssignFields(uint32_t count, GetField get_field) {
+    fields_.clear();
+    size_t chars_size = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      const Field &field = get_field(i);
+      if (field.GetTypeId() == TypeId::kTypeChar && !field.IsNull()) chars_size += field.GetLength();
+    }
+    // sized up front, so the buffer does not move while fields point into it
+    chars_.resize(chars_size);
+    fields_.reserve(count);
+    size_t offset = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      const Field &field = get_field(i);
+      if (field.GetTypeId() == TypeId::kTypeChar && !field.IsNull()) {
+        uint32_t len = field.GetLength();
+        memcpy(CharsAt(offset), field.GetData(), len);
+        fields_.emplace_back(TypeId::kTypeChar, CharsAt(offset), len, false);
+        offset += len;
+      } else {
+        fields_.emplace_back(field);
+      }
+    }
+  }
+
+  /** @return where char data at offset goes, never nullptr so that an empty char field is not taken as null */
+  char *CharsAt(size_t offset) { return offset < chars_.size() ? chars_.data() + offset : empty_chars_; }
+
+  static char empty_chars_[1];
+
   RowId rid_{};
-  std::vector<Field *> fields_; /** Make sure that all field ptr are destructed*/
+  std::pmr::vector<Field> fields_;
+  // data of the char fields, in field order
+  std::pmr::vector<char> chars_;
 };
 
 #endif  // MINISQL_ROW_H
@@ -0,0 +1,55 @@
+#ifndef MINISQL_ROW_CODEC_H
+#define MINISQL_ROW_CODEC_H
+
+#include <vector>
+
+#include "record/row.h"
+#include "record/row_view.h"
+#include "record/schema.h"
+
+/**
+ * Serializes rows of one schema in the format of Row::SerializeTo, built once per schema, e.g. by a table heap when
+ * the table is opened.
+ *
+ * Row::SerializeTo and friends look up the column types and go through the virtual Type singletons for every field.
+ * A codec resolves the encoder and decoder of every column to a function instantiated for its type when it is
+ * built, and keeps the header size and the fixed value sizes from its RowLayout, so a row is encoded and decoded in
+ * one pass without virtual calls.
+ */
+class RowCodec {
+ public:
+  explicit RowCodec(Schema *schema);
+
+  Schema *GetSchema() const { return layout_.GetSchema(); }
+
+  const RowLayout &GetLayout() const { return layout_; }
+
+  /** @return the number of bytes SerializeTo writes for row */
+  uint32_t GetSerializedSize(const Row &row) const;
+
+  /** Same bytes as row.SerializeTo(buf, schema). */
+  uint32_t SerializeTo(const Row &row, char *buf) const;
+
+  /** Same as row.DeserializeFrom(buf, schema), the row keeps the capacity of its buffers. */
+  uint32_t DeserializeFrom(const char *buf, Row &row) const;
+
+ private:
+  // write a non-null value, return its size
+  using EncodeFunc = uint32_t (*)(const Field &field, char *buf);
+  // append a non-null value to row, its char data goes to row.chars_ at chars_offset, return its size
+  using DecodeFunc = uint32_t (*)(const char *buf, Row &row, size_t &chars_offset);
+
+  template <TypeId type>
+  static uint32_t Encode(const Field &field, char *buf);
+
+  template <TypeId type>
+  static uint32_t Decode(const char *buf, Row &row, size_t &chars_offset);
+
+  RowLayout layout_;
+  std::vector<EncodeFunc> encoders_;
+  std::vector<DecodeFunc> decoders_;
+  // the rows of a schema without char columns need no pass to size the char buffer
+  bool has_chars_{false};
+};
+
+#endif  // MINISQL_ROW_CODEC_H
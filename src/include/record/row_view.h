@@ -0,0 +1,89 @@
+#ifndef MINISQL_ROW_VIEW_H
+#define MINISQL_ROW_VIEW_H
+
+#include <functional>
+#include <vector>
+
+#include "common/rowid.h"
+#include "record/field.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * Where the columns of a schema are found in a serialized row, computed once per schema.
+ *
+ * A null column takes no bytes and a char column is prefixed with its length, so in general the offset of a column
+ * depends on the row. The columns up to and including the first char column have fixed offsets in every row in which
+ * none of them before it is null, those are kept in a table.
+ */
+class RowLayout {
+ public:
+  explicit RowLayout(Schema *schema);
+
+  Schema *GetSchema() const { return schema_; }
+
+  uint32_t GetColumnCount() const { return static_cast<uint32_t>(types_.size()); }
+
+  /** @return the size of the row header, the field count and the null bitmap */
+  uint32_t GetHeaderSize() const { return header_size_; }
+
+  TypeId GetType(uint32_t column_index) const { return types_[column_index]; }
+
+  /** @return the serialized size of a non-null value of the column, 0 if it depends on the value */
+  uint32_t GetFixedSize(uint32_t column_index) const { return fixed_sizes_[column_index]; }
+
+  /** @return the number of columns whose offset is in the table */
+  uint32_t GetFixedPrefix() const { return static_cast<uint32_t>(prefix_offsets_.size()); }
+
+  /** @return the offset of column column_index < GetFixedPrefix() in a row where no column before it is null */
+  uint32_t GetPrefixOffset(uint32_t column_index) const { return prefix_offsets_[column_index]; }
+
+ private:
+  Schema *schema_;
+  uint32_t header_size_;
+  std::vector<TypeId> types_;
+  std::vector<uint32_t> fixed_sizes_;
+  std::vector<uint32_t> prefix_offsets_;
+};
+
+/**
+ * A read-only view of a serialized row, e.g. a tuple inside a pinned TablePage. Columns are decoded one at a time when
+ * asked for, so a filter that reads a few columns does not build the whole row. Char fields returned by GetField point
+ * into the viewed bytes and are only valid as long as they are.
+ */
+class RowView {
+ public:
+  RowView(const RowLayout *layout, const char *data, RowId rid) : layout_(layout), data_(data), rid_(rid) {}
+
+  inline RowId GetRowId() const { return rid_; }
+
+  bool IsNull(uint32_t column_index) const {
+    auto null_word = MACH_READ_UINT32(data_ + sizeof(uint32_t) * (1 + column_index / 32));
+    return (null_word & (1u << (column_index % 32))) != 0;
+  }
+
+  /** @return the value of a column, without copying char data */
+  Field GetField(uint32_t column_index) const;
+
+  /** Copy the viewed row into row, replacing its fields. */
+  void ToRow(Row *row) const;
+
+ private:
+  /** @return true if a column before column_index is null */
+  bool HasNullBefore(uint32_t column_index) const;
+
+  /** @return the offset of a non-null column in the viewed row */
+  uint32_t GetOffset(uint32_t column_index) const;
+
+  const RowLayout *layout_;
+  const char *data_;
+  RowId rid_;
+  // the offset of column walk_column_, kept from the last walk so reading columns left to right does not rescan
+  mutable uint32_t walk_column_{0};
+  mutable uint32_t walk_offset_{0};
+};
+
+/** Decides whether a row is kept, e.g. by a scan that only copies the rows passing its predicate. */
+using RowFilter = std::function<bool(const RowView &row)>;
+
+#endif  // MINISQL_ROW_VIEW_H
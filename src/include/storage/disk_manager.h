@@ -2,16 +2,26 @@
 #define DISK_MGR_H
 
 #include <atomic>
-#include <fstream>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "common/config.h"
 #include "common/macros.h"
 #include "page/bitmap_page.h"
 #include "page/disk_file_meta_page.h"
 
+/**
+ * What DiskManager does when the checksum of a page read from disk does not match its content.
+ */
+enum class PageChecksumPolicy {
+  kIgnore = 0,  // pages are still stamped on write, but not verified on read
+  kLog,         // the mismatch is logged and counted, the page is returned as read
+  kFatal        // the process is aborted
+};
+
 /**
  * DiskManager takes care of the allocation and de allocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
@@ -19,10 +29,36 @@
  * Disk page storage format: (Free Page BitMap Size = PAGE_SIZE * 8, we note it as N)
  * | Meta Page | Free Page BitMap 1 | Page 1 | Page 2 | ....
  *      | Page N | Free Page BitMap 2 | Page N+1 | ... | Page 2N | ... |
+ *
+ * A meta page records at most MAX_EXTENT_NUMS extents. Once they all exist, the file continues with the next extent
+ * group, which starts with its own meta page, so the meta pages form a chain and the database is only bounded by
+ * MAX_VALID_PAGE_ID. A file with a single group has the same layout as before. File offsets are 64 bit.
+ *
+ * With direct_io the file is opened with O_DIRECT, so pages are cached by the buffer pool only and not a second time
+ * in the kernel page cache. Buffers that are not PAGE_SIZE aligned are copied through an aligned bounce buffer.
+ * If the file system does not support O_DIRECT, buffered I/O is used instead.
+ *
+ * Every data page written by WritePage is stamped with a CRC32C of its first PAGE_USABLE_SIZE bytes in its last
+ * PAGE_CHECKSUM_SIZE bytes, and ReadPage verifies it, so a torn or otherwise corrupted page is detected when it is read
+ * back. A page that was never written reads as all zeros and is accepted. The meta page and the bitmap pages are not
+ * stamped, they use the whole page.
+ *
+ * The first meta page records DISK_FILE_FORMAT_VERSION when the file is created. A file written in another format,
+ * e.g. without page checksums, is refused when it is opened instead of being misread.
+ *
+ * Bitmap pages are cached in memory once touched and only written back by Checkpoint() or Close(), together with the
+ * meta page. Page allocation starts its search at a free extent hint instead of scanning all extents.
  */
 class DiskManager {
  public:
-  explicit DiskManager(const std::string &db_file);
+  /**
+   * @param extents_per_meta extents recorded by one meta page, smaller values only serve tests; a file must always
+   * be opened with the value it was created with
+   * @throws std::runtime_error if the file was written in another format version
+   */
+  explicit DiskManager(const std::string &db_file, bool direct_io = false,
+                       PageChecksumPolicy checksum_policy = PageChecksumPolicy::kLog,
+                       uint32_t extents_per_meta = MAX_EXTENT_NUMS);
 
   ~DiskManager() {
     if (!closed) {
@@ -33,21 +69,48 @@ class DiskManager {
   /**
    * Read page from specific page_id
    * Note: page_id = 0 is reserved for free page bit map
+   * Note: data pages are read with pread and without db_io_latch_, so concurrent readers do not serialize
    */
   void ReadPage(page_id_t logical_page_id, char *page_data);
 
   /**
    * Write data to specific page
    * Note: page_id = 0 is reserved for free page bit map
+   * Note: the page is written with its checksum in the last PAGE_CHECKSUM_SIZE bytes, page_data is not modified
    */
   void WritePage(page_id_t logical_page_id, const char *page_data);
 
+  /**
+   * Stamp the checksum of a data page into its last PAGE_CHECKSUM_SIZE bytes. Done by WritePage, asynchronous I/O
+   * backends that bypass it must call this on the buffer they write.
+   */
+  static void StampChecksum(char *page_data);
+
+  /**
+   * Verify the checksum of a data page read from disk and apply the checksum policy on a mismatch. Done by ReadPage,
+   * asynchronous I/O backends that bypass it must call this after reading the page.
+   * @return false if the checksum does not match
+   */
+  bool VerifyChecksum(page_id_t logical_page_id, const char *page_data);
+
+  /** @return the number of data pages read whose checksum did not match */
+  size_t GetChecksumFailureCount() const { return checksum_failures_.load(); }
+
+  void SetChecksumPolicy(PageChecksumPolicy checksum_policy) { checksum_policy_ = checksum_policy; }
+
   /**
    * Get next free page from disk
    * @return logical page id of allocated page
    */
   page_id_t AllocatePage();
 
+  /**
+   * Allocate n logical pages that are adjacent on disk, i.e. inside one extent, and reserve the space of the run in
+   * the file with fallocate, so that pages allocated one by one to a table or an index end up contiguous.
+   * @return logical page id of the first page of the run, INVALID_PAGE_ID if there is no such run
+   */
+  page_id_t AllocatePageRun(uint32_t n);
+
   /**
    * Free this page and reset bit map
    */
@@ -58,48 +121,141 @@ class DiskManager {
    */
   bool IsPageFree(page_id_t logical_page_id);
 
+  /**
+   * Write the meta page and the modified bitmap pages back to disk
+   */
+  void Checkpoint();
+
+  /**
+   * Truncate the file right after its last allocated page and drop the extents at its end that have no allocated
+   * page, so that space freed at the end of the file is given back to the file system. The meta page only stops
+   * listing the dropped extents once the truncation has succeeded.
+   * The buffer pool must not hold dirty frames of freed pages, i.e. they were freed through DeletePage.
+   * @return the number of bytes the file shrank by
+   */
+  size_t ShrinkFile();
+
   /**
    * Shut down the disk manager and close all the file resources.
    */
   void Close();
 
   /**
-   * Get Meta Page
+   * Get the meta page of the first extent group
    * Note: Used only for debug
    */
-  char *GetMetaData() { return meta_data_; }
+  char *GetMetaData() { return meta_pages_[0].get(); }
+
+  /** @return the number of allocated pages over all extent groups */
+  uint32_t GetAllocatedPages();
+
+  /** @return the number of extents over all extent groups */
+  uint32_t GetExtentNums();
+
+  /**
+   * For asynchronous I/O backends that bypass ReadPage/WritePage: the file descriptor and byte offset of a page
+   */
+  int GetFileDescriptor() const { return db_fd_; }
+
+  /**
+   * @return true if the file is accessed with O_DIRECT, buffers passed to the file descriptor must be aligned then
+   */
+  bool IsDirectIO() const { return direct_io_; }
+
+  size_t GetPageOffset(page_id_t logical_page_id) {
+    return MapPageId(logical_page_id) * PAGE_SIZE;
+  }
+
+  /**
+   * Record that the file now extends to at least end bytes, must be called after a write that bypassed WritePage
+   */
+  void ExtendFileSize(size_t end);
 
   static constexpr size_t BITMAP_SIZE = BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
 
+  // extents recorded by one meta page, its last word holds the format version
+  static constexpr uint32_t MAX_EXTENT_NUMS = (PAGE_SIZE - 12) / 4;
+
  private:
   /**
-   * Helper function to get disk file size
+   * Helper function to get disk file size, only used when opening the file since the size is cached afterwards
    */
-  int GetFileSize(const std::string &file_name);
+  size_t GetFileSize() const;
 
   /**
    * Read physical page from disk
    */
-  void ReadPhysicalPage(page_id_t physical_page_id, char *page_data);
+  void ReadPhysicalPage(size_t physical_page_id, char *page_data);
 
   /**
    * Write data to physical page in disk
    */
-  void WritePhysicalPage(page_id_t physical_page_id, const char *page_data);
+  void WritePhysicalPage(size_t physical_page_id, const char *page_data);
 
   /**
    * Map logical page id to physical page id
    */
-  page_id_t MapPageId(page_id_t logical_page_id);
+  size_t MapPageId(page_id_t logical_page_id);
+
+  /**
+   * Get the meta page of the group holding an extent, the meta page of a new group is created zeroed.
+   * Caller must hold db_io_latch_.
+   */
+  DiskFileMetaPage *GetMeta(uint32_t extent_id);
+
+  /**
+   * Create the next extent. Caller must hold db_io_latch_.
+   * @return its extent id
+   */
+  uint32_t AddExtent();
+
+  /**
+   * Account for delta pages allocated (or freed if negative) in an extent. Caller must hold db_io_latch_.
+   */
+  void UpdateExtentUsedPage(uint32_t extent_id, int32_t delta);
+
+  /**
+   * Get the cached bitmap of an extent, reading it from disk on first use. Caller must hold db_io_latch_.
+   */
+  BitmapPage<PAGE_SIZE> *GetBitmap(uint32_t extent_id);
+
+  /**
+   * Physical page id of the meta page of an extent group
+   */
+  size_t MetaPageId(uint32_t group) const {
+    return static_cast<size_t>(group) * (1 + static_cast<size_t>(extents_per_meta_) * (BITMAP_SIZE + 1));
+  }
+
+  /**
+   * Physical page id of the bitmap page of an extent
+   */
+  size_t BitmapPageId(uint32_t extent_id) const {
+    return MetaPageId(extent_id / extents_per_meta_) + 1 + (extent_id % extents_per_meta_) * (BITMAP_SIZE + 1);
+  }
 
  private:
-  // stream to write db file
-  std::fstream db_io_;
+  // file descriptor of db file, accessed with pread/pwrite which do not share a file cursor
+  int db_fd_{-1};
   std::string file_name_;
-  // with multiple buffer pool instances, need to protect file access
+  bool direct_io_{false};
+  std::atomic<PageChecksumPolicy> checksum_policy_{PageChecksumPolicy::kLog};
+  std::atomic<size_t> checksum_failures_{0};
+  // cached file length, only grows except in ShrinkFile, reads beyond it return a zeroed page without a syscall
+  std::atomic<size_t> file_size_{0};
+  // protects the meta page and the bitmap pages, data page I/O does not take it
   std::recursive_mutex db_io_latch_;
   bool closed{false};
-  char meta_data_[PAGE_SIZE];
+  uint32_t extents_per_meta_;
+  // meta pages of the extent groups, the last one may have free extent slots, all others are full
+  std::vector<std::unique_ptr<char[]>> meta_pages_;
+  // totals over all groups
+  uint32_t num_allocated_pages_{0};
+  uint32_t num_extents_{0};
+  // cached bitmap pages indexed by extent id, nullptr until first used
+  std::vector<std::unique_ptr<BitmapPage<PAGE_SIZE>>> bitmaps_;
+  std::vector<bool> bitmap_dirty_;
+  // no extent below this one has a free page
+  uint32_t free_extent_hint_{0};
 };
 
 #endif
\ No newline at end of file
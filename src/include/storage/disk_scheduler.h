@@ -0,0 +1,116 @@
+#ifndef MINISQL_DISK_SCHEDULER_H
+#define MINISQL_DISK_SCHEDULER_H
+
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(MINISQL_HAVE_LIBURING) && __has_include(<liburing.h>)
+#include <liburing.h>
+#define MINISQL_USE_IO_URING
+#endif
+
+#include "common/config.h"
+#include "storage/disk_manager.h"
+
+/**
+ * A page read or write handed to the DiskScheduler. The promise is fulfilled with true once the I/O has completed.
+ */
+struct DiskRequest {
+  bool is_write_{false};
+  page_id_t page_id_{INVALID_PAGE_ID};
+  // source of a write or destination of a read, must stay valid until the request completes
+  char *data_{nullptr};
+  // private copy of the data of a write, so the caller may reuse its buffer right away
+  std::unique_ptr<char, decltype(&free)> buffer_{nullptr, &free};
+  std::promise<bool> callback_;
+};
+
+/**
+ * DiskScheduler performs page I/O of a DiskManager asynchronously.
+ *
+ * Requests are spread over num_workers queues by page id, and every queue is served by one worker, so requests for
+ * the same page always complete in the order they were scheduled: a read scheduled after a write of the same page
+ * sees the written data. Requests for different pages have no ordering guarantee.
+ *
+ * When the project is built with liburing (MINISQL_HAVE_LIBURING), a worker drains its queue into one io_uring
+ * submission of up to IO_URING_QUEUE_DEPTH requests. Otherwise it calls DiskManager::ReadPage/WritePage, which use
+ * pread/pwrite and do not serialize on the disk manager latch, so the workers form a plain I/O thread pool.
+ *
+ * Worker threads are started by the first request.
+ */
+class DiskScheduler {
+ public:
+  explicit DiskScheduler(DiskManager *disk_manager, size_t num_workers = DEFAULT_DISK_SCHEDULER_WORKERS);
+
+  /**
+   * Completes all scheduled requests, then stops the workers.
+   */
+  ~DiskScheduler();
+
+  /**
+   * Queue a request.
+   * @return future fulfilled when the request has completed
+   */
+  std::future<bool> Schedule(DiskRequest request);
+
+  /** Read page_id into data, data must stay valid until the returned future is ready. */
+  std::future<bool> ScheduleRead(page_id_t page_id, char *data);
+
+  /** Write data to page_id, data must stay valid until the returned future is ready. */
+  std::future<bool> ScheduleWrite(page_id_t page_id, const char *data);
+
+  /** Write a copy of data to page_id, data may be modified as soon as this returns. */
+  std::future<bool> ScheduleWriteCopy(page_id_t page_id, const char *data);
+
+  /**
+   * Synchronous read and write. They run in the calling thread, saving the hand-off to a worker, unless a request
+   * for the same page is still queued or in flight; they are then scheduled behind it and waited for.
+   */
+  void ReadPage(page_id_t page_id, char *data);
+
+  void WritePage(page_id_t page_id, const char *data);
+
+  /** @return true if requests are submitted through io_uring */
+  static bool UsesIoUring();
+
+  static constexpr size_t IO_URING_QUEUE_DEPTH = 32;
+
+ private:
+  struct Worker {
+    std::thread thread_;
+    std::mutex latch_;
+    std::condition_variable cv_;
+    std::deque<DiskRequest> queue_;
+    std::unordered_map<page_id_t, size_t> pending_;  // queued or in flight requests per page
+    bool stopping_{false};
+#ifdef MINISQL_USE_IO_URING
+    struct io_uring ring_;
+    bool ring_ready_{false};
+#endif
+  };
+
+  void StartWorkers();
+
+  Worker &WorkerOf(page_id_t page_id) { return *workers_[static_cast<size_t>(page_id) % workers_.size()]; }
+
+  /** @return true if a request for page_id is queued or in flight */
+  bool IsPending(page_id_t page_id);
+
+  void WorkerLoop(Worker &worker);
+
+  /** Perform a batch of requests taken from the worker's queue, fulfilling their promises. */
+  void Process(Worker &worker, std::vector<DiskRequest> &batch);
+
+  DiskManager *disk_manager_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::once_flag started_;
+};
+
+#endif  // MINISQL_DISK_SCHEDULER_H
@@ -0,0 +1,104 @@
+#ifndef MINISQL_FREE_SPACE_MAP_H
+#define MINISQL_FREE_SPACE_MAP_H
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "page/free_space_map_page.h"
+
+/**
+ * FreeSpaceMap tracks how much free space each page of a table heap has, so that an insert finds a page with room
+ * without walking the page chain.
+ *
+ * Free space is recorded coarsely as a category, the number of whole CATEGORY_SIZE byte units that are free. A page
+ * of category c has at least c * CATEGORY_SIZE free bytes. The pages of each category are kept in a bucket in memory
+ * and a bit mask records the non-empty buckets, so FindPage is O(1). The categories are persisted in a chain of
+ * FreeSpaceMapPage; a page of the chain is only written when the category of one of its heap pages changes.
+ *
+ * The map is a hint: a page may have more room than its category says, and after a crash it may have less. Callers
+ * report the actual free space of every page they modify through Update.
+ */
+class FreeSpaceMap {
+ public:
+  static constexpr uint32_t NUM_CATEGORIES = 64;
+  static constexpr uint32_t CATEGORY_SIZE = PAGE_SIZE / NUM_CATEGORIES;
+
+  explicit FreeSpaceMap(BufferPoolManager *buffer_pool_manager) : buffer_pool_manager_(buffer_pool_manager) {}
+
+  /**
+   * Create an empty map.
+   * @return the id of its first page, INVALID_PAGE_ID if it could not be created
+   */
+  page_id_t Create();
+
+  /**
+   * Read the map starting at first_page_id into memory.
+   * @return false if a page of the chain could not be fetched or is not a map page, the map must be created anew
+   */
+  bool Load(page_id_t first_page_id);
+
+  /**
+   * @return the id of a heap page with at least size free bytes, INVALID_PAGE_ID if there is none
+   */
+  page_id_t FindPage(uint32_t size);
+
+  /**
+   * Record the free space of a heap page, adding the page to the map if it is not tracked yet.
+   */
+  void Update(page_id_t heap_page_id, uint32_t free_space);
+
+  /**
+   * Stop tracking a heap page, e.g. because it was removed from the heap.
+   */
+  void Remove(page_id_t heap_page_id);
+
+  /**
+   * Free all pages of the map starting at first_page_id, whether it is loaded or not. Stops at the first page that
+   * is not a map page.
+   */
+  void Destroy(page_id_t first_page_id);
+
+  /** @return the number of heap pages tracked */
+  size_t GetPageCount();
+
+ private:
+  struct Entry {
+    page_id_t heap_page_id_;
+    uint8_t category_;
+    uint32_t bucket_pos_;  // position in buckets_[category_]
+  };
+
+  static uint8_t CategoryOf(uint32_t free_space) {
+    uint32_t category = free_space / CATEGORY_SIZE;
+    return static_cast<uint8_t>(category < NUM_CATEGORIES ? category : NUM_CATEGORIES - 1);
+  }
+
+  /** Put entry index into the bucket of its category. Caller must hold latch_. */
+  void AddToBucket(uint32_t index);
+
+  /** Take entry index out of the bucket of its category. Caller must hold latch_. */
+  void RemoveFromBucket(uint32_t index);
+
+  /** @return false if page_id cannot be a map page, checked before fetching a page id read from another page */
+  bool MayBeMapPage(page_id_t page_id) {
+    return page_id >= 0 && page_id < MAX_VALID_PAGE_ID && !buffer_pool_manager_->IsPageFree(page_id);
+  }
+
+  /** Write entry index to its map page, the entry becomes part of the page if add. Caller must hold latch_. */
+  void WriteEntry(uint32_t index, bool add);
+
+ private:
+  BufferPoolManager *buffer_pool_manager_;
+  std::mutex latch_;
+  // pages of the map in chain order, entry i is stored in slot i % CAPACITY of page i / CAPACITY
+  std::vector<page_id_t> map_pages_;
+  std::vector<Entry> entries_;
+  std::unordered_map<page_id_t, uint32_t> entry_of_;
+  // entry indexes by category
+  std::vector<uint32_t> buckets_[NUM_CATEGORIES];
+  uint64_t non_empty_buckets_{0};
+};
+
+#endif  // MINISQL_FREE_SPACE_MAP_H
@@ -1,17 +1,34 @@
 #ifndef MINISQL_TABLE_HEAP_H
 #define MINISQL_TABLE_HEAP_H
 
+#include <functional>
+#include <mutex>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
 #include "page/header_page.h"
 #include "page/table_page.h"
 #include "recovery/log_manager.h"
+#include "storage/free_space_map.h"
 #include "storage/table_iterator.h"
 
 class TableHeap {
-  friend class TableIterator;
-
  public:
+  /**
+   * Position of an incremental vacuum between two VacuumStep calls, a default constructed cursor starts a new one.
+   */
+  struct VacuumCursor {
+    bool started_{false};
+    page_id_t reclaim_page_id_{INVALID_PAGE_ID};  // next page whose deleted tuples are reclaimed
+    page_id_t front_page_id_{INVALID_PAGE_ID};    // first page that may have room for tuples moved from the tail
+    page_id_t tail_page_id_{INVALID_PAGE_ID};     // last page of the heap, emptied by the next step
+    uint32_t freed_pages_{0};                     // pages removed from the heap so far
+  };
+
+  /** Called for a tuple moved by VacuumStep with its old row id, row carries the tuple and its new row id. */
+  using MoveCallback = std::function<void(const RowId &old_rid, Row &row)>;
+
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, Schema *schema, Txn *txn, LogManager *log_manager,
                            LockManager *lock_manager) {
     return new TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager);
@@ -22,16 +39,26 @@ class TableHeap {
     return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
   }
 
-  ~TableHeap() {}
+  ~TableHeap() { buffer_pool_manager_->ReleasePageRun(page_run_); }
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * A page with room is found through the free space map of the heap, a new page is only appended if none has room.
    * @param[in/out] row Tuple Row to insert, the rid of the inserted tuple is wrapped in object row
    * @param[in] txn The recovery performing the insert
    * @return true iff the insert is successful
    */
   bool InsertTuple(Row &row, Txn *txn);
 
+  /**
+   * Insert many tuples. The page being filled stays pinned and write latched until it is full, so rows do not pay a
+   * fetch and unpin each, and the free space map is only updated once per page.
+   * @param[in/out] rows Tuples to insert in order, the rid of each inserted tuple is wrapped in its row
+   * @param[in] txn The recovery performing the insert
+   * @return the number of rows inserted, all rows from the first one that could not be inserted on are left out
+   */
+  size_t InsertTuples(std::vector<Row> &rows, Txn *txn);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param[in] rid Resource id of the tuple of delete
@@ -71,23 +98,37 @@ class TableHeap {
    */
   bool GetTuple(Row *row, Txn *txn);
 
-  void FreeTableHeap() {
-    auto next_page_id = first_page_id_;
-    while (next_page_id != INVALID_PAGE_ID) {
-      auto old_page_id = next_page_id;
-      auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(old_page_id));
-      assert(page != nullptr);
-      next_page_id = page->GetNextPageId();
-      buffer_pool_manager_->UnpinPage(old_page_id, false);
-      buffer_pool_manager_->DeletePage(old_page_id);
-    }
-  }
+  void FreeTableHeap() { DeleteTable(first_page_id_); }
 
   /**
    * Free table heap and release storage in disk file
    */
   void DeleteTable(page_id_t page_id = INVALID_PAGE_ID);
 
+  /**
+   * One bounded step of a vacuum. The first steps reclaim the space of tuples marked deleted, one page per step. Each
+   * following step moves the live tuples of the last page into free space of earlier pages, then unlinks and frees
+   * the emptied page, so the heap shrinks from its end. Moved tuples get new row ids and are reported to on_move.
+   * Latches are only held within a step, so other statements can run between steps; a step itself must not run
+   * concurrently with other writers of this heap. A cursor whose tail got a next page in between starts over.
+   * @return true while there is more work, false once the heap cannot shrink further
+   */
+  bool VacuumStep(VacuumCursor &cursor, const MoveCallback &on_move, Txn *txn);
+
+  /**
+   * Read the next page of the heap that has tuples into batch. The page is pinned and latched once for all of its
+   * tuples, instead of once per tuple as GetTuple does. Pages are read in chain order from the first one.
+   * @param filter if given, only the tuples it keeps are read into batch, pages without any are skipped
+   * @return false once there are no more pages, batch is empty then
+   */
+  bool NextBatch(TableBatch &batch, Txn *txn, const RowFilter &filter = nullptr);
+
+  /** @return where the columns of the tuples of this heap are found, for RowView */
+  const RowLayout *GetRowLayout() const { return &row_codec_.GetLayout(); }
+
+  /** @return the codec the tuples of this heap are serialized with */
+  const RowCodec *GetRowCodec() const { return &row_codec_; }
+
   /**
    * @return the begin iterator of this table
    */
@@ -104,6 +145,26 @@ class TableHeap {
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
  private:
+  /**
+   * Insert a tuple into the page latched by guard, or else move guard to a page with room and insert it there. A page
+   * is appended to the heap if no page has room. guard may be empty initially.
+   * @return false if no page could be fetched or created
+   */
+  bool InsertIntoPage(Row &row, uint32_t size, WritePageGuard &guard, Txn *txn);
+
+  /**
+   * Load the free space map on first use, it is rebuilt from the page chain if the heap has none.
+   * Latches heap pages, so the caller must not hold a page latch of the heap.
+   */
+  void LoadFreeSpaceMap();
+
+  /**
+   * Ask the buffer pool to read the heap chain ahead, starting at page_id.
+   */
+  void ReadAhead(page_id_t page_id) {
+    buffer_pool_manager_->PrefetchPages(page_id, DEFAULT_PREFETCH_PAGES, TablePage::ReadNextPageId);
+  }
+
   /**
    * create table heap and initialize first page
    */
@@ -111,12 +172,18 @@ class TableHeap {
                      LockManager *lock_manager)
       : buffer_pool_manager_(buffer_pool_manager),
         schema_(schema),
+        row_codec_(schema),
         log_manager_(log_manager),
-        lock_manager_(lock_manager) {
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager->NewPage(first_page_id_));
+        lock_manager_(lock_manager),
+        free_space_map_(buffer_pool_manager) {
+    BasicPageGuard guard = buffer_pool_manager->NewPageGuarded(first_page_id_, &page_run_);
+    auto page = reinterpret_cast<TablePage *>(guard.GetPage());
     page->Init(first_page_id_, INVALID_PAGE_ID, log_manager, txn);
     page->SetNextPageId(INVALID_PAGE_ID);
-    buffer_pool_manager->UnpinPage(first_page_id_, true);
+    page->SetFreeSpaceMapPageId(free_space_map_.Create());
+    free_space_map_.Update(first_page_id_, page->GetFreeSpaceRemaining());
+    std::call_once(free_space_map_loaded_, []() {});
+    guard.MarkDirty();
     last_visited_page_id_ = first_page_id_;
   };
 
@@ -126,16 +193,25 @@ class TableHeap {
         first_page_id_(first_page_id),
         last_visited_page_id_(first_page_id),
         schema_(schema),
+        row_codec_(schema),
         log_manager_(log_manager),
-        lock_manager_(lock_manager) {}
+        lock_manager_(lock_manager),
+        free_space_map_(buffer_pool_manager) {}
 
  private:
   BufferPoolManager *buffer_pool_manager_;
   page_id_t first_page_id_;
+  // the last page of the chain, or a page before it, where appending a page starts looking for the tail
   page_id_t last_visited_page_id_ = INVALID_PAGE_ID;
+  // pages reserved for the growth of this heap, so that its chain is laid out sequentially on disk
+  PageRun page_run_;
   Schema *schema_;
+  // built once for the schema, every tuple is serialized through it
+  RowCodec row_codec_;
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
+  FreeSpaceMap free_space_map_;
+  std::once_flag free_space_map_loaded_;
 };
 
 #endif  // MINISQL_TABLE_HEAP_H
@@ -1,19 +1,43 @@
 #ifndef MINISQL_TABLE_ITERATOR_H
 #define MINISQL_TABLE_ITERATOR_H
 
+#include <memory_resource>
+#include <vector>
+
 #include "common/rowid.h"
 #include "concurrency/txn.h"
 #include "record/row.h"
 
 class TableHeap;
 
+/**
+ * The tuples of one table page, read by TableHeap::NextBatch while the page is pinned once. The rows are reused from
+ * page to page, so a scan does not allocate a row per tuple. A default constructed batch starts at the first page.
+ * The rows are placed in the memory resource the batch is constructed with.
+ */
+struct TableBatch {
+    TableBatch() = default;
+
+    explicit TableBatch(std::pmr::memory_resource *resource) : rows_(resource) {}
+
+    std::pmr::vector<Row> rows_;  // only rows_[0..size_) belong to the current page
+    size_t size_{0};
+    bool started_{false};
+    page_id_t next_page_id_{INVALID_PAGE_ID};  // page read by the next call, once started
+};
+
+/**
+ * Iterates the tuples of a table heap a page at a time through TableBatch, so moving to the next tuple of the same
+ * page does not touch the buffer pool. Copying an iterator copies the rows of its page.
+ */
 class TableIterator {
 public:
     // you may define your own constructor based on your member variables
     explicit TableIterator();
 
-    explicit TableIterator(Row *row, TableHeap *table_heap);
-
+    /**
+     * Iterator at the first tuple at or after rid, the end iterator if rid is INVALID_ROWID or there is no such tuple
+     */
     explicit TableIterator(TableHeap *table_heap, RowId rid, Txn *txn);
 
     explicit TableIterator(const TableIterator &other);
@@ -35,9 +59,14 @@ public:
     TableIterator operator++(int);
 
 private:
+    /** @return row id of the current tuple, INVALID_ROWID at the end */
+    RowId GetRowId() const { return pos_ < batch_.size_ ? batch_.rows_[pos_].GetRowId() : INVALID_ROWID; }
+
     // add your own private member variables here
-    Row *row_;
-    TableHeap *table_heap_;
+    TableHeap *table_heap_{nullptr};
+    Txn *txn_{nullptr};
+    TableBatch batch_;
+    size_t pos_{0};
 };
 
 #endif  // MINISQL_TABLE_ITERATOR_H
@@ -18,24 +18,31 @@ BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size) {
     root_page_id_ = INVALID_PAGE_ID;
-    auto *index_roots_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
-    if (!index_roots_page->GetRootId(index_id_, &root_page_id_)) {
-        root_page_id_ = INVALID_PAGE_ID;
-        UpdateRootPageId(1);
+    {
+        BasicPageGuard roots_guard = buffer_pool_manager_->FetchPageBasic(INDEX_ROOTS_PAGE_ID);
+        auto *index_roots_page = const_cast<IndexRootsPage *>(roots_guard.As<IndexRootsPage>());
+        if (!index_roots_page->GetRootId(index_id_, &root_page_id_)) root_page_id_ = INVALID_PAGE_ID;
     }
-    buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+    if (root_page_id_ == INVALID_PAGE_ID) UpdateRootPageId(1);
     if (leaf_max_size_ == 0) {
-        leaf_max_size_ = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (processor_.GetKeySize() + sizeof(RowId)) - 1;
+        leaf_max_size_ = (PAGE_USABLE_SIZE - LEAF_PAGE_HEADER_SIZE) / (processor_.GetKeySize() + sizeof(RowId)) - 1;
     }
     if (internal_max_size_ == 0) {
-        internal_max_size_ = (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (processor_.GetKeySize() + sizeof(page_id_t)) - 1;
+        internal_max_size_ = (PAGE_USABLE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (processor_.GetKeySize() + sizeof(page_id_t)) - 1;
     }
 }
 
+BPlusTree::~BPlusTree() {
+    buffer_pool_manager_->ReleasePageRun(page_run_);
+}
+
 void BPlusTree::Destroy(page_id_t current_page_id) {
+    buffer_pool_manager_->ReleasePageRun(page_run_);
     if (current_page_id == INVALID_PAGE_ID) current_page_id = root_page_id_;
     if (current_page_id == INVALID_PAGE_ID) return;
-    auto *page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(current_page_id)->GetData());
+    BasicPageGuard guard = buffer_pool_manager_->FetchPageBasic(current_page_id);
+    if (!guard) return;
+    auto *page = const_cast<BPlusTreePage *>(guard.As<BPlusTreePage>());
     if (page->IsRootPage()) {
         root_page_id_ = INVALID_PAGE_ID;
         UpdateRootPageId(0);
@@ -46,7 +53,7 @@ void BPlusTree::Destroy(page_id_t current_page_id) {
             Destroy(internal_page->ValueAt(i));
         }
     }
-    buffer_pool_manager_->UnpinPage(current_page_id, false);
+    guard.Drop();
     buffer_pool_manager_->DeletePage(current_page_id);
 }
 
@@ -67,12 +74,12 @@ bool BPlusTree::IsEmpty() const {
  */
 bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Txn *transaction) {
     if (IsEmpty()) return false;
-    auto *leaf_page = reinterpret_cast<LeafPage *>(FindLeafPage(key, INVALID_PAGE_ID, false));
-    if (IsEmpty() || leaf_page == nullptr) return false;
+    BasicPageGuard leaf_guard = FindLeafPage(key, INVALID_PAGE_ID, false);
+    if (!leaf_guard) return false;
+    auto *leaf_page = const_cast<LeafPage *>(leaf_guard.As<LeafPage>());
     RowId rid;
     bool ret = leaf_page->Lookup(key, rid, processor_);
     if (ret) result.push_back(rid);
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
     return ret;
 }
 
@@ -97,13 +104,12 @@ bool BPlusTree::Insert(GenericKey *key, const RowId &value, Txn *transaction) {
  * tree's root page id and insert entry directly into leaf page.
  */
 void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
-    Page *page = buffer_pool_manager_->NewPage(root_page_id_);
-    if (page == nullptr) throw "out of memory";
-    auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
-    leaf_page->Init(page->GetPageId(), INVALID_PAGE_ID, processor_.GetKeySize(), leaf_max_size_);
+    BasicPageGuard guard = buffer_pool_manager_->NewPageGuarded(root_page_id_, &page_run_);
+    if (!guard) throw "out of memory";
+    auto *leaf_page = guard.AsMut<LeafPage>();
+    leaf_page->Init(guard.PageId(), INVALID_PAGE_ID, processor_.GetKeySize(), leaf_max_size_);
     leaf_page->Insert(key, value, processor_);
     UpdateRootPageId(0);
-    buffer_pool_manager_->UnpinPage(root_page_id_, true);
 }
 
 /*
@@ -115,27 +121,24 @@ void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
  * keys return false, otherwise return true.
  */
 bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Txn *transaction) {
-    auto *leaf_page = reinterpret_cast<LeafPage *>(FindLeafPage(key, INVALID_PAGE_ID, false));
-    if (leaf_page == nullptr) return false;
+    BasicPageGuard leaf_guard = FindLeafPage(key, INVALID_PAGE_ID, false);
+    if (!leaf_guard) return false;
+    auto *leaf_page = const_cast<LeafPage *>(leaf_guard.As<LeafPage>());
     RowId rid;
-    if (leaf_page->Lookup(key, rid, processor_)) {
-        buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
-        return false;
-    }
+    if (leaf_page->Lookup(key, rid, processor_)) return false;
+    leaf_guard.MarkDirty();
     if (leaf_page->GetSize() < leaf_page->GetMaxSize()) {
         leaf_page->Insert(key, value, processor_);
-        buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
         return true;
     }
-    auto *new_leaf_page = Split(leaf_page, transaction);
+    BasicPageGuard new_leaf_guard = Split(leaf_page, transaction);
+    auto *new_leaf_page = new_leaf_guard.AsMut<LeafPage>();
     if (processor_.CompareKeys(key, leaf_page->KeyAt(leaf_page->GetSize() - 1)) > 0) {
         new_leaf_page->Insert(key, value, processor_);
     } else {
         leaf_page->Insert(key, value, processor_);
     }
     InsertIntoParent(leaf_page, new_leaf_page->KeyAt(0), new_leaf_page, transaction);
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(new_leaf_page->GetPageId(), true);
     return true;
 }
 
@@ -145,27 +148,28 @@ bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Txn *transac
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * @return: guard holding the newly created page
  */
-BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Txn *transaction) {
+BasicPageGuard BPlusTree::Split(InternalPage *node, Txn *transaction) {
     page_id_t new_page_id;
-    Page *page = buffer_pool_manager_->NewPage(new_page_id);
-    if (page == nullptr) throw "out of memory";
-    auto *new_internal_page = reinterpret_cast<InternalPage *>(page->GetData());
-    new_internal_page->Init(page->GetPageId(), node->GetParentPageId(), processor_.GetKeySize(), internal_max_size_);
+    BasicPageGuard guard = buffer_pool_manager_->NewPageGuarded(new_page_id, &page_run_);
+    if (!guard) throw "out of memory";
+    auto *new_internal_page = guard.AsMut<InternalPage>();
+    new_internal_page->Init(new_page_id, node->GetParentPageId(), processor_.GetKeySize(), internal_max_size_);
     node->MoveHalfTo(new_internal_page, buffer_pool_manager_);
-    return new_internal_page;
+    return guard;
 }
 
-BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Txn *transaction) {
+BasicPageGuard BPlusTree::Split(LeafPage *node, Txn *transaction) {
     page_id_t new_page_id;
-    Page *page = buffer_pool_manager_->NewPage(new_page_id);
-    if (page == nullptr) throw "out of memory";
-    auto *new_leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
-    new_leaf_page->Init(page->GetPageId(), node->GetParentPageId(), processor_.GetKeySize(), leaf_max_size_);
+    BasicPageGuard guard = buffer_pool_manager_->NewPageGuarded(new_page_id, &page_run_);
+    if (!guard) throw "out of memory";
+    auto *new_leaf_page = guard.AsMut<LeafPage>();
+    new_leaf_page->Init(new_page_id, node->GetParentPageId(), processor_.GetKeySize(), leaf_max_size_);
     node->MoveHalfTo(new_leaf_page);
     new_leaf_page->SetNextPageId(node->GetNextPageId());
     node->SetNextPageId(new_leaf_page->GetPageId());
-    return new_leaf_page;
+    return guard;
 }
 
 /*
@@ -180,24 +184,24 @@ BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Txn *transaction) {
 void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node, Txn *transaction) {
     if (old_node->IsRootPage()) {
         // create a new root
-        Page *page = buffer_pool_manager_->NewPage(root_page_id_);
-        if (page == nullptr) throw "out of memory";
-        auto *new_root_page = reinterpret_cast<InternalPage *>(page->GetData());
-        new_root_page->Init(page->GetPageId(), INVALID_PAGE_ID, processor_.GetKeySize(), internal_max_size_);
+        BasicPageGuard root_guard = buffer_pool_manager_->NewPageGuarded(root_page_id_, &page_run_);
+        if (!root_guard) throw "out of memory";
+        auto *new_root_page = root_guard.AsMut<InternalPage>();
+        new_root_page->Init(root_page_id_, INVALID_PAGE_ID, processor_.GetKeySize(), internal_max_size_);
         new_root_page->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
         old_node->SetParentPageId(root_page_id_);
         new_node->SetParentPageId(root_page_id_);
         UpdateRootPageId(0);
-        buffer_pool_manager_->UnpinPage(root_page_id_, true);
         return;
     }
-    auto *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(old_node->GetParentPageId())->GetData());
+    BasicPageGuard parent_guard = buffer_pool_manager_->FetchPageBasic(old_node->GetParentPageId());
+    auto *parent = parent_guard.AsMut<InternalPage>();
     if (parent->GetSize() < parent->GetMaxSize()) {
         parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
-        buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
         return;
     }
-    auto *new_parent = Split(parent, transaction);
+    BasicPageGuard new_parent_guard = Split(parent, transaction);
+    auto *new_parent = new_parent_guard.AsMut<InternalPage>();
     if (processor_.CompareKeys(key, parent->KeyAt(parent->GetSize() - 1)) > 0) {
         new_parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
         new_node->SetParentPageId(new_parent->GetPageId());
@@ -205,8 +209,6 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
         parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
     }
     InsertIntoParent(parent, new_parent->KeyAt(0), new_parent, transaction);
-    buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(new_parent->GetPageId(), true);
 }
 
 /*****************************************************************************
@@ -221,18 +223,15 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
  */
 void BPlusTree::Remove(const GenericKey *key, Txn *transaction) {
     if (IsEmpty()) return;
-    auto *leaf_page = reinterpret_cast<LeafPage *>(FindLeafPage(key, INVALID_PAGE_ID, false));
-    if (leaf_page == nullptr) return;
+    BasicPageGuard leaf_guard = FindLeafPage(key, INVALID_PAGE_ID, false);
+    if (!leaf_guard) return;
+    auto *leaf_page = leaf_guard.AsMut<LeafPage>();
     leaf_page->RemoveAndDeleteRecord(key, processor_);
-    if (leaf_page->GetSize() >= leaf_page->GetMinSize()) {
-        buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
-        return;
-    }
-    if (CoalesceOrRedistribute(leaf_page, transaction)) {
-        buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
-        buffer_pool_manager_->DeletePage(leaf_page->GetPageId());
-    } else {
-        buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
+    if (leaf_page->GetSize() >= leaf_page->GetMinSize()) return;
+    if (CoalesceOrRedistribute<LeafPage>(leaf_guard, transaction)) {
+        page_id_t page_id = leaf_guard.PageId();
+        leaf_guard.Drop();
+        buffer_pool_manager_->DeletePage(page_id);
     }
 }
 
@@ -240,31 +239,34 @@ void BPlusTree::Remove(const GenericKey *key, Txn *transaction) {
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
+ * @param   node_guard    guard of the underflowing page, holds the page to delete when true is returned
  * @return: true means target leaf page should be deleted, false means no
  * deletion happens
  */
 template <typename N>
-bool BPlusTree::CoalesceOrRedistribute(N *&node, Txn *transaction) {
+bool BPlusTree::CoalesceOrRedistribute(BasicPageGuard &node_guard, Txn *transaction) {
+    auto *node = node_guard.AsMut<N>();
     if (node->IsRootPage()) return AdjustRoot(node);
-    auto *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData());
+    BasicPageGuard parent_guard = buffer_pool_manager_->FetchPageBasic(node->GetParentPageId());
+    auto *parent = parent_guard.AsMut<InternalPage>();
     int index = parent->ValueIndex(node->GetPageId());
     page_id_t sibling_pid = index == 0 ? parent->ValueAt(1) : parent->ValueAt(index - 1);
-    auto *sibling = reinterpret_cast<N *>(buffer_pool_manager_->FetchPage(sibling_pid)->GetData());
+    BasicPageGuard sibling_guard = buffer_pool_manager_->FetchPageBasic(sibling_pid);
+    auto *sibling = sibling_guard.AsMut<N>();
     if (sibling->GetSize() + node->GetSize() > node->GetMaxSize()) {
-        Redistribute(sibling, node, index);
-        buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
-        buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+        Redistribute(sibling, node, parent, index);
         return false;
     }
-    if (Coalesce(sibling, node, parent, index, transaction)) {
-        // parent size < min size
-        bool ret = parent->IsRootPage() ? AdjustRoot(parent) : CoalesceOrRedistribute(parent, transaction);
-        buffer_pool_manager_->UnpinPage(parent->GetPageId(), !ret);
-        if (ret) buffer_pool_manager_->DeletePage(parent->GetPageId());
-    } else {
-        buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+    N *old_node = node;
+    bool parent_underflow = Coalesce(sibling, node, parent, index, transaction);
+    // Coalesce may swap the pages, the caller must end up holding the emptied one
+    if (node != old_node) std::swap(node_guard, sibling_guard);
+    if (parent_underflow && CoalesceOrRedistribute<InternalPage>(parent_guard, transaction)) {
+        page_id_t parent_page_id = parent_guard.PageId();
+        parent_guard.Drop();
+        buffer_pool_manager_->DeletePage(parent_page_id);
     }
-    return buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true), true;
+    return true;
 }
 
 /*
@@ -309,9 +311,9 @@ bool BPlusTree::Coalesce(InternalPage *&neighbor_node, InternalPage *&node, Inte
  * Using template N to represent either internal page or leaf page.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
+ * @param   parent             parent page of input "node", pinned by the caller
  */
-void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, int index) {
-    auto *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData());
+void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index) {
     if (index == 0) {
         neighbor_node->MoveFirstToEndOf(node);
         parent->SetKeyAt(1, neighbor_node->KeyAt(0));
@@ -319,11 +321,9 @@ void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, int index)
         neighbor_node->MoveLastToFrontOf(node);
         parent->SetKeyAt(index, node->KeyAt(0));
     }
-    buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
 }
 
-void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, int index) {
-    auto *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData());
+void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index) {
     if (index == 0) {
         neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1), buffer_pool_manager_);
         parent->SetKeyAt(1, neighbor_node->KeyAt(0));
@@ -331,7 +331,6 @@ void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, in
         neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), buffer_pool_manager_);
         parent->SetKeyAt(index, node->KeyAt(0));
     }
-    buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
 }
 /*
  * Update root page if necessary
@@ -356,11 +355,10 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
     if (root_node->GetSize() == 1) {
         // Deleted the last element in root page, but still has one last child
         page_id_t new_root_pid = root_node->RemoveAndReturnOnlyChild();
-        auto *new_root_node = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(new_root_pid)->GetData());
-        new_root_node->SetParentPageId(INVALID_PAGE_ID);
+        BasicPageGuard new_root_guard = buffer_pool_manager_->FetchPageBasic(new_root_pid);
+        new_root_guard.AsMut<BPlusTreePage>()->SetParentPageId(INVALID_PAGE_ID);
         root_page_id_ = new_root_pid;
         UpdateRootPageId(0);
-        buffer_pool_manager_->UnpinPage(new_root_pid, true);
         return true;
     }
     return false;
@@ -375,10 +373,9 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
  * @return : index iterator
  */
 IndexIterator BPlusTree::Begin() {
-    auto *page = FindLeafPage(nullptr, INVALID_PAGE_ID, true);
-    if (page == nullptr) return End();
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-    return IndexIterator(page->GetPageId(), buffer_pool_manager_, 0);
+    BasicPageGuard leaf_guard = FindLeafPage(nullptr, INVALID_PAGE_ID, true);
+    if (!leaf_guard) return End();
+    return IndexIterator(std::move(leaf_guard), 0);
 }
 
 /*
@@ -387,11 +384,10 @@ IndexIterator BPlusTree::Begin() {
  * @return : index iterator
  */
 IndexIterator BPlusTree::Begin(const GenericKey *key) {
-    auto *page = FindLeafPage(key, INVALID_PAGE_ID, false);
-    if (page == nullptr) return End();
-    int index = reinterpret_cast<LeafPage *>(page)->KeyIndex(key, processor_);
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-    return IndexIterator(page->GetPageId(), buffer_pool_manager_, index);
+    BasicPageGuard leaf_guard = FindLeafPage(key, INVALID_PAGE_ID, false);
+    if (!leaf_guard) return End();
+    int index = const_cast<LeafPage *>(leaf_guard.As<LeafPage>())->KeyIndex(key, processor_);
+    return IndexIterator(std::move(leaf_guard), index);
 }
 
 /*
@@ -400,7 +396,7 @@ IndexIterator BPlusTree::Begin(const GenericKey *key) {
  * @return : index iterator
  */
 IndexIterator BPlusTree::End() {
-    return IndexIterator(INVALID_PAGE_ID, buffer_pool_manager_, 0);
+    return IndexIterator();
 }
 
 /*****************************************************************************
@@ -411,21 +407,19 @@ IndexIterator BPlusTree::End() {
  * the left most leaf page
  * Find the leaf page that contains the input key from input page_id
  * if page_id == INVALID_PAGE_ID, start from root page
- * Note: the leaf page is pinned, you need to unpin it after use.
+ * @return : guard holding the pinned leaf page, empty if the tree is empty
  */
-Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool leftMost) {
+BasicPageGuard BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool leftMost) {
     if (page_id == INVALID_PAGE_ID) page_id = root_page_id_;
-    if (page_id == INVALID_PAGE_ID) return nullptr;
-    auto *page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
-    while (!page->IsLeafPage()) {
-        auto *internal_page = reinterpret_cast<InternalPage *>(page);
+    if (page_id == INVALID_PAGE_ID) return BasicPageGuard();
+    BasicPageGuard guard = buffer_pool_manager_->FetchPageBasic(page_id);
+    while (guard && !guard.As<BPlusTreePage>()->IsLeafPage()) {
+        auto *internal_page = const_cast<InternalPage *>(guard.As<InternalPage>());
         if (leftMost) page_id = internal_page->ValueAt(0);
         else page_id = internal_page->Lookup(key, processor_);
-        buffer_pool_manager_->UnpinPage(internal_page->GetPageId(), false);
-        page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+        guard = buffer_pool_manager_->FetchPageBasic(page_id);
     }
-    // buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-    return reinterpret_cast<Page *>(page);
+    return guard;
 }
 
 /*
@@ -437,14 +431,15 @@ Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool lef
  * updating it.
  */
 void BPlusTree::UpdateRootPageId(int insert_record) {
-    IndexRootsPage *index_roots_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+    BasicPageGuard roots_guard = buffer_pool_manager_->FetchPageBasic(INDEX_ROOTS_PAGE_ID);
+    auto *index_roots_page = roots_guard.AsMut<IndexRootsPage>();
     if (insert_record) index_roots_page->Insert(index_id_, root_page_id_);
     else index_roots_page->Update(index_id_, root_page_id_);
-    buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
 }
 
 /**
  * This method is used for debug only, You don't need to modify
+ * NOTE: page is pinned by the caller
  */
 void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out, Schema *schema) const {
     std::string leaf_prefix("LEAF_");
@@ -519,19 +514,19 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
         }
         // Print leaves
         for (int i = 0; i < inner->GetSize(); i++) {
-            auto child_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(inner->ValueAt(i))->GetData());
+            BasicPageGuard child_guard = bpm->FetchPageBasic(inner->ValueAt(i));
+            auto child_page = const_cast<BPlusTreePage *>(child_guard.As<BPlusTreePage>());
             ToGraph(child_page, bpm, out, schema);
             if (i > 0) {
-                auto sibling_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(inner->ValueAt(i - 1))->GetData());
+                BasicPageGuard sibling_guard = bpm->FetchPageBasic(inner->ValueAt(i - 1));
+                auto sibling_page = sibling_guard.As<BPlusTreePage>();
                 if (!sibling_page->IsLeafPage() && !child_page->IsLeafPage()) {
                     out << "{rank=same " << internal_prefix << sibling_page->GetPageId() << " " << internal_prefix
                             << child_page->GetPageId() << "};\n";
                 }
-                bpm->UnpinPage(sibling_page->GetPageId(), false);
             }
         }
     }
-    bpm->UnpinPage(page->GetPageId(), false);
 }
 
 /**
@@ -556,8 +551,8 @@ void BPlusTree::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const {
         std::cout << std::endl;
         std::cout << std::endl;
         for (int i = 0; i < internal->GetSize(); i++) {
-            ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(internal->ValueAt(i))->GetData()), bpm);
-            bpm->UnpinPage(internal->ValueAt(i), false);
+            BasicPageGuard child_guard = bpm->FetchPageBasic(internal->ValueAt(i));
+            ToString(const_cast<BPlusTreePage *>(child_guard.As<BPlusTreePage>()), bpm);
         }
     }
 }
@@ -3,13 +3,16 @@
 #include "index/generic_key.h"
 #include "utils/tree_file_mgr.h"
 BPlusTreeIndex::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
-                               BufferPoolManager *buffer_pool_manager)
+                               BufferPoolManager *buffer_pool_manager, KeyEncoding key_encoding)
     : Index(index_id, key_schema),
-      processor_(key_schema_, key_size),
+      processor_(key_schema_, key_size, key_encoding),
       container_(index_id, buffer_pool_manager, processor_) {}
 
 dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Txn *txn) {
   // ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
+  if (!processor_.FitsKey(key)) {
+    return DB_FAILED;
+  }
   GenericKey *index_key = processor_.InitKey();
   processor_.SerializeFromKey(index_key, key, key_schema_);
 
@@ -27,6 +30,10 @@ dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Txn *txn) {
 }
 
 dberr_t BPlusTreeIndex::RemoveEntry(const Row &key, RowId row_id, Txn *txn) {
+  // a key longer than its columns was never inserted
+  if (!processor_.FitsKey(key)) {
+    return DB_KEY_NOT_FOUND;
+  }
   GenericKey *index_key = processor_.InitKey();
   processor_.SerializeFromKey(index_key, key, key_schema_);
 
@@ -36,8 +43,25 @@ dberr_t BPlusTreeIndex::RemoveEntry(const Row &key, RowId row_id, Txn *txn) {
 }
 
 dberr_t BPlusTreeIndex::ScanKey(const Row &key, vector<RowId> &result, Txn *txn, string compare_operator) {
+  // A probe with a CHAR longer than its column equals no key. Every key that has the cut probe as prefix is shorter
+  // than the probe, so a key is greater than the probe iff it is greater than the cut probe.
+  Row clamped;
+  const Row *probe = &key;
+  bool cut = !processor_.FitsKey(key);
+  if (cut) {
+    if (compare_operator == "=") {
+      return DB_KEY_NOT_FOUND;
+    }
+    processor_.ClampKey(key, clamped);
+    probe = &clamped;
+    if (compare_operator == ">=") {
+      compare_operator = ">";
+    } else if (compare_operator == "<") {
+      compare_operator = "<=";
+    }
+  }
   GenericKey *index_key = processor_.InitKey();
-  processor_.SerializeFromKey(index_key, key, key_schema_);
+  processor_.SerializeFromKey(index_key, *probe, key_schema_);
   auto end_iter = GetEndIterator();
   if (compare_operator == "=") {
     container_.GetValue(index_key, result, txn);
@@ -68,7 +92,7 @@ dberr_t BPlusTreeIndex::ScanKey(const Row &key, vector<RowId> &result, Txn *txn,
       result.emplace_back((*iter).second);
     }
     vector<RowId> temp;
-    if (container_.GetValue(index_key, temp, txn))
+    if (!cut && container_.GetValue(index_key, temp, txn))
       result.erase(find(result.begin(), result.end(), temp[0]));
   }
   free(index_key);
@@ -0,0 +1,151 @@
+#include "index/generic_key.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t SIGN_BIT = 0x80000000u;
+
+void WriteBigEndian(char *buf, uint32_t value) {
+  for (int i = 3; i >= 0; i--) {
+    buf[i] = static_cast<char>(value & 0xff);
+    value >>= 8;
+  }
+}
+
+uint32_t ReadBigEndian(const char *buf) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; i++) {
+    value = (value << 8) | static_cast<unsigned char>(buf[i]);
+  }
+  return value;
+}
+
+/** @return the bytes column takes in the kMemcomparable encoding, including its null flag */
+uint32_t GetColumnSize(const Column *column) {
+  if (column->GetType() == TypeId::kTypeChar) {
+    return 1 + column->GetLength() + sizeof(uint32_t);
+  }
+  return 1 + sizeof(uint32_t);
+}
+
+}  // namespace
+
+KeyManager::ComparatorKind KeyManager::ChooseComparator() const {
+  if (encoding_ != KeyEncoding::kMemcomparable) {
+    return ComparatorKind::kGeneric;
+  }
+  bool single_int = key_schema_->GetColumnCount() == 1 && key_schema_->GetColumn(0)->GetType() == TypeId::kTypeInt;
+  if (single_int && key_size_ == 16) {
+    return ComparatorKind::kInt;
+  }
+  switch (key_size_) {
+    case 16:
+      return ComparatorKind::kFixed16;
+    case 32:
+      return ComparatorKind::kFixed32;
+    case 64:
+      return ComparatorKind::kFixed64;
+    case 128:
+      return ComparatorKind::kFixed128;
+    case 256:
+      return ComparatorKind::kFixed256;
+    default:
+      return ComparatorKind::kGeneric;
+  }
+}
+
+uint32_t KeyManager::GetMemcomparableSize(const Schema *key_schema) {
+  uint32_t size = 0;
+  for (auto column : key_schema->GetColumns()) {
+    size += GetColumnSize(column);
+  }
+  return size;
+}
+
+bool KeyManager::FitsKey(const Row &key) const {
+  const auto &columns = key_schema_->GetColumns();
+  for (uint32_t i = 0; i < columns.size(); i++) {
+    const Field &field = *key.GetField(i);
+    if (columns[i]->GetType() == TypeId::kTypeChar && !field.IsNull() && field.len_ > columns[i]->GetLength()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void KeyManager::ClampKey(const Row &key, Row &clamped) const {
+  const auto &columns = key_schema_->GetColumns();
+  std::vector<Field> fields;
+  fields.reserve(columns.size());
+  for (uint32_t i = 0; i < columns.size(); i++) {
+    const Field &field = *key.GetField(i);
+    if (columns[i]->GetType() == TypeId::kTypeChar && !field.IsNull() && field.len_ > columns[i]->GetLength()) {
+      fields.emplace_back(TypeId::kTypeChar, field.value_.chars_, columns[i]->GetLength(), false);
+    } else {
+      fields.emplace_back(field);
+    }
+  }
+  // the row copies the char data out of key
+  clamped.SetFields(fields);
+}
+
+void KeyManager::EncodeKey(char *buf, const Row &key) const {
+  const auto &columns = key_schema_->GetColumns();
+  for (uint32_t i = 0; i < columns.size(); i++) {
+    const Field &field = *key.GetField(i);
+    if (!field.IsNull()) {
+      buf[0] = 1;
+      switch (columns[i]->GetType()) {
+        case TypeId::kTypeInt:
+          WriteBigEndian(buf + 1, static_cast<uint32_t>(field.value_.integer_) ^ SIGN_BIT);
+          break;
+        case TypeId::kTypeFloat: {
+          uint32_t bits = 0;
+          float value = field.value_.float_;
+          if (value != 0) {
+            memcpy(&bits, &value, sizeof(bits));
+          }
+          WriteBigEndian(buf + 1, (bits & SIGN_BIT) ? ~bits : bits | SIGN_BIT);
+          break;
+        }
+        default: {
+          // callers reject a longer value with FitsKey, never write past the slot of the column
+          uint32_t len = std::min(field.len_, columns[i]->GetLength());
+          memcpy(buf + 1, field.value_.chars_, len);
+          WriteBigEndian(buf + 1 + columns[i]->GetLength(), len);
+        }
+      }
+    }
+    buf += GetColumnSize(columns[i]);
+  }
+}
+
+void KeyManager::DecodeKey(const char *buf, Row &key) const {
+  const auto &columns = key_schema_->GetColumns();
+  std::vector<Field> fields;
+  fields.reserve(columns.size());
+  for (auto column : columns) {
+    TypeId type = column->GetType();
+    if (buf[0] == 0) {
+      fields.emplace_back(type);
+    } else if (type == TypeId::kTypeInt) {
+      fields.emplace_back(type, static_cast<int32_t>(ReadBigEndian(buf + 1) ^ SIGN_BIT));
+    } else if (type == TypeId::kTypeFloat) {
+      uint32_t bits = ReadBigEndian(buf + 1);
+      bits = (bits & SIGN_BIT) ? bits & ~SIGN_BIT : ~bits;
+      float value;
+      memcpy(&value, &bits, sizeof(value));
+      fields.emplace_back(type, value);
+    } else {
+      uint32_t len = ReadBigEndian(buf + 1 + column->GetLength());
+      fields.emplace_back(type, const_cast<char *>(buf + 1), len, false);
+    }
+    buf += GetColumnSize(column);
+  }
+  // the row copies the char data out of buf
+  RowId rid = key.GetRowId();
+  key = Row(fields);
+  key.SetRowId(rid);
+}
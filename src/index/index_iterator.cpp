@@ -1,19 +1,14 @@
 #include "index/index_iterator.h"
 
+#include "buffer/buffer_pool_manager.h"
 #include "index/basic_comparator.h"
 #include "index/generic_key.h"
 
 IndexIterator::IndexIterator() = default;
 
-IndexIterator::IndexIterator(page_id_t page_id, BufferPoolManager* bpm, int index)
-	: current_page_id(page_id), item_index(index), buffer_pool_manager(bpm) {
-	if (current_page_id != INVALID_PAGE_ID) {
-		page = reinterpret_cast<LeafPage*>(buffer_pool_manager->FetchPage(current_page_id)->GetData());
-	}
-}
-
-IndexIterator::~IndexIterator() {
-	if (current_page_id != INVALID_PAGE_ID) buffer_pool_manager->UnpinPage(current_page_id, false);
+IndexIterator::IndexIterator(BasicPageGuard&& guard, int index)
+	: guard_(std::move(guard)), item_index(index), buffer_pool_manager(guard_.GetBufferPoolManager()) {
+	if (guard_) page = const_cast<LeafPage*>(guard_.As<LeafPage>());
 }
 
 std::pair<GenericKey*, RowId> IndexIterator::operator*() {
@@ -26,25 +21,18 @@ IndexIterator& IndexIterator::operator++() {
 	}
 	else {
 		page_id_t next_page_id = page->GetNextPageId();
-		buffer_pool_manager->UnpinPage(current_page_id, false);
-		current_page_id = next_page_id;
-		if (current_page_id != INVALID_PAGE_ID) {
-			page = reinterpret_cast<LeafPage*>(buffer_pool_manager->FetchPage(current_page_id)->GetData());
-			item_index = 0;
-		}
-		else {
-			page = nullptr;
-			item_index = 0;
-			current_page_id = INVALID_PAGE_ID;
-		}
+		// the guard releases the current leaf as soon as it is reassigned
+		guard_ = next_page_id == INVALID_PAGE_ID ? BasicPageGuard() : buffer_pool_manager->FetchPageBasic(next_page_id);
+		page = guard_ ? const_cast<LeafPage*>(guard_.As<LeafPage>()) : nullptr;
+		item_index = 0;
 	}
 	return *this;
 }
 
 bool IndexIterator::operator==(const IndexIterator& itr) const {
-	return current_page_id == itr.current_page_id && item_index == itr.item_index;
+	return guard_.PageId() == itr.guard_.PageId() && item_index == itr.item_index;
 }
 
 bool IndexIterator::operator!=(const IndexIterator& itr) const {
 	return !(*this == itr);
-}
\ No newline at end of file
+}
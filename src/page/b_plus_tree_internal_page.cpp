@@ -71,10 +71,18 @@ void InternalPage::PairCopy(void *dest, void *src, int pair_num) {
  * 用了二分查找
  */
 page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM) {
+    return KM.Dispatch([&](const auto &comparator) { return LookupWith(key, comparator); });
+}
+
+template <typename Comparator>
+page_id_t InternalPage::LookupWith(const GenericKey *key, const Comparator &comparator) {
+    // the stride is a constant for a fixed width comparator
+    const size_t stride = comparator.Size() + sizeof(page_id_t);
     int l = 1, r = GetSize() - 1;
     while (l <= r) {
         int mid = (l + r) / 2;
-        if (KM.CompareKeys(KeyAt(mid), key) <= 0) l = mid + 1;
+        auto mid_key = reinterpret_cast<const GenericKey *>(pairs_off + mid * stride);
+        if (comparator.Compare(mid_key, key) <= 0) l = mid + 1;
         else r = mid - 1;
     }
     return ValueAt(r);
@@ -135,9 +143,8 @@ void InternalPage::CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool
     for (int i = 0; i < size; ++i) {
         page_id_t child_page_id = ValueAt(GetSize() - size + i);
         if (child_page_id != INVALID_PAGE_ID) {
-            auto *child_page = reinterpret_cast<InternalPage *>(buffer_pool_manager->FetchPage(child_page_id)->GetData());
-            child_page->SetParentPageId(GetPageId());
-            buffer_pool_manager->UnpinPage(child_page_id, true);
+            BasicPageGuard child_guard = buffer_pool_manager->FetchPageBasic(child_page_id);
+            child_guard.AsMut<BPlusTreePage>()->SetParentPageId(GetPageId());
         }
     }
 }
@@ -209,9 +216,8 @@ void InternalPage::CopyLastFrom(GenericKey *key, const page_id_t value, BufferPo
     SetValueAt(GetSize(), value);
     IncreaseSize(1);
     if (value != INVALID_PAGE_ID) {
-        auto *child_page = reinterpret_cast<InternalPage *>(buffer_pool_manager->FetchPage(value)->GetData());
-        child_page->SetParentPageId(GetPageId());
-        buffer_pool_manager->UnpinPage(value, true);
+        BasicPageGuard child_guard = buffer_pool_manager->FetchPageBasic(value);
+        child_guard.AsMut<BPlusTreePage>()->SetParentPageId(GetPageId());
     }
 }
 
@@ -240,8 +246,7 @@ void InternalPage::CopyFirstFrom(const page_id_t value, BufferPoolManager *buffe
     SetValueAt(0, value);
     IncreaseSize(1);
     if (value != INVALID_PAGE_ID) {
-        auto *child_page = reinterpret_cast<InternalPage *>(buffer_pool_manager->FetchPage(value)->GetData());
-        child_page->SetParentPageId(GetPageId());
-        buffer_pool_manager->UnpinPage(value, true);
+        BasicPageGuard child_guard = buffer_pool_manager->FetchPageBasic(value);
+        child_guard.AsMut<BPlusTreePage>()->SetParentPageId(GetPageId());
     }
 }
\ No newline at end of file
@@ -55,15 +55,35 @@ void LeafPage::SetNextPageId(page_id_t next_page_id) {
  * 二分查找
  */
 int LeafPage::KeyIndex(const GenericKey *key, const KeyManager &KM) {
+    return KM.Dispatch([&](const auto &comparator) { return KeyIndexOf(key, comparator); });
+}
+
+template <typename Comparator>
+int LeafPage::KeyIndexOf(const GenericKey *key, const Comparator &comparator) {
+    // the stride is a constant for a fixed width comparator
+    const size_t stride = comparator.Size() + sizeof(RowId);
     int l = 0, r = GetSize() - 1;
     while (l <= r) {
         int mid = (l + r) / 2;
-        if (KM.CompareKeys(KeyAt(mid), key) < 0) l = mid + 1;
+        auto mid_key = reinterpret_cast<const GenericKey *>(pairs_off + mid * stride);
+        if (comparator.Compare(mid_key, key) < 0) l = mid + 1;
         else r = mid - 1;
     }
     return l;
 }
 
+/**
+ * @return the index of key, -1 if it is not in this page
+ */
+template <typename Comparator>
+int LeafPage::FindKey(const GenericKey *key, const Comparator &comparator) {
+    int index = KeyIndexOf(key, comparator);
+    if (index < GetSize() && comparator.Compare(KeyAt(index), key) == 0) {
+        return index;
+    }
+    return -1;
+}
+
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
@@ -105,12 +125,17 @@ std::pair<GenericKey *, RowId> LeafPage::GetItem(int index) { return {KeyAt(inde
  * @return page size after insertion
  */
 int LeafPage::Insert(GenericKey *key, const RowId &value, const KeyManager &KM) {
-    int index = KeyIndex(key, KM);
-    if (index < GetSize() && KM.CompareKeys(KeyAt(index), key) == 0) {
+    return KM.Dispatch([&](const auto &comparator) { return InsertWith(key, value, comparator); });
+}
+
+template <typename Comparator>
+int LeafPage::InsertWith(GenericKey *key, const RowId &value, const Comparator &comparator) {
+    int index = KeyIndexOf(key, comparator);
+    if (index < GetSize() && comparator.Compare(KeyAt(index), key) == 0) {
         return GetSize();
     }
     memmove(PairPtrAt(index + 1), PairPtrAt(index), (GetSize() - index) * pair_size);
-    SetKeyAt(index, key);
+    comparator.Copy(pairs_off + index * pair_size + key_off, key);
     SetValueAt(index, value);
     IncreaseSize(1);
     return GetSize();
@@ -146,8 +171,8 @@ void LeafPage::CopyNFrom(void *src, int size) {
  * If the key does not exist, then return false
  */
 bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM) {
-    int index = KeyIndex(key, KM);
-    if (index < GetSize() && KM.CompareKeys(KeyAt(index), key) == 0) {
+    int index = KM.Dispatch([&](const auto &comparator) { return FindKey(key, comparator); });
+    if (index >= 0) {
         value = ValueAt(index);
         return true;
     }
@@ -164,8 +189,8 @@ bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM)
  * @return  page size after deletion
  */
 int LeafPage::RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &KM) {
-    int index = KeyIndex(key, KM);
-    if (index < GetSize() && KM.CompareKeys(KeyAt(index), key) == 0) {
+    int index = KM.Dispatch([&](const auto &comparator) { return FindKey(key, comparator); });
+    if (index >= 0) {
         memmove(PairPtrAt(index), PairPtrAt(index + 1), (GetSize() - index - 1) * pair_size);
         IncreaseSize(-1);
     }
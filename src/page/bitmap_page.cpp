@@ -17,6 +17,35 @@ bool BitmapPage<PageSize>::AllocatePage(uint32_t &page_offset) {
   	return true;
 }
 
+template <size_t PageSize>
+bool BitmapPage<PageSize>::AllocateRun(uint32_t n, uint32_t &page_offset) {
+	if (n == 0 || page_allocated_ + n > GetMaxSupportedSize()) return false;
+	uint32_t run = 0;
+	for (uint32_t i = next_free_page_; i < GetMaxSupportedSize(); i++) {
+		// a full byte ends the run, skip it at once
+		if (i % 8 == 0 && bytes[i / 8] == 0xFF) {
+			run = 0;
+			i += 7;
+			continue;
+		}
+		if (!IsPageFreeLow(i / 8, i % 8)) {
+			run = 0;
+			continue;
+		}
+		if (++run < n) continue;
+		page_offset = i + 1 - n;
+		for (uint32_t j = page_offset; j <= i; j++) {
+			bytes[j / 8] |= 1 << (j % 8);
+		}
+		page_allocated_ += n;
+		while (!IsPageFree(next_free_page_) && next_free_page_ < GetMaxSupportedSize() - 1) {
+			++next_free_page_;
+		}
+		return true;
+	}
+	return false;
+}
+
 /**
  * TODO: Student Implement (finished)
  */
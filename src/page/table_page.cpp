@@ -1,37 +1,61 @@
 #include "page/table_page.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 // TODO: Update interface implementation if apply recovery
 
+namespace {
+
+uint32_t SerializedSize(const Row &row, Schema *schema, const RowCodec *codec) {
+  return codec != nullptr ? codec->GetSerializedSize(row) : row.GetSerializedSize(schema);
+}
+
+uint32_t Serialize(const Row &row, char *buf, Schema *schema, const RowCodec *codec) {
+  return codec != nullptr ? codec->SerializeTo(row, buf) : row.SerializeTo(buf, schema);
+}
+
+uint32_t Deserialize(char *buf, Row &row, Schema *schema, const RowCodec *codec) {
+  return codec != nullptr ? codec->DeserializeFrom(buf, row) : row.DeserializeFrom(buf, schema);
+}
+
+}  // namespace
+
 void TablePage::Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr, Txn *txn) {
   memcpy(GetData(), &page_id, sizeof(page_id));
   SetPrevPageId(prev_id);
   SetNextPageId(INVALID_PAGE_ID);
-  SetFreeSpacePointer(PAGE_SIZE);
+  SetFreeSpacePointer(PAGE_USABLE_SIZE);
   SetTupleCount(0);
+  SetFreeSpaceMapPageId(INVALID_PAGE_ID);
+  SetFirstFreeSlot(NO_FREE_SLOT);
+  SetFragmentedBytes(0);
 }
 
-bool TablePage::InsertTuple(Row &row, Schema *schema, Txn *txn, LockManager *lock_manager, LogManager *log_manager) {
-  uint32_t serialized_size = row.GetSerializedSize(schema);
+bool TablePage::InsertTuple(Row &row, Schema *schema, Txn *txn, LockManager *lock_manager, LogManager *log_manager,
+                            const RowCodec *codec) {
+  uint32_t serialized_size = SerializedSize(row, schema, codec);
   ASSERT(serialized_size > 0, "Can not have empty row.");
   if (GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
     return false;
   }
-  // Try to find a free slot to reuse.
-  uint32_t i;
-  for (i = 0; i < GetTupleCount(); i++) {
-    // If the slot is empty, i.e. its tuple has size 0,
-    if (GetTupleSize(i) == 0) {
-      // Then we break out of the loop at index i.
-      break;
-    }
+  // Reuse the most recently freed slot, or else add a slot.
+  uint32_t i = GetFirstFreeSlot();
+  if (i == NO_FREE_SLOT) {
+    i = GetTupleCount();
+  }
+  // The tuple and a new slot must fit in front of the tuples.
+  if (GetContiguousFreeSpace() < serialized_size + SIZE_TUPLE) {
+    Compact();
+  }
+  if (i != GetTupleCount()) {
+    SetFirstFreeSlot(GetTupleOffsetAtSlot(i));
   }
-  // if (i == GetTupleCount() && GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
-  //   return false;
-  // }
 
   // Otherwise we claim available free space..
   SetFreeSpacePointer(GetFreeSpacePointer() - serialized_size);
-  uint32_t __attribute__((unused)) write_bytes = row.SerializeTo(GetData() + GetFreeSpacePointer(), schema);
+  uint32_t __attribute__((unused)) write_bytes = Serialize(row, GetData() + GetFreeSpacePointer(), schema, codec);
   ASSERT(write_bytes == serialized_size, "Unexpected behavior in row serialize.");
 
   // Set the tuple.
@@ -64,9 +88,9 @@ bool TablePage::MarkDelete(const RowId &rid, Txn *txn, LockManager *lock_manager
 }
 
 int TablePage::UpdateTuple(Row &new_row, Row *old_row, Schema *schema, Txn *txn, LockManager *lock_manager,
-                            LogManager *log_manager) {
+                            LogManager *log_manager, const RowCodec *codec) {
   ASSERT(old_row != nullptr && old_row->GetRowId().Get() != INVALID_ROWID.Get(), "invalid old row.");
-  uint32_t serialized_size = new_row.GetSerializedSize(schema);
+  uint32_t serialized_size = SerializedSize(new_row, schema, codec);
   ASSERT(serialized_size > 0, "Can not have empty row.");
   uint32_t slot_num = old_row->GetRowId().GetSlotNum();
   // If the slot number is invalid, abort.
@@ -82,23 +106,27 @@ int TablePage::UpdateTuple(Row &new_row, Row *old_row, Schema *schema, Txn *txn,
   if (GetFreeSpaceRemaining() + tuple_size < serialized_size) {
     return NOT_ENOUGH_SPACE;
   }
+  // The tuples in front of this one move down by the growth of the tuple.
+  if (GetContiguousFreeSpace() + tuple_size < serialized_size) {
+    Compact();
+  }
   // Copy out the old value.
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-  uint32_t __attribute__((unused)) read_bytes = old_row->DeserializeFrom(GetData() + tuple_offset, schema);
+  uint32_t __attribute__((unused)) read_bytes = Deserialize(GetData() + tuple_offset, *old_row, schema, codec);
   ASSERT(tuple_size == read_bytes, "Unexpected behavior in tuple deserialize.");
   uint32_t free_space_pointer = GetFreeSpacePointer();
   ASSERT(tuple_offset >= free_space_pointer, "Offset should appear after current free space position.");
   memmove(GetData() + free_space_pointer + tuple_size - serialized_size, GetData() + free_space_pointer,
           tuple_offset - free_space_pointer);
   SetFreeSpacePointer(free_space_pointer + tuple_size - serialized_size);
-  new_row.SerializeTo(GetData() + tuple_offset + tuple_size - serialized_size, schema);
+  Serialize(new_row, GetData() + tuple_offset + tuple_size - serialized_size, schema, codec);
   SetTupleSize(slot_num, serialized_size);
 
   // Update all tuple offsets.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
     uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
     if (GetTupleSize(i) > 0 && tuple_offset_i < tuple_offset + tuple_size) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - new_row.GetSerializedSize(schema));
+      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - serialized_size);
     }
   }
   return TUPLE_UPDATED;
@@ -115,22 +143,62 @@ void TablePage::ApplyDelete(const RowId &rid, Txn *txn, LogManager *log_manager)
     tuple_size = UnsetDeletedFlag(tuple_size);
   }
 
+  // The slot is free already.
+  if (tuple_size == 0) {
+    return;
+  }
+
   uint32_t free_space_pointer = GetFreeSpacePointer();
   ASSERT(tuple_offset >= free_space_pointer, "Free space appears before tuples.");
 
-  memmove(GetData() + free_space_pointer + tuple_size, GetData() + free_space_pointer,
-          tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size);
+  // The bytes of the tuple become free space right away if it is the first one, else they stay a hole until the
+  // page is compacted, so that no other tuple has to move.
+  if (tuple_offset == free_space_pointer) {
+    SetFreeSpacePointer(free_space_pointer + tuple_size);
+  } else {
+    SetFragmentedBytes(GetFragmentedBytes() + tuple_size);
+  }
   SetTupleSize(slot_num, 0);
-  SetTupleOffsetAtSlot(slot_num, 0);
+  // Push the slot onto the free slot chain.
+  SetTupleOffsetAtSlot(slot_num, GetFirstFreeSlot());
+  SetFirstFreeSlot(slot_num);
+}
 
-  // Update all tuple offsets.
-  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
-    uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
-    if (GetTupleSize(i) != 0 && tuple_offset_i < tuple_offset) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size);
+void TablePage::Compact() {
+  if (GetFragmentedBytes() == 0) {
+    return;
+  }
+  // Tuples are moved to the end of the page from the last one on, so a tuple never overwrites one not moved yet.
+  std::vector<std::pair<uint32_t, uint32_t>> tuples;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    if (GetTupleSize(i) != 0) {
+      tuples.emplace_back(GetTupleOffsetAtSlot(i), i);
+    }
+  }
+  std::sort(tuples.begin(), tuples.end(), std::greater<>());
+  uint32_t free_space_pointer = PAGE_USABLE_SIZE;
+  for (auto &[tuple_offset, slot_num] : tuples) {
+    uint32_t tuple_size = UnsetDeletedFlag(GetTupleSize(slot_num));
+    free_space_pointer -= tuple_size;
+    if (free_space_pointer != tuple_offset) {
+      memmove(GetData() + free_space_pointer, GetData() + tuple_offset, tuple_size);
+      SetTupleOffsetAtSlot(slot_num, free_space_pointer);
+    }
+  }
+  SetFreeSpacePointer(free_space_pointer);
+  SetFragmentedBytes(0);
+}
+
+uint32_t TablePage::ApplyMarkedDeletes(Txn *txn, LogManager *log_manager) {
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (tuple_size != 0 && IsDeleted(tuple_size)) {
+      ApplyDelete(RowId(GetTablePageId(), i), txn, log_manager);
+      count++;
     }
   }
+  return count;
 }
 
 void TablePage::RollbackDelete(const RowId &rid, Txn *txn, LogManager *log_manager) {
@@ -144,7 +212,7 @@ void TablePage::RollbackDelete(const RowId &rid, Txn *txn, LogManager *log_manag
   }
 }
 
-bool TablePage::GetTuple(Row *row, Schema *schema, Txn *txn, LockManager *lock_manager) {
+bool TablePage::GetTuple(Row *row, Schema *schema, Txn *txn, LockManager *lock_manager, const RowCodec *codec) {
   ASSERT(row != nullptr && row->GetRowId().Get() != INVALID_ROWID.Get(), "Invalid row.");
   // Get the current slot number.
   uint32_t slot_num = row->GetRowId().GetSlotNum();
@@ -160,11 +228,37 @@ bool TablePage::GetTuple(Row *row, Schema *schema, Txn *txn, LockManager *lock_m
   }
   // At this point, we have at least a shared lock on the RID. Copy the tuple data into our result.
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-  uint32_t __attribute__((unused)) read_bytes = row->DeserializeFrom(GetData() + tuple_offset, schema);
+  uint32_t __attribute__((unused)) read_bytes = Deserialize(GetData() + tuple_offset, *row, schema, codec);
   ASSERT(tuple_size == read_bytes, "Unexpected behavior in tuple deserialize.");
   return true;
 }
 
+uint32_t TablePage::GetTuples(std::pmr::vector<Row> &rows, Schema *schema, Txn *txn, LockManager *lock_manager,
+                              const RowCodec *codec, const RowFilter &filter) {
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (IsDeleted(tuple_size)) {
+      continue;
+    }
+    // Tuples the filter drops are never copied out of the page.
+    if (filter) {
+      RowView view(&codec->GetLayout(), GetData() + GetTupleOffsetAtSlot(i), RowId(GetTablePageId(), i));
+      if (!filter(view)) {
+        continue;
+      }
+    }
+    if (count == rows.size()) {
+      rows.emplace_back();
+    }
+    Row &row = rows[count++];
+    row.SetRowId(RowId(GetTablePageId(), i));
+    uint32_t __attribute__((unused)) read_bytes = Deserialize(GetData() + GetTupleOffsetAtSlot(i), row, schema, codec);
+    ASSERT(tuple_size == read_bytes, "Unexpected behavior in tuple deserialize.");
+  }
+  return count;
+}
+
 bool TablePage::GetFirstTupleRid(RowId *first_rid) {
   // Find and return the first valid tuple.
   for (uint32_t i = 0; i < GetTupleCount(); i++) {
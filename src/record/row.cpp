@@ -1,5 +1,7 @@
 #include "record/row.h"
 
+char Row::empty_chars_[1] = {0};
+
 /**
  * TODO: Student Implement
  * @brief: Serialize the row to a buffer
@@ -14,35 +16,68 @@ uint32_t Row::SerializeTo(char* buf, Schema* schema) const {
 	uint32_t cnt = this->GetFieldCount();
 	uint32_t len = (cnt + 31) / 32;
 	res += len * sizeof(uint32_t);
-	uint32_t* nulls = new uint32_t[len];
+	// the null bitmap is built in place
+	char* nulls = buf + sizeof(uint32_t);
 	memset(nulls, 0, len * sizeof(uint32_t));
-	for (int i = 0; i < cnt; ++i) {
-		if (fields_[i]->IsNull()) nulls[i / 32] |= 1u << (i % 32);
-		else res += fields_[i]->SerializeTo(buf + res);
+	for (uint32_t i = 0; i < cnt; ++i) {
+		if (fields_[i].IsNull()) {
+			uint32_t word = MACH_READ_UINT32(nulls + i / 32 * sizeof(uint32_t)) | (1u << (i % 32));
+			MACH_WRITE_UINT32(nulls + i / 32 * sizeof(uint32_t), word);
+		}
+		else res += fields_[i].SerializeTo(buf + res);
 	}
 	memcpy(buf, &cnt, sizeof(uint32_t));
-	memcpy(buf + sizeof(uint32_t), nulls, len * sizeof(uint32_t));
-	delete[] nulls;
 	return res;
 }
 
 uint32_t Row::DeserializeFrom(char* buf, Schema* schema) {
-	uint32_t res = sizeof(uint32_t), cnt = 0;
+	uint32_t cnt = 0;
 	memcpy(&cnt, buf, sizeof(uint32_t));
-	uint32_t len = (cnt + 31) / 32;
-	res += len * sizeof(uint32_t);
-	uint32_t* nulls = new uint32_t[len];
-	memcpy(nulls, buf + sizeof(uint32_t), len * sizeof(uint32_t));
-	fields_.resize(cnt);
-	for (int i = 0; i < cnt; ++i) {
-		if (nulls[i / 32] & (1u << (i % 32))) {
-			res += Field::DeserializeFrom(buf + res, schema->GetColumn(i)->GetType(), &fields_[i], true);
+	const char* nulls = buf + sizeof(uint32_t);
+	uint32_t header = sizeof(uint32_t) + (cnt + 31) / 32 * sizeof(uint32_t);
+	auto is_null = [&](uint32_t i) { return (MACH_READ_UINT32(nulls + i / 32 * sizeof(uint32_t)) >> (i % 32)) & 1u; };
+	// the values are decoded straight from buf, a reused row keeps the capacity of its buffers
+	fields_.clear();
+	size_t chars_size = 0;
+	uint32_t res = header;
+	for (uint32_t i = 0; i < cnt; ++i) {
+		if (is_null(i)) continue;
+		TypeId type = schema->GetColumn(i)->GetType();
+		if (type == TypeId::kTypeChar) {
+			uint32_t len = MACH_READ_UINT32(buf + res);
+			chars_size += len;
+			res += sizeof(uint32_t) + len;
 		}
-		else {
-			res += Field::DeserializeFrom(buf + res, schema->GetColumn(i)->GetType(), &fields_[i], false);
+		else res += Type::GetTypeSize(type);
+	}
+	chars_.resize(chars_size);
+	fields_.reserve(cnt);
+	res = header;
+	size_t offset = 0;
+	for (uint32_t i = 0; i < cnt; ++i) {
+		TypeId type = schema->GetColumn(i)->GetType();
+		if (is_null(i)) {
+			fields_.emplace_back(type);
+			continue;
+		}
+		switch (type) {
+			case TypeId::kTypeInt:
+				fields_.emplace_back(type, MACH_READ_INT32(buf + res));
+				res += sizeof(int32_t);
+				break;
+			case TypeId::kTypeFloat:
+				fields_.emplace_back(type, MACH_READ_FROM(float_t, buf + res));
+				res += sizeof(float_t);
+				break;
+			default: {
+				uint32_t len = MACH_READ_UINT32(buf + res);
+				memcpy(CharsAt(offset), buf + res + sizeof(uint32_t), len);
+				fields_.emplace_back(type, CharsAt(offset), len, false);
+				offset += len;
+				res += sizeof(uint32_t) + len;
+			}
 		}
 	}
-	delete[] nulls;
 	return res;
 }
 
@@ -54,21 +89,28 @@ uint32_t Row::GetSerializedSize(Schema* schema) const {
 	int cnt = schema->GetColumnCount();
 	res += (cnt + 31) / 32 * sizeof(uint32_t);
 	for (int i = 0; i < cnt; ++i) {
-		if (!fields_[i]->IsNull()) {
-			res += fields_[i]->GetSerializedSize();
+		if (!fields_[i].IsNull()) {
+			res += fields_[i].GetSerializedSize();
 		}
 	}
 	return res;
 }
 
 void Row::GetKeyFromRow(const Schema* schema, const Schema* key_schema, Row& key_row) {
-	auto columns = key_schema->GetColumns();
-	std::vector<Field> fields;
-	uint32_t idx;
-	for (auto column : columns) {
-		schema->GetColumnIndex(column->GetName(), idx);
-		fields.emplace_back(*this->GetField(idx));
-	}
-	key_row = Row(fields);
+	ASSERT(&key_row != this, "Key row must be another row.");
+	const auto& columns = key_schema->GetColumns();
+	uint32_t idx = 0;
+	key_row.AssignFields(static_cast<uint32_t>(columns.size()), [&](uint32_t i) -> const Field& {
+		schema->GetColumnIndex(columns[i]->GetName(), idx);
+		return fields_[idx];
+	});
 	key_row.SetRowId(this->GetRowId());
 }
+
+void Row::ProjectTo(const Schema* output_schema, Row& output_row) const {
+	ASSERT(&output_row != this, "Output row must be another row.");
+	const auto& columns = output_schema->GetColumns();
+	output_row.AssignFields(static_cast<uint32_t>(columns.size()),
+	                        [&](uint32_t i) -> const Field& { return fields_[columns[i]->GetTableInd()]; });
+	output_row.SetRowId(rid_);
+}
@@ -0,0 +1,122 @@
+#include "record/row_codec.h"
+
+RowCodec::RowCodec(Schema* schema) : layout_(schema) {
+	uint32_t cnt = layout_.GetColumnCount();
+	encoders_.reserve(cnt);
+	decoders_.reserve(cnt);
+	for (uint32_t i = 0; i < cnt; ++i) {
+		switch (layout_.GetType(i)) {
+			case TypeId::kTypeInt:
+				encoders_.push_back(&Encode<TypeId::kTypeInt>);
+				decoders_.push_back(&Decode<TypeId::kTypeInt>);
+				break;
+			case TypeId::kTypeFloat:
+				encoders_.push_back(&Encode<TypeId::kTypeFloat>);
+				decoders_.push_back(&Decode<TypeId::kTypeFloat>);
+				break;
+			case TypeId::kTypeChar:
+				encoders_.push_back(&Encode<TypeId::kTypeChar>);
+				decoders_.push_back(&Decode<TypeId::kTypeChar>);
+				has_chars_ = true;
+				break;
+			default:
+				ASSERT(false, "Unsupported column type.");
+		}
+	}
+}
+
+template <TypeId type>
+uint32_t RowCodec::Encode(const Field& field, char* buf) {
+	if constexpr (type == TypeId::kTypeInt) {
+		MACH_WRITE_TO(int32_t, buf, field.value_.integer_);
+		return sizeof(int32_t);
+	} else if constexpr (type == TypeId::kTypeFloat) {
+		MACH_WRITE_TO(float_t, buf, field.value_.float_);
+		return sizeof(float_t);
+	} else {
+		MACH_WRITE_UINT32(buf, field.len_);
+		memcpy(buf + sizeof(uint32_t), field.value_.chars_, field.len_);
+		return sizeof(uint32_t) + field.len_;
+	}
+}
+
+template <TypeId type>
+uint32_t RowCodec::Decode(const char* buf, Row& row, size_t& chars_offset) {
+	if constexpr (type == TypeId::kTypeInt) {
+		row.fields_.emplace_back(type, MACH_READ_INT32(buf));
+		return sizeof(int32_t);
+	} else if constexpr (type == TypeId::kTypeFloat) {
+		row.fields_.emplace_back(type, MACH_READ_FROM(float_t, buf));
+		return sizeof(float_t);
+	} else {
+		uint32_t len = MACH_READ_UINT32(buf);
+		char* chars = row.CharsAt(chars_offset);
+		memcpy(chars, buf + sizeof(uint32_t), len);
+		row.fields_.emplace_back(type, chars, len, false);
+		chars_offset += len;
+		return sizeof(uint32_t) + len;
+	}
+}
+
+uint32_t RowCodec::GetSerializedSize(const Row& row) const {
+	ASSERT(row.GetFieldCount() == layout_.GetColumnCount(), "Fields size do not match schema's column size.");
+	uint32_t res = layout_.GetHeaderSize();
+	uint32_t cnt = layout_.GetColumnCount();
+	for (uint32_t i = 0; i < cnt; ++i) {
+		const Field& field = row.fields_[i];
+		if (field.is_null_) continue;
+		uint32_t size = layout_.GetFixedSize(i);
+		res += size != 0 ? size : sizeof(uint32_t) + field.len_;
+	}
+	return res;
+}
+
+uint32_t RowCodec::SerializeTo(const Row& row, char* buf) const {
+	ASSERT(row.GetFieldCount() == layout_.GetColumnCount(), "Fields size do not match schema's column size.");
+	uint32_t cnt = layout_.GetColumnCount();
+	uint32_t header = layout_.GetHeaderSize();
+	MACH_WRITE_UINT32(buf, cnt);
+	memset(buf + sizeof(uint32_t), 0, header - sizeof(uint32_t));
+	uint32_t res = header;
+	for (uint32_t i = 0; i < cnt; ++i) {
+		const Field& field = row.fields_[i];
+		if (field.is_null_) {
+			char* word = buf + sizeof(uint32_t) * (1 + i / 32);
+			MACH_WRITE_UINT32(word, MACH_READ_UINT32(word) | (1u << (i % 32)));
+		}
+		else res += encoders_[i](field, buf + res);
+	}
+	return res;
+}
+
+uint32_t RowCodec::DeserializeFrom(const char* buf, Row& row) const {
+	uint32_t cnt = layout_.GetColumnCount();
+	ASSERT(MACH_READ_UINT32(buf) == cnt, "Fields size do not match schema's column size.");
+	uint32_t header = layout_.GetHeaderSize();
+	RowView view(&layout_, buf, row.GetRowId());
+	// the char buffer is sized up front, so it does not move while fields point into it
+	if (has_chars_) {
+		size_t chars_size = 0;
+		uint32_t res = header;
+		for (uint32_t i = 0; i < cnt; ++i) {
+			if (view.IsNull(i)) continue;
+			uint32_t size = layout_.GetFixedSize(i);
+			if (size == 0) {
+				uint32_t len = MACH_READ_UINT32(buf + res);
+				chars_size += len;
+				size = sizeof(uint32_t) + len;
+			}
+			res += size;
+		}
+		row.chars_.resize(chars_size);
+	}
+	row.fields_.clear();
+	row.fields_.reserve(cnt);
+	uint32_t res = header;
+	size_t chars_offset = 0;
+	for (uint32_t i = 0; i < cnt; ++i) {
+		if (view.IsNull(i)) row.fields_.emplace_back(layout_.GetType(i));
+		else res += decoders_[i](buf + res, row, chars_offset);
+	}
+	return res;
+}
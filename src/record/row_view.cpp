@@ -0,0 +1,69 @@
+#include "record/row_view.h"
+
+RowLayout::RowLayout(Schema* schema) : schema_(schema) {
+	uint32_t cnt = schema->GetColumnCount();
+	header_size_ = sizeof(uint32_t) + (cnt + 31) / 32 * sizeof(uint32_t);
+	uint32_t offset = header_size_;
+	bool fixed = true;
+	for (uint32_t i = 0; i < cnt; ++i) {
+		TypeId type = schema->GetColumn(i)->GetType();
+		uint32_t size = type == TypeId::kTypeChar ? 0 : Type::GetTypeSize(type);
+		types_.push_back(type);
+		fixed_sizes_.push_back(size);
+		// the first char column still has a fixed offset, the columns after it do not
+		if (fixed) {
+			prefix_offsets_.push_back(offset);
+			offset += size;
+			fixed = size != 0;
+		}
+	}
+}
+
+Field RowView::GetField(uint32_t column_index) const {
+	ASSERT(column_index < layout_->GetColumnCount(), "Failed to access field");
+	TypeId type = layout_->GetType(column_index);
+	if (IsNull(column_index)) {
+		return Field(type);
+	}
+	const char* value = data_ + GetOffset(column_index);
+	switch (type) {
+		case TypeId::kTypeInt:
+			return Field(type, MACH_READ_INT32(value));
+		case TypeId::kTypeFloat:
+			return Field(type, MACH_READ_FROM(float_t, value));
+		default:
+			return Field(type, const_cast<char*>(value + sizeof(uint32_t)), MACH_READ_UINT32(value), false);
+	}
+}
+
+void RowView::ToRow(Row* row) const {
+	row->DeserializeFrom(const_cast<char*>(data_), layout_->GetSchema());
+	row->SetRowId(rid_);
+}
+
+bool RowView::HasNullBefore(uint32_t column_index) const {
+	for (uint32_t word = 0; word <= column_index / 32; ++word) {
+		uint32_t mask = word < column_index / 32 ? ~0u : (1u << (column_index % 32)) - 1;
+		if (MACH_READ_UINT32(data_ + sizeof(uint32_t) * (1 + word)) & mask) return true;
+	}
+	return false;
+}
+
+uint32_t RowView::GetOffset(uint32_t column_index) const {
+	if (column_index < layout_->GetFixedPrefix() && !HasNullBefore(column_index)) {
+		return layout_->GetPrefixOffset(column_index);
+	}
+	uint32_t col = 0, offset = layout_->GetHeaderSize();
+	if (walk_offset_ != 0 && walk_column_ <= column_index) {
+		col = walk_column_;
+		offset = walk_offset_;
+	}
+	for (; col < column_index; ++col) {
+		if (IsNull(col)) continue;
+		uint32_t size = layout_->GetFixedSize(col);
+		offset += size != 0 ? size : sizeof(uint32_t) + MACH_READ_UINT32(data_ + offset);
+	}
+	walk_column_ = column_index;
+	walk_offset_ = offset;
+	return offset;
+}
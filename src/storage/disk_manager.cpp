@@ -1,38 +1,87 @@
 #include "storage/disk_manager.h"
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
+#include <memory>
 #include <stdexcept>
 
+#include "common/crc32c.h"
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+/**
+ * O_DIRECT needs PAGE_SIZE aligned buffers. Buffer pool frames are aligned, other callers (meta and bitmap pages,
+ * copies made by the disk scheduler) are served through this per thread buffer. Data pages are also stamped in it,
+ * so WritePage does not modify the caller's buffer.
+ */
+static char *BounceBuffer() {
+    thread_local std::unique_ptr<char, decltype(&free)> buffer(
+        static_cast<char *>(aligned_alloc(PAGE_SIZE, PAGE_SIZE)), &free);
+    return buffer.get();
+}
+
+static bool IsAligned(const char *data) {
+    return reinterpret_cast<uintptr_t>(data) % PAGE_SIZE == 0;
+}
+
+DiskManager::DiskManager(const std::string &db_file, bool direct_io, PageChecksumPolicy checksum_policy,
+                         uint32_t extents_per_meta)
+    : file_name_(db_file),
+      direct_io_(direct_io),
+      checksum_policy_(checksum_policy),
+      extents_per_meta_(extents_per_meta == 0 || extents_per_meta > MAX_EXTENT_NUMS ? MAX_EXTENT_NUMS
+                                                                                      : extents_per_meta) {
     std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    // directory or file does not exist
-    if (!db_io_.is_open()) {
-        db_io_.clear();
-        // create a new file
-        std::filesystem::path p = db_file;
-        if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
-        db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-        db_io_.close();
-        // reopen with original mode
-        db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-        if (!db_io_.is_open()) {
-            throw std::exception();
-        }
+    // directory does not exist
+    std::filesystem::path p = db_file;
+    if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
+    // create the file if it does not exist
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | (direct_io_ ? O_DIRECT : 0), 0644);
+    if (db_fd_ < 0 && direct_io_ && errno == EINVAL) {
+        // e.g. tmpfs does not support O_DIRECT
+        LOG(WARNING) << "O_DIRECT is not supported for " << db_file << ", using buffered I/O";
+        direct_io_ = false;
+        db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+    }
+    if (db_fd_ < 0) {
+        throw std::exception();
+    }
+    file_size_ = GetFileSize();
+    // follow the chain of meta pages, a group is only followed by another one when all its extents exist
+    do {
+        meta_pages_.emplace_back(new char[PAGE_SIZE]);
+        ReadPhysicalPage(MetaPageId(meta_pages_.size() - 1), meta_pages_.back().get());
+        auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_pages_.back().get());
+        num_allocated_pages_ += meta_page->GetAllocatedPages();
+        num_extents_ += meta_page->GetExtentNums();
+    } while (num_extents_ == meta_pages_.size() * extents_per_meta_);
+    auto *first_meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_pages_[0].get());
+    if (file_size_ == 0) {
+        // a new file, the version is on disk before any page is
+        first_meta_page->SetFormatVersion(DISK_FILE_FORMAT_VERSION);
+        WritePhysicalPage(MetaPageId(0), meta_pages_[0].get());
+    } else if (first_meta_page->GetFormatVersion() != DISK_FILE_FORMAT_VERSION) {
+        uint32_t version = first_meta_page->GetFormatVersion();
+        close(db_fd_);
+        db_fd_ = -1;
+        closed = true;
+        LOG(ERROR) << db_file << " has disk format version " << version << ", expected " << DISK_FILE_FORMAT_VERSION;
+        throw std::runtime_error("unsupported disk format version " + std::to_string(version) + " of " + db_file);
     }
-    ReadPhysicalPage(META_PAGE_ID, meta_data_);
 }
 
 void DiskManager::Close() {
     std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
-    WritePhysicalPage(META_PAGE_ID, meta_data_);
     if (!closed) {
-        db_io_.close();
+        Checkpoint();
+        close(db_fd_);
+        db_fd_ = -1;
         closed = true;
     }
 }
@@ -40,53 +89,107 @@ void DiskManager::Close() {
 void DiskManager::ReadPage(page_id_t logical_page_id, char *page_data) {
     ASSERT(logical_page_id >= 0, "Invalid page id.");
     ReadPhysicalPage(MapPageId(logical_page_id), page_data);
+    VerifyChecksum(logical_page_id, page_data);
 }
 
 void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
     ASSERT(logical_page_id >= 0, "Invalid page id.");
-    WritePhysicalPage(MapPageId(logical_page_id), page_data);
+    // the copy is aligned, so with O_DIRECT it is written without another one
+    char *buffer = BounceBuffer();
+    memcpy(buffer, page_data, PAGE_USABLE_SIZE);
+    StampChecksum(buffer);
+    WritePhysicalPage(MapPageId(logical_page_id), buffer);
+}
+
+void DiskManager::StampChecksum(char *page_data) {
+    // the trailer is reserved for the disk manager, no page layout reads or writes it
+    uint32_t checksum = Crc32c(page_data, PAGE_USABLE_SIZE);
+    memcpy(page_data + PAGE_USABLE_SIZE, &checksum, PAGE_CHECKSUM_SIZE);
+}
+
+bool DiskManager::VerifyChecksum(page_id_t logical_page_id, const char *page_data) {
+    PageChecksumPolicy policy = checksum_policy_.load(std::memory_order_relaxed);
+    if (policy == PageChecksumPolicy::kIgnore) return true;
+    uint32_t stored;
+    memcpy(&stored, page_data + PAGE_USABLE_SIZE, PAGE_CHECKSUM_SIZE);
+    if (stored == Crc32c(page_data, PAGE_USABLE_SIZE)) return true;
+    // a page that was never written, e.g. beyond the end of the file or reserved by fallocate
+    if (stored == 0 && page_data[0] == 0 && memcmp(page_data, page_data + 1, PAGE_USABLE_SIZE - 1) == 0) return true;
+    checksum_failures_++;
+    if (policy == PageChecksumPolicy::kFatal) {
+        LOG(FATAL) << "Checksum mismatch in page " << logical_page_id << " of " << file_name_;
+    }
+    LOG(ERROR) << "Checksum mismatch in page " << logical_page_id << " of " << file_name_
+               << ", the page is torn or corrupted";
+    return false;
 }
 
 /**
  * TODO: Student Implement (finished)
  */
 page_id_t DiskManager::AllocatePage() {
-	DiskFileMetaPage* meta_page = reinterpret_cast<DiskFileMetaPage*>(meta_data_);
-	if (meta_page->GetAllocatedPages() >= MAX_VALID_PAGE_ID) return INVALID_PAGE_ID;
-	for (uint32_t i = 0; i < meta_page->GetExtentNums(); ++i) {
-		if (meta_page->GetExtentUsedPage(i) < BITMAP_SIZE) {
-			BitmapPage<PAGE_SIZE>* bitmap = new BitmapPage<PAGE_SIZE>();
-			ReadPhysicalPage(i * (BITMAP_SIZE + 1) + 1, reinterpret_cast<char*>(bitmap));
-			uint32_t page_offset = 0;
-			ASSERT(bitmap->AllocatePage(page_offset), "Allocate page failed.");
-			WritePhysicalPage(i * (BITMAP_SIZE + 1) + 1, reinterpret_cast<char*>(bitmap));
-			meta_page->num_allocated_pages_++;
-			meta_page->extent_used_page_[i]++;
-			return i * BITMAP_SIZE + page_offset;
-		}
+	std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+	if (num_allocated_pages_ >= static_cast<uint32_t>(MAX_VALID_PAGE_ID)) return INVALID_PAGE_ID;
+	// the hint only moves forward here and back on deallocation, so the skipped extents are amortized O(1)
+	while (free_extent_hint_ < num_extents_ && GetMeta(free_extent_hint_)->GetExtentUsedPage(
+	                                               free_extent_hint_ % extents_per_meta_) >= BITMAP_SIZE) {
+		free_extent_hint_++;
 	}
+	uint32_t extent_id = free_extent_hint_;
 	// create a new extent
-	BitmapPage<PAGE_SIZE>* bitmap = new BitmapPage<PAGE_SIZE>();
+	if (extent_id == num_extents_) AddExtent();
+	BitmapPage<PAGE_SIZE>* bitmap = GetBitmap(extent_id);
 	uint32_t page_offset = 0;
-	ASSERT(bitmap->AllocatePage(page_offset), "Allocate page failed.");
-	WritePhysicalPage(meta_page->GetExtentNums() * (BITMAP_SIZE + 1) + 1, reinterpret_cast<char*>(bitmap));
-	meta_page->num_allocated_pages_++;
-	meta_page->extent_used_page_[meta_page->num_extents_++]++;
-	return (meta_page->num_extents_ - 1) * BITMAP_SIZE + page_offset;
+	bool allocated = bitmap->AllocatePage(page_offset);
+	ASSERT(allocated, "Allocate page failed.");
+	bitmap_dirty_[extent_id] = true;
+	UpdateExtentUsedPage(extent_id, 1);
+	return extent_id * BITMAP_SIZE + page_offset;
+}
+
+page_id_t DiskManager::AllocatePageRun(uint32_t n) {
+	std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+	if (n == 0 || n > BITMAP_SIZE || num_allocated_pages_ + n > static_cast<uint32_t>(MAX_VALID_PAGE_ID)) {
+		return INVALID_PAGE_ID;
+	}
+	uint32_t page_offset = 0;
+	uint32_t extent_id = free_extent_hint_;
+	for (;; extent_id++) {
+		if (extent_id == num_extents_) {
+			// create a new extent, the run always fits into it
+			if (extent_id >= MAX_VALID_PAGE_ID / BITMAP_SIZE) return INVALID_PAGE_ID;
+			AddExtent();
+		}
+		if (GetMeta(extent_id)->GetExtentUsedPage(extent_id % extents_per_meta_) + n > BITMAP_SIZE) continue;
+		if (GetBitmap(extent_id)->AllocateRun(n, page_offset)) break;
+	}
+	bitmap_dirty_[extent_id] = true;
+	UpdateExtentUsedPage(extent_id, static_cast<int32_t>(n));
+	page_id_t start = extent_id * BITMAP_SIZE + page_offset;
+	// physical pages of one extent are adjacent
+	size_t offset = MapPageId(start) * PAGE_SIZE;
+	size_t len = static_cast<size_t>(n) * PAGE_SIZE;
+	if (offset + len > file_size_.load(std::memory_order_acquire)) {
+		if (posix_fallocate(db_fd_, offset, len) == 0) {
+			ExtendFileSize(offset + len);
+		} else {
+			LOG(WARNING) << "fallocate failed, the file grows on write";
+		}
+	}
+	return start;
 }
 
 /**
  * TODO: Student Implement (finished)
  */
 void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
-    ASSERT(logical_page_id >= 0, "Invalid page id.");
-	DiskFileMetaPage* meta_page = reinterpret_cast<DiskFileMetaPage*>(meta_data_);
-	BitmapPage<PAGE_SIZE>* bitmap = new BitmapPage<PAGE_SIZE>();
-	ReadPhysicalPage(logical_page_id / BITMAP_SIZE * (BITMAP_SIZE + 1) + 1, reinterpret_cast<char*>(bitmap));
-	if (bitmap->DeAllocatePage(logical_page_id % BITMAP_SIZE)) {
-		WritePhysicalPage(logical_page_id / BITMAP_SIZE * (BITMAP_SIZE + 1) + 1, reinterpret_cast<char*>(bitmap));
-		meta_page->num_allocated_pages_--;
-		meta_page->extent_used_page_[logical_page_id / BITMAP_SIZE]--;
+	ASSERT(logical_page_id >= 0, "Invalid page id.");
+	std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+	uint32_t extent_id = logical_page_id / BITMAP_SIZE;
+	if (extent_id < num_extents_ && GetBitmap(extent_id)->DeAllocatePage(logical_page_id % BITMAP_SIZE)) {
+		bitmap_dirty_[extent_id] = true;
+		UpdateExtentUsedPage(extent_id, -1);
+		if (extent_id < free_extent_hint_) free_extent_hint_ = extent_id;
 	} else {
 		LOG(ERROR) << "DeAllocate page failed" << std::endl;
 	}
@@ -97,60 +200,188 @@ void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
  */
 bool DiskManager::IsPageFree(page_id_t logical_page_id) {
 	ASSERT(logical_page_id >= 0, "Invalid page id.");
-	DiskFileMetaPage* meta_page = reinterpret_cast<DiskFileMetaPage*>(meta_data_);
-	BitmapPage<PAGE_SIZE>* bitmap = new BitmapPage<PAGE_SIZE>();
-    ReadPhysicalPage(logical_page_id / BITMAP_SIZE * (BITMAP_SIZE + 1) + 1, reinterpret_cast<char*>(bitmap));
-	return bitmap->IsPageFree(logical_page_id % BITMAP_SIZE);
+	std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+	uint32_t extent_id = logical_page_id / BITMAP_SIZE;
+	if (extent_id >= num_extents_) return true;
+	return GetBitmap(extent_id)->IsPageFree(logical_page_id % BITMAP_SIZE);
+}
+
+uint32_t DiskManager::GetAllocatedPages() {
+	std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+	return num_allocated_pages_;
+}
+
+uint32_t DiskManager::GetExtentNums() {
+	std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+	return num_extents_;
+}
+
+DiskFileMetaPage* DiskManager::GetMeta(uint32_t extent_id) {
+	uint32_t group = extent_id / extents_per_meta_;
+	while (group >= meta_pages_.size()) {
+		meta_pages_.emplace_back(new char[PAGE_SIZE]);
+		memset(meta_pages_.back().get(), 0, PAGE_SIZE);
+	}
+	return reinterpret_cast<DiskFileMetaPage*>(meta_pages_[group].get());
+}
+
+uint32_t DiskManager::AddExtent() {
+	uint32_t extent_id = num_extents_++;
+	GetMeta(extent_id)->num_extents_++;
+	return extent_id;
+}
+
+void DiskManager::UpdateExtentUsedPage(uint32_t extent_id, int32_t delta) {
+	DiskFileMetaPage* meta_page = GetMeta(extent_id);
+	meta_page->extent_used_page_[extent_id % extents_per_meta_] += delta;
+	meta_page->num_allocated_pages_ += delta;
+	num_allocated_pages_ += delta;
+}
+
+BitmapPage<PAGE_SIZE>* DiskManager::GetBitmap(uint32_t extent_id) {
+	if (extent_id >= bitmaps_.size()) {
+		bitmaps_.resize(extent_id + 1);
+		bitmap_dirty_.resize(extent_id + 1, false);
+	}
+	if (bitmaps_[extent_id] == nullptr) {
+		bitmaps_[extent_id].reset(new BitmapPage<PAGE_SIZE>());
+		ReadPhysicalPage(BitmapPageId(extent_id), reinterpret_cast<char*>(bitmaps_[extent_id].get()));
+	}
+	return bitmaps_[extent_id].get();
+}
+
+void DiskManager::Checkpoint() {
+	std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+	if (closed) return;
+	for (uint32_t i = 0; i < bitmaps_.size(); i++) {
+		if (!bitmap_dirty_[i]) continue;
+		WritePhysicalPage(BitmapPageId(i), reinterpret_cast<char*>(bitmaps_[i].get()));
+		bitmap_dirty_[i] = false;
+	}
+	for (uint32_t group = 0; group < meta_pages_.size(); group++) {
+		WritePhysicalPage(MetaPageId(group), meta_pages_[group].get());
+	}
+}
+
+size_t DiskManager::ShrinkFile() {
+	std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+	if (closed) return 0;
+	uint32_t keep_extents = num_extents_;
+	while (keep_extents > 0 &&
+	       GetMeta(keep_extents - 1)->GetExtentUsedPage((keep_extents - 1) % extents_per_meta_) == 0) {
+		keep_extents--;
+	}
+	size_t end = PAGE_SIZE;
+	if (keep_extents > 0) {
+		uint32_t extent_id = keep_extents - 1;
+		BitmapPage<PAGE_SIZE>* bitmap = GetBitmap(extent_id);
+		uint32_t page_offset = BITMAP_SIZE - 1;
+		while (bitmap->IsPageFree(page_offset)) page_offset--;
+		end = (MapPageId(extent_id * BITMAP_SIZE + page_offset) + 1) * PAGE_SIZE;
+	}
+	size_t size = file_size_.load(std::memory_order_acquire);
+	bool truncate = end < size;
+	if (truncate) {
+		// the meta pages on disk still list the empty extents, whose bitmaps read as zeros once they are cut off, so
+		// the file is consistent whether the truncation fails, is interrupted or succeeds
+		Checkpoint();
+		if (ftruncate(db_fd_, end) != 0) {
+			LOG(WARNING) << "ftruncate failed: " << strerror(errno);
+			return 0;
+		}
+		file_size_.store(end, std::memory_order_release);
+	}
+	while (num_extents_ > keep_extents) {
+		GetMeta(num_extents_ - 1)->num_extents_--;
+		num_extents_--;
+	}
+	if (num_extents_ < bitmaps_.size()) {
+		bitmaps_.resize(num_extents_);
+		bitmap_dirty_.resize(num_extents_);
+	}
+	// the constructor stops at the first meta page that is not full, an empty one after a full one reads as zeros
+	while (meta_pages_.size() > 1 &&
+	       reinterpret_cast<DiskFileMetaPage*>(meta_pages_.back().get())->GetExtentNums() == 0) {
+		meta_pages_.pop_back();
+	}
+	if (free_extent_hint_ > num_extents_) free_extent_hint_ = num_extents_;
+	Checkpoint();
+	return truncate ? size - end : 0;
 }
 
 /**
  * TODO: Student Implement (finished)
  * physical: 0 1 2 3 4 5 6 7 ...
  * logical:  / / 0 1 2 / 3 4 ...
+ * the data pages of an extent follow its bitmap page
  */
-page_id_t DiskManager::MapPageId(page_id_t logical_page_id) {
-    return logical_page_id / BITMAP_SIZE * (BITMAP_SIZE + 1) + logical_page_id % BITMAP_SIZE + 2;
+size_t DiskManager::MapPageId(page_id_t logical_page_id) {
+    return BitmapPageId(logical_page_id / BITMAP_SIZE) + 1 + logical_page_id % BITMAP_SIZE;
 }
 
-int DiskManager::GetFileSize(const std::string &file_name) {
+size_t DiskManager::GetFileSize() const {
     struct stat stat_buf;
-    int rc = stat(file_name.c_str(), &stat_buf);
-    return rc == 0 ? stat_buf.st_size : -1;
+    int rc = fstat(db_fd_, &stat_buf);
+    return rc == 0 ? stat_buf.st_size : 0;
 }
 
-void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
-    int offset = physical_page_id * PAGE_SIZE;
+void DiskManager::ReadPhysicalPage(size_t physical_page_id, char *page_data) {
+    size_t offset = physical_page_id * PAGE_SIZE;
     // check if read beyond file length
-    if (offset >= GetFileSize(file_name_)) {
+    if (offset >= file_size_.load(std::memory_order_acquire)) {
 		#ifdef ENABLE_BPM_DEBUG
 			LOG(INFO) << "Read less than a page" << std::endl;
 		#endif
         memset(page_data, 0, PAGE_SIZE);
-    } else {
-        // set read cursor to offset
-        db_io_.seekp(offset);
-        db_io_.read(page_data, PAGE_SIZE);
-        // if file ends before reading PAGE_SIZE
-        int read_count = db_io_.gcount();
-        if (read_count < PAGE_SIZE) {
-			#ifdef ENABLE_BPM_DEBUG
-				LOG(INFO) << "Read less than a page" << std::endl;
-			#endif
-            memset(page_data + read_count, 0, PAGE_SIZE - read_count);
-        }
+        return;
+    }
+    if (direct_io_ && !IsAligned(page_data)) {
+        char *buffer = BounceBuffer();
+        ReadPhysicalPage(physical_page_id, buffer);
+        memcpy(page_data, buffer, PAGE_SIZE);
+        return;
+    }
+    size_t read_count = 0;
+    while (read_count < PAGE_SIZE) {
+        ssize_t rc = pread(db_fd_, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+        if (rc < 0 && errno == EINTR) continue;
+        if (rc <= 0) break;
+        read_count += rc;
+    }
+    // if file ends before reading PAGE_SIZE
+    if (read_count < PAGE_SIZE) {
+		#ifdef ENABLE_BPM_DEBUG
+			LOG(INFO) << "Read less than a page" << std::endl;
+		#endif
+        memset(page_data + read_count, 0, PAGE_SIZE - read_count);
     }
 }
 
-void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
-    size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
-    // set write cursor to offset
-    db_io_.seekp(offset);
-    db_io_.write(page_data, PAGE_SIZE);
-    // check for I/O error
-    if (db_io_.bad()) {
-        LOG(ERROR) << "I/O error while writing";
+void DiskManager::WritePhysicalPage(size_t physical_page_id, const char *page_data) {
+    if (direct_io_ && !IsAligned(page_data)) {
+        char *buffer = BounceBuffer();
+        memcpy(buffer, page_data, PAGE_SIZE);
+        WritePhysicalPage(physical_page_id, buffer);
         return;
     }
-    // needs to flush to keep disk file in sync
-    db_io_.flush();
-}
\ No newline at end of file
+    size_t offset = physical_page_id * PAGE_SIZE;
+    size_t write_count = 0;
+    while (write_count < PAGE_SIZE) {
+        ssize_t rc = pwrite(db_fd_, page_data + write_count, PAGE_SIZE - write_count, offset + write_count);
+        if (rc < 0 && errno == EINTR) continue;
+        // check for I/O error
+        if (rc <= 0) {
+            LOG(ERROR) << "I/O error while writing";
+            return;
+        }
+        write_count += rc;
+    }
+    ExtendFileSize(offset + PAGE_SIZE);
+}
+
+void DiskManager::ExtendFileSize(size_t end) {
+    // concurrent writers may race to extend the cached file length, it must only grow
+    size_t size = file_size_.load(std::memory_order_relaxed);
+    while (size < end && !file_size_.compare_exchange_weak(size, end, std::memory_order_release)) {
+    }
+}
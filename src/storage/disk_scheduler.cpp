@@ -0,0 +1,212 @@
+#include "storage/disk_scheduler.h"
+
+#include <cstdlib>
+#include <unordered_set>
+
+#include "glog/logging.h"
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, size_t num_workers) : disk_manager_(disk_manager) {
+    if (num_workers == 0) num_workers = 1;
+    for (size_t i = 0; i < num_workers; i++) {
+        workers_.emplace_back(new Worker());
+    }
+}
+
+DiskScheduler::~DiskScheduler() {
+    for (auto &worker : workers_) {
+        {
+            std::scoped_lock<std::mutex> lock(worker->latch_);
+            worker->stopping_ = true;
+        }
+        worker->cv_.notify_one();
+        if (worker->thread_.joinable()) worker->thread_.join();
+    }
+}
+
+std::future<bool> DiskScheduler::Schedule(DiskRequest request) {
+    ASSERT(request.page_id_ >= 0, "Invalid page id.");
+    std::call_once(started_, &DiskScheduler::StartWorkers, this);
+    std::future<bool> future = request.callback_.get_future();
+    Worker &worker = WorkerOf(request.page_id_);
+    {
+        std::scoped_lock<std::mutex> lock(worker.latch_);
+        worker.pending_[request.page_id_]++;
+        worker.queue_.push_back(std::move(request));
+    }
+    worker.cv_.notify_one();
+    return future;
+}
+
+std::future<bool> DiskScheduler::ScheduleRead(page_id_t page_id, char *data) {
+    DiskRequest request;
+    request.is_write_ = false;
+    request.page_id_ = page_id;
+    request.data_ = data;
+    return Schedule(std::move(request));
+}
+
+std::future<bool> DiskScheduler::ScheduleWrite(page_id_t page_id, const char *data) {
+    DiskRequest request;
+    request.is_write_ = true;
+    request.page_id_ = page_id;
+    request.data_ = const_cast<char *>(data);
+    return Schedule(std::move(request));
+}
+
+std::future<bool> DiskScheduler::ScheduleWriteCopy(page_id_t page_id, const char *data) {
+    DiskRequest request;
+    request.is_write_ = true;
+    request.page_id_ = page_id;
+    // aligned, so the copy can be written with O_DIRECT without another copy
+    request.buffer_.reset(static_cast<char *>(aligned_alloc(PAGE_SIZE, PAGE_SIZE)));
+    memcpy(request.buffer_.get(), data, PAGE_SIZE);
+    request.data_ = request.buffer_.get();
+    return Schedule(std::move(request));
+}
+
+void DiskScheduler::ReadPage(page_id_t page_id, char *data) {
+    if (IsPending(page_id)) {
+        ScheduleRead(page_id, data).wait();
+    } else {
+        disk_manager_->ReadPage(page_id, data);
+    }
+}
+
+void DiskScheduler::WritePage(page_id_t page_id, const char *data) {
+    if (IsPending(page_id)) {
+        ScheduleWrite(page_id, data).wait();
+    } else {
+        disk_manager_->WritePage(page_id, data);
+    }
+}
+
+bool DiskScheduler::IsPending(page_id_t page_id) {
+    Worker &worker = WorkerOf(page_id);
+    std::scoped_lock<std::mutex> lock(worker.latch_);
+    return worker.pending_.count(page_id) != 0;
+}
+
+bool DiskScheduler::UsesIoUring() {
+#ifdef MINISQL_USE_IO_URING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void DiskScheduler::StartWorkers() {
+    for (auto &worker : workers_) {
+        worker->thread_ = std::thread(&DiskScheduler::WorkerLoop, this, std::ref(*worker));
+    }
+}
+
+void DiskScheduler::WorkerLoop(Worker &worker) {
+#ifdef MINISQL_USE_IO_URING
+    worker.ring_ready_ = io_uring_queue_init(IO_URING_QUEUE_DEPTH, &worker.ring_, 0) == 0;
+    if (!worker.ring_ready_) LOG(WARNING) << "io_uring is not available, falling back to pread/pwrite";
+#endif
+    std::vector<DiskRequest> batch;
+    std::unique_lock<std::mutex> lock(worker.latch_);
+    while (true) {
+        worker.cv_.wait(lock, [&worker]() { return worker.stopping_ || !worker.queue_.empty(); });
+        // requests scheduled before the destructor are still completed
+        if (worker.queue_.empty()) break;
+        while (!worker.queue_.empty() && batch.size() < IO_URING_QUEUE_DEPTH) {
+            batch.push_back(std::move(worker.queue_.front()));
+            worker.queue_.pop_front();
+        }
+        lock.unlock();
+        Process(worker, batch);
+        lock.lock();
+        for (auto &request : batch) {
+            auto it = worker.pending_.find(request.page_id_);
+            if (--it->second == 0) worker.pending_.erase(it);
+        }
+        batch.clear();
+    }
+#ifdef MINISQL_USE_IO_URING
+    if (worker.ring_ready_) io_uring_queue_exit(&worker.ring_);
+#endif
+}
+
+void DiskScheduler::Process(__attribute__((unused)) Worker &worker, std::vector<DiskRequest> &batch) {
+#ifdef MINISQL_USE_IO_URING
+    if (worker.ring_ready_) {
+        int fd = disk_manager_->GetFileDescriptor();
+        size_t begin = 0;
+        while (begin < batch.size()) {
+            // io_uring does not order the requests of one submission, so a page may appear only once in it
+            std::unordered_set<page_id_t> pages;
+            size_t end = begin;
+            while (end < batch.size() && pages.insert(batch[end].page_id_).second) {
+                DiskRequest &request = batch[end];
+                // O_DIRECT needs an aligned buffer, the disk manager copies through one
+                if (disk_manager_->IsDirectIO() && reinterpret_cast<uintptr_t>(request.data_) % PAGE_SIZE != 0) {
+                    pages.erase(request.page_id_);
+                    // submit the requests in front of it first, they may include the same page
+                    if (end > begin) break;
+                    if (request.is_write_) {
+                        disk_manager_->WritePage(request.page_id_, request.data_);
+                    } else {
+                        disk_manager_->ReadPage(request.page_id_, request.data_);
+                    }
+                    request.callback_.set_value(true);
+                    begin = ++end;
+                    continue;
+                }
+                struct io_uring_sqe *sqe = io_uring_get_sqe(&worker.ring_);
+                size_t offset = disk_manager_->GetPageOffset(request.page_id_);
+                if (request.is_write_) {
+                    // the checksum is stamped into a private copy, the caller's buffer is left as it is
+                    if (request.buffer_ == nullptr) {
+                        request.buffer_.reset(static_cast<char *>(aligned_alloc(PAGE_SIZE, PAGE_SIZE)));
+                        memcpy(request.buffer_.get(), request.data_, PAGE_SIZE);
+                        request.data_ = request.buffer_.get();
+                    }
+                    DiskManager::StampChecksum(request.data_);
+                    io_uring_prep_write(sqe, fd, request.data_, PAGE_SIZE, offset);
+                } else {
+                    io_uring_prep_read(sqe, fd, request.data_, PAGE_SIZE, offset);
+                }
+                io_uring_sqe_set_data(sqe, &request);
+                end++;
+            }
+            io_uring_submit(&worker.ring_);
+            for (size_t i = begin; i < end; i++) {
+                struct io_uring_cqe *cqe;
+                io_uring_wait_cqe(&worker.ring_, &cqe);
+                auto *request = static_cast<DiskRequest *>(io_uring_cqe_get_data(cqe));
+                int res = cqe->res;
+                io_uring_cqe_seen(&worker.ring_, cqe);
+                if (request->is_write_) {
+                    // retry failed or short writes synchronously
+                    if (res == PAGE_SIZE) {
+                        disk_manager_->ExtendFileSize(disk_manager_->GetPageOffset(request->page_id_) + PAGE_SIZE);
+                    } else {
+                        disk_manager_->WritePage(request->page_id_, request->data_);
+                    }
+                } else if (res < 0) {
+                    disk_manager_->ReadPage(request->page_id_, request->data_);
+                } else {
+                    if (res < PAGE_SIZE) {
+                        // the file ends inside this page
+                        memset(request->data_ + res, 0, PAGE_SIZE - res);
+                    }
+                    disk_manager_->VerifyChecksum(request->page_id_, request->data_);
+                }
+                request->callback_.set_value(true);
+            }
+            begin = end;
+        }
+        return;
+    }
+#endif
+    for (auto &request : batch) {
+        if (request.is_write_) {
+            disk_manager_->WritePage(request.page_id_, request.data_);
+        } else {
+            disk_manager_->ReadPage(request.page_id_, request.data_);
+        }
+        request.callback_.set_value(true);
+    }
+}
@@ -0,0 +1,170 @@
+#include "storage/free_space_map.h"
+
+static_assert(FreeSpaceMap::NUM_CATEGORIES <= 64, "The non empty buckets are tracked in a 64 bit mask.");
+
+page_id_t FreeSpaceMap::Create() {
+    std::scoped_lock<std::mutex> lock(latch_);
+    page_id_t page_id;
+    BasicPageGuard guard = buffer_pool_manager_->NewPageGuarded(page_id);
+    if (!guard) return INVALID_PAGE_ID;
+    guard.AsMut<FreeSpaceMapPage>()->Init();
+    map_pages_.assign(1, page_id);
+    entries_.clear();
+    entry_of_.clear();
+    for (auto &bucket : buckets_) bucket.clear();
+    non_empty_buckets_ = 0;
+    return page_id;
+}
+
+bool FreeSpaceMap::Load(page_id_t first_page_id) {
+    std::scoped_lock<std::mutex> lock(latch_);
+    map_pages_.clear();
+    entries_.clear();
+    entry_of_.clear();
+    for (auto &bucket : buckets_) bucket.clear();
+    non_empty_buckets_ = 0;
+    for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID;) {
+        if (!MayBeMapPage(page_id)) return false;
+        ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(page_id);
+        if (!guard) return false;
+        auto map_page = guard.As<FreeSpaceMapPage>();
+        if (!map_page->IsValid()) return false;
+        map_pages_.push_back(page_id);
+        for (uint32_t slot = 0; slot < map_page->GetCount(); slot++) {
+            auto index = static_cast<uint32_t>(entries_.size());
+            entries_.push_back({map_page->GetHeapPageId(slot), map_page->GetCategory(slot), 0});
+            entry_of_[map_page->GetHeapPageId(slot)] = index;
+            AddToBucket(index);
+        }
+        page_id = map_page->GetNextPageId();
+    }
+    return true;
+}
+
+page_id_t FreeSpaceMap::FindPage(uint32_t size) {
+    uint32_t category = (size + CATEGORY_SIZE - 1) / CATEGORY_SIZE;
+    if (category >= NUM_CATEGORIES) return INVALID_PAGE_ID;
+    std::scoped_lock<std::mutex> lock(latch_);
+    uint64_t candidates = non_empty_buckets_ & (~0ULL << category);
+    if (candidates == 0) return INVALID_PAGE_ID;
+    // the smallest category with enough room, which keeps the pages with the most room for large tuples
+    return entries_[buckets_[__builtin_ctzll(candidates)].back()].heap_page_id_;
+}
+
+void FreeSpaceMap::Update(page_id_t heap_page_id, uint32_t free_space) {
+    uint8_t category = CategoryOf(free_space);
+    std::scoped_lock<std::mutex> lock(latch_);
+    auto it = entry_of_.find(heap_page_id);
+    if (it != entry_of_.end()) {
+        uint32_t index = it->second;
+        if (entries_[index].category_ == category) return;
+        RemoveFromBucket(index);
+        entries_[index].category_ = category;
+        AddToBucket(index);
+        WriteEntry(index, false);
+        return;
+    }
+    if (map_pages_.empty()) return;
+    auto index = static_cast<uint32_t>(entries_.size());
+    if (index == map_pages_.size() * FreeSpaceMapPage::CAPACITY) {
+        // the last map page is full, continue the chain
+        page_id_t page_id;
+        BasicPageGuard guard = buffer_pool_manager_->NewPageGuarded(page_id);
+        if (!guard) return;
+        guard.AsMut<FreeSpaceMapPage>()->Init();
+        WritePageGuard prev_guard = buffer_pool_manager_->FetchPageWrite(map_pages_.back());
+        if (!prev_guard) {
+            guard.Drop();
+            buffer_pool_manager_->DeletePage(page_id);
+            return;
+        }
+        prev_guard.AsMut<FreeSpaceMapPage>()->SetNextPageId(page_id);
+        map_pages_.push_back(page_id);
+    }
+    entries_.push_back({heap_page_id, category, 0});
+    entry_of_[heap_page_id] = index;
+    AddToBucket(index);
+    WriteEntry(index, true);
+}
+
+void FreeSpaceMap::Remove(page_id_t heap_page_id) {
+    std::scoped_lock<std::mutex> lock(latch_);
+    auto it = entry_of_.find(heap_page_id);
+    if (it == entry_of_.end()) return;
+    uint32_t index = it->second;
+    auto last = static_cast<uint32_t>(entries_.size() - 1);
+    RemoveFromBucket(index);
+    entry_of_.erase(it);
+    if (index != last) {
+        // the last entry takes the freed slot, so the entries stay dense
+        entries_[index] = entries_[last];
+        buckets_[entries_[index].category_][entries_[index].bucket_pos_] = index;
+        entry_of_[entries_[index].heap_page_id_] = index;
+        WriteEntry(index, false);
+    }
+    entries_.pop_back();
+    uint32_t page_index = last / FreeSpaceMapPage::CAPACITY;
+    uint32_t count = last % FreeSpaceMapPage::CAPACITY;
+    if (count == 0 && page_index > 0) {
+        // the last map page is empty now
+        WritePageGuard prev_guard = buffer_pool_manager_->FetchPageWrite(map_pages_[page_index - 1]);
+        if (!prev_guard) return;
+        prev_guard.AsMut<FreeSpaceMapPage>()->SetNextPageId(INVALID_PAGE_ID);
+        prev_guard.Drop();
+        buffer_pool_manager_->DeletePage(map_pages_[page_index]);
+        map_pages_.pop_back();
+        return;
+    }
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(map_pages_[page_index]);
+    if (guard) guard.AsMut<FreeSpaceMapPage>()->SetCount(count);
+}
+
+void FreeSpaceMap::Destroy(page_id_t first_page_id) {
+    std::scoped_lock<std::mutex> lock(latch_);
+    for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID;) {
+        if (!MayBeMapPage(page_id)) break;
+        ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(page_id);
+        if (!guard || !guard.As<FreeSpaceMapPage>()->IsValid()) break;
+        page_id_t next_page_id = guard.As<FreeSpaceMapPage>()->GetNextPageId();
+        guard.Drop();
+        buffer_pool_manager_->DeletePage(page_id);
+        page_id = next_page_id;
+    }
+    map_pages_.clear();
+    entries_.clear();
+    entry_of_.clear();
+    for (auto &bucket : buckets_) bucket.clear();
+    non_empty_buckets_ = 0;
+}
+
+size_t FreeSpaceMap::GetPageCount() {
+    std::scoped_lock<std::mutex> lock(latch_);
+    return entries_.size();
+}
+
+void FreeSpaceMap::AddToBucket(uint32_t index) {
+    Entry &entry = entries_[index];
+    auto &bucket = buckets_[entry.category_];
+    entry.bucket_pos_ = static_cast<uint32_t>(bucket.size());
+    bucket.push_back(index);
+    non_empty_buckets_ |= 1ULL << entry.category_;
+}
+
+void FreeSpaceMap::RemoveFromBucket(uint32_t index) {
+    Entry &entry = entries_[index];
+    auto &bucket = buckets_[entry.category_];
+    uint32_t moved = bucket.back();
+    bucket[entry.bucket_pos_] = moved;
+    entries_[moved].bucket_pos_ = entry.bucket_pos_;
+    bucket.pop_back();
+    if (bucket.empty()) non_empty_buckets_ &= ~(1ULL << entry.category_);
+}
+
+void FreeSpaceMap::WriteEntry(uint32_t index, bool add) {
+    uint32_t slot = index % FreeSpaceMapPage::CAPACITY;
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(map_pages_[index / FreeSpaceMapPage::CAPACITY]);
+    if (!guard) return;
+    auto map_page = guard.AsMut<FreeSpaceMapPage>();
+    map_page->SetEntry(slot, entries_[index].heap_page_id_, entries_[index].category_);
+    if (add) map_page->SetCount(slot + 1);
+}
@@ -4,45 +4,84 @@
  * TODO: Student Implement (finished)
  */
 bool TableHeap::InsertTuple(Row &row, Txn *txn) {
-    uint32_t siz = row.GetSerializedSize(schema_);
+    uint32_t siz = row_codec_.GetSerializedSize(row);
     if (siz >= TablePage::SIZE_MAX_ROW) return false;
-    if (last_visited_page_id_ == INVALID_PAGE_ID) {
-        last_visited_page_id_ = first_page_id_;
-    }
-    page_id_t cur_pid = last_visited_page_id_, nxt_pid;
-    TablePage *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(cur_pid));
-    while (!page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)) {
-        nxt_pid = page->GetNextPageId();
-        if (nxt_pid == INVALID_PAGE_ID) {
-            auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(nxt_pid));
-            if (new_page == nullptr) return false;
-            new_page->Init(nxt_pid, cur_pid, log_manager_, txn);
-            new_page->SetNextPageId(INVALID_PAGE_ID);
-            page->SetNextPageId(nxt_pid);
-            buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
-            page = new_page;
+    LoadFreeSpaceMap();
+    WritePageGuard guard;
+    if (!InsertIntoPage(row, siz, guard, txn)) return false;
+    free_space_map_.Update(guard.PageId(), reinterpret_cast<TablePage *>(guard.GetPage())->GetFreeSpaceRemaining());
+    return true;
+}
+
+size_t TableHeap::InsertTuples(std::vector<Row> &rows, Txn *txn) {
+    LoadFreeSpaceMap();
+    // stays on one page until it is full, the map is only updated when moving on
+    WritePageGuard guard;
+    size_t inserted = 0;
+    for (auto &row : rows) {
+        uint32_t siz = row_codec_.GetSerializedSize(row);
+        if (siz >= TablePage::SIZE_MAX_ROW || !InsertIntoPage(row, siz, guard, txn)) break;
+        inserted++;
+    }
+    if (guard) {
+        auto page = reinterpret_cast<TablePage *>(guard.GetPage());
+        free_space_map_.Update(guard.PageId(), page->GetFreeSpaceRemaining());
+    }
+    return inserted;
+}
+
+bool TableHeap::InsertIntoPage(Row &row, uint32_t size, WritePageGuard &guard, Txn *txn) {
+    while (true) {
+        auto page = guard ? reinterpret_cast<TablePage *>(guard.GetPage()) : nullptr;
+        if (page != nullptr) {
+            if (page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_, &row_codec_)) {
+                guard.MarkDirty();
+                return true;
+            }
+            // also corrects a map entry that promised more room than the page has
+            free_space_map_.Update(guard.PageId(), page->GetFreeSpaceRemaining());
+        }
+        page_id_t next_page_id = free_space_map_.FindPage(TablePage::GetSpaceNeeded(size));
+        if (next_page_id != INVALID_PAGE_ID) {
+            guard.Drop();
+            guard = buffer_pool_manager_->FetchPageWrite(next_page_id);
+        } else if (page == nullptr) {
+            // no page has room, walk to the tail and append one
+            next_page_id = last_visited_page_id_ == INVALID_PAGE_ID ? first_page_id_ : last_visited_page_id_;
+            guard = buffer_pool_manager_->FetchPageWrite(next_page_id);
+        } else if (page->GetNextPageId() != INVALID_PAGE_ID) {
+            // the next page is latched before the current one is released
+            last_visited_page_id_ = page->GetNextPageId();
+            guard = buffer_pool_manager_->FetchPageWrite(last_visited_page_id_);
         } else {
-            buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-            page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(nxt_pid));
+            // append a new page while the current tail is still write latched
+            BasicPageGuard new_guard = buffer_pool_manager_->NewPageGuarded(next_page_id, &page_run_);
+            if (!new_guard) return false;
+            WritePageGuard new_write_guard = new_guard.UpgradeWrite();
+            auto new_page = reinterpret_cast<TablePage *>(new_write_guard.GetPage());
+            new_page->Init(next_page_id, guard.PageId(), log_manager_, txn);
+            new_page->SetNextPageId(INVALID_PAGE_ID);
+            new_write_guard.MarkDirty();
+            page->SetNextPageId(next_page_id);
+            guard.MarkDirty();
+            guard = std::move(new_write_guard);
+            last_visited_page_id_ = next_page_id;
         }
+        if (!guard) return false;
     }
-    last_visited_page_id_ = page->GetPageId();
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
-    return true;
 }
 
 bool TableHeap::MarkDelete(const RowId &rid, Txn *txn) {
     // Find the page which contains the tuple.
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
     // If the page could not be found, then abort the recovery.
-    if (page == nullptr) {
+    if (!guard) {
         return false;
     }
     // Otherwise, mark the tuple as deleted.
-    page->WLatch();
+    auto page = reinterpret_cast<TablePage *>(guard.GetPage());
     page->MarkDelete(rid, txn, lock_manager_, log_manager_);
-    page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+    guard.MarkDirty();
     return true;
 }
 
@@ -50,41 +89,28 @@ bool TableHeap::MarkDelete(const RowId &rid, Txn *txn) {
  * TODO: Student Implement (finished)
  */
 bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Txn *txn) {
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-    if (page == nullptr) return false;
-    Row* old_row = new Row(rid);
-    page->RLatch();
-    bool res = page->GetTuple(old_row, schema_, txn, lock_manager_);
-    page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
-    if (!res) return delete old_row, false;
-    page->WLatch();
-    int upd_res = page->UpdateTuple(row, old_row, schema_, txn, lock_manager_, log_manager_);
-    delete old_row;
+    // loading latches the first page and, on a rebuild, every page, so it must not run under a page latch
+    LoadFreeSpaceMap();
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+    if (!guard) return false;
+    auto page = reinterpret_cast<TablePage *>(guard.GetPage());
+    Row old_row(rid);
+    if (!page->GetTuple(&old_row, schema_, txn, lock_manager_, &row_codec_)) return false;
+    int upd_res = page->UpdateTuple(row, &old_row, schema_, txn, lock_manager_, log_manager_, &row_codec_);
     if (upd_res == TablePage::TUPLE_UPDATED) {
         // Successfully updated
-        page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+        guard.MarkDirty();
+        free_space_map_.Update(rid.GetPageId(), page->GetFreeSpaceRemaining());
         return true;
     }
     if (upd_res == TablePage::NOT_ENOUGH_SPACE) {
-        // Not enough space, delete and insert
-        Row* new_row = new Row(row);
-        bool insert_res = InsertTuple(*new_row, txn);
-        delete new_row;
-        if (!insert_res) {
-            page->WUnlatch();
-            buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
-            return false;
-        }
-        page->MarkDelete(rid, txn, lock_manager_, log_manager_);
-        page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
-        return true;
+        // Not enough space, delete and insert. InsertTuple may walk into this page, so release it first.
+        guard.Drop();
+        Row new_row(row);
+        if (!InsertTuple(new_row, txn)) return false;
+        return MarkDelete(rid, txn);
     }
     // Invalid slot number or tuple is deleted
-    page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
     return false;
 }
 
@@ -94,79 +120,194 @@ bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Txn *txn) {
 void TableHeap::ApplyDelete(const RowId &rid, Txn *txn) {
     // Step1: Find the page which contains the tuple.
     // Step2: Delete the tuple from the page.
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-    assert(page != nullptr);
-    page->WLatch();
+    LoadFreeSpaceMap();
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+    assert(guard.IsValid());
+    auto page = reinterpret_cast<TablePage *>(guard.GetPage());
     page->ApplyDelete(rid, txn, log_manager_);
-    page->WUnlatch();
-    last_visited_page_id_ = INVALID_PAGE_ID;
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+    guard.MarkDirty();
+    // the freed space is found through the free space map, the tail hint stays valid
+    free_space_map_.Update(rid.GetPageId(), page->GetFreeSpaceRemaining());
 }
 
 void TableHeap::RollbackDelete(const RowId &rid, Txn *txn) {
     // Find the page which contains the tuple.
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-    assert(page != nullptr);
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+    assert(guard.IsValid());
     // Rollback to delete.
-    page->WLatch();
-    page->RollbackDelete(rid, txn, log_manager_);
-    page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+    reinterpret_cast<TablePage *>(guard.GetPage())->RollbackDelete(rid, txn, log_manager_);
+    guard.MarkDirty();
 }
 
 /**
  * TODO: Student Implement (finished)
  */
 bool TableHeap::GetTuple(Row *row, Txn *txn) {
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(row->GetRowId().GetPageId()));
-    if (page == nullptr) return false;
-    page->RLatch();
-    bool res = page->GetTuple(row, schema_, txn, lock_manager_);
-    page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(row->GetRowId().GetPageId(), false);
-    return res;
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(row->GetRowId().GetPageId());
+    if (!guard) return false;
+    return reinterpret_cast<TablePage *>(guard.GetPage())->GetTuple(row, schema_, txn, lock_manager_, &row_codec_);
 }
 
 void TableHeap::DeleteTable(page_id_t page_id) {
-    if (page_id != INVALID_PAGE_ID) {
-        auto temp_table_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));  // 删除table_heap
-        if (temp_table_page->GetNextPageId() != INVALID_PAGE_ID)
-        DeleteTable(temp_table_page->GetNextPageId());
-        buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->ReleasePageRun(page_run_);
+    if (page_id == INVALID_PAGE_ID) page_id = first_page_id_;
+    if (page_id == first_page_id_) {
+        ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(first_page_id_);
+        if (guard) {
+            page_id_t map_page_id = reinterpret_cast<TablePage *>(guard.GetPage())->GetFreeSpaceMapPageId();
+            guard.Drop();
+            free_space_map_.Destroy(map_page_id);
+        }
+    }
+    while (page_id != INVALID_PAGE_ID) {
+        BasicPageGuard guard = buffer_pool_manager_->FetchPageBasic(page_id);
+        if (!guard) return;
+        page_id_t next_page_id = reinterpret_cast<TablePage *>(guard.GetPage())->GetNextPageId();
+        guard.Drop();
         buffer_pool_manager_->DeletePage(page_id);
-    } else {
-        DeleteTable(first_page_id_);
+        page_id = next_page_id;
     }
 }
 
+bool TableHeap::VacuumStep(VacuumCursor &cursor, const MoveCallback &on_move, Txn *txn) {
+    if (!cursor.started_) {
+        LoadFreeSpaceMap();
+        uint32_t freed_pages = cursor.freed_pages_;
+        cursor = VacuumCursor();
+        cursor.freed_pages_ = freed_pages;
+        cursor.started_ = true;
+        cursor.reclaim_page_id_ = first_page_id_;
+        cursor.front_page_id_ = first_page_id_;
+    }
+    // reclaim phase, which also finds the tail of the chain
+    if (cursor.reclaim_page_id_ != INVALID_PAGE_ID) {
+        WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(cursor.reclaim_page_id_);
+        if (!guard) return false;
+        auto page = reinterpret_cast<TablePage *>(guard.GetPage());
+        if (page->ApplyMarkedDeletes(txn, log_manager_) > 0) guard.MarkDirty();
+        free_space_map_.Update(cursor.reclaim_page_id_, page->GetFreeSpaceRemaining());
+        cursor.tail_page_id_ = cursor.reclaim_page_id_;
+        cursor.reclaim_page_id_ = page->GetNextPageId();
+        return true;
+    }
+    // compaction phase, the first page is never freed
+    if (cursor.tail_page_id_ == INVALID_PAGE_ID || cursor.tail_page_id_ == cursor.front_page_id_) {
+        // the rest of the reserved run would only keep the end of the file allocated
+        buffer_pool_manager_->ReleasePageRun(page_run_);
+        return false;
+    }
+    std::vector<Row> rows;
+    page_id_t prev_page_id;
+    {
+        ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(cursor.tail_page_id_);
+        if (!guard) return false;
+        auto page = reinterpret_cast<TablePage *>(guard.GetPage());
+        if (page->GetNextPageId() != INVALID_PAGE_ID) {
+            // the heap grew since the cursor found its tail, start over from the first page
+            cursor.started_ = false;
+            return true;
+        }
+        prev_page_id = page->GetPrevPageId();
+        RowId rid;
+        for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+            rows.emplace_back(rid);
+            page->GetTuple(&rows.back(), schema_, txn, lock_manager_, &row_codec_);
+        }
+    }
+    for (auto &row : rows) {
+        RowId old_rid = row.GetRowId();
+        // first fit from the front, a page that has no room for one tuple is not tried again
+        while (true) {
+            if (cursor.front_page_id_ == cursor.tail_page_id_) {
+                buffer_pool_manager_->ReleasePageRun(page_run_);
+                return false;
+            }
+            WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(cursor.front_page_id_);
+            if (!guard) return false;
+            auto page = reinterpret_cast<TablePage *>(guard.GetPage());
+            if (page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_, &row_codec_)) {
+                guard.MarkDirty();
+                free_space_map_.Update(cursor.front_page_id_, page->GetFreeSpaceRemaining());
+                break;
+            }
+            cursor.front_page_id_ = page->GetNextPageId();
+        }
+        ApplyDelete(old_rid, txn);
+        on_move(old_rid, row);
+    }
+    // the tail is empty now, it is unlinked only once it is deleted, a tail someone still pins stays in the chain
+    // and the next step tries again
+    {
+        WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(prev_page_id);
+        if (!guard) return false;
+        if (!buffer_pool_manager_->DeletePage(cursor.tail_page_id_)) return true;
+        reinterpret_cast<TablePage *>(guard.GetPage())->SetNextPageId(INVALID_PAGE_ID);
+        guard.MarkDirty();
+    }
+    free_space_map_.Remove(cursor.tail_page_id_);
+    last_visited_page_id_ = prev_page_id;
+    cursor.tail_page_id_ = prev_page_id;
+    cursor.freed_pages_++;
+    return true;
+}
+
+void TableHeap::LoadFreeSpaceMap() {
+    std::call_once(free_space_map_loaded_, [this]() {
+        WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(first_page_id_);
+        if (!guard) return;
+        auto first_page = reinterpret_cast<TablePage *>(guard.GetPage());
+        page_id_t map_page_id = first_page->GetFreeSpaceMapPageId();
+        if (map_page_id != INVALID_PAGE_ID && free_space_map_.Load(map_page_id)) return;
+        map_page_id = free_space_map_.Create();
+        if (map_page_id == INVALID_PAGE_ID) return;
+        first_page->SetFreeSpaceMapPageId(map_page_id);
+        guard.MarkDirty();
+        guard.Drop();
+        // a heap without a map, rebuild it from the chain
+        for (page_id_t page_id = first_page_id_; page_id != INVALID_PAGE_ID;) {
+            ReadPageGuard page_guard = buffer_pool_manager_->FetchPageRead(page_id);
+            if (!page_guard) return;
+            auto page = reinterpret_cast<TablePage *>(page_guard.GetPage());
+            free_space_map_.Update(page_id, page->GetFreeSpaceRemaining());
+            last_visited_page_id_ = page_id;
+            page_id = page->GetNextPageId();
+        }
+    });
+}
+
+bool TableHeap::NextBatch(TableBatch &batch, Txn *txn, const RowFilter &filter) {
+    if (!batch.started_) {
+        batch.started_ = true;
+        batch.next_page_id_ = first_page_id_;
+        ReadAhead(first_page_id_);
+    }
+    batch.size_ = 0;
+    while (batch.next_page_id_ != INVALID_PAGE_ID) {
+        ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(batch.next_page_id_);
+        if (!guard) break;
+        auto page = reinterpret_cast<TablePage *>(guard.GetPage());
+        batch.size_ = page->GetTuples(batch.rows_, schema_, txn, lock_manager_, &row_codec_, filter);
+        batch.next_page_id_ = page->GetNextPageId();
+        guard.Drop();
+        // leaving a page, keep the read-ahead window in front of the scan
+        if (batch.next_page_id_ != INVALID_PAGE_ID) ReadAhead(batch.next_page_id_);
+        if (batch.size_ > 0) return true;
+    }
+    batch.next_page_id_ = INVALID_PAGE_ID;
+    return false;
+}
+
 /**
  * TODO: Student Implement (finished)
  */
 TableIterator TableHeap::Begin(Txn *txn) {
-    RowId rid;
-    bool flag = false;
-    TablePage *page = nullptr;
-    page_id_t page_id = first_page_id_;
-    while (page_id != INVALID_PAGE_ID) {
-        page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
-        page->RLatch();
-        flag = page->GetFirstTupleRid(&rid);
-        page->RUnlatch();
-        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-        if (flag) break;
-        page_id = page->GetNextPageId();
-    }
-    if (flag) {
-        Row ret_row(rid);
-        if (rid.GetPageId() != INVALID_PAGE_ID) this->GetTuple(&ret_row, nullptr);
-        return TableIterator(new Row(ret_row), this);
-    }
-    return this->End();
+    ReadAhead(first_page_id_);
+    return TableIterator(this, RowId(first_page_id_, 0), txn);
 }
 
 /**
  * TODO: Student Implement (finished)
  */
 TableIterator TableHeap::End() {
-    return TableIterator(new Row(INVALID_ROWID), this);
+    return TableIterator(this, INVALID_ROWID, nullptr);
 }
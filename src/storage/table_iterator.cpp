@@ -6,82 +6,68 @@
 /**
  * TODO: Student Implement (finished)
  */
-// TableIterator::TableIterator(TableHeap *table_heap, RowId rid, Txn *txn) {}
 TableIterator::TableIterator() {}
 
-TableIterator::TableIterator(Row *row, TableHeap *table_heap) {
-    this->row_ = row;
-    this->table_heap_ = table_heap;
-}
-
 TableIterator::TableIterator(TableHeap *table_heap, RowId rid, Txn *txn) {
-    this->row_ = new Row(rid);
     this->table_heap_ = table_heap;
+    this->txn_ = txn;
+    if (table_heap == nullptr || rid.GetPageId() == INVALID_PAGE_ID) return;
+    batch_.started_ = true;
+    batch_.next_page_id_ = rid.GetPageId();
+    if (!table_heap_->NextBatch(batch_, txn_)) return;
+    // tuples of the page before rid are skipped, a later page starts with its first tuple
+    while (pos_ < batch_.size_ && batch_.rows_[pos_].GetRowId().GetPageId() == rid.GetPageId() &&
+           batch_.rows_[pos_].GetRowId().GetSlotNum() < rid.GetSlotNum()) {
+        pos_++;
+    }
+    if (pos_ == batch_.size_) {
+        pos_ = 0;
+        table_heap_->NextBatch(batch_, txn_);
+    }
 }
 
-TableIterator::TableIterator(const TableIterator &other) {
-    this->row_ = new Row(*other.row_);
-    this->table_heap_ = other.table_heap_;
-}
+TableIterator::TableIterator(const TableIterator &other)
+    : table_heap_(other.table_heap_), txn_(other.txn_), batch_(other.batch_), pos_(other.pos_) {}
 
 TableIterator::~TableIterator() {
-    delete this->row_;
     this->table_heap_ = nullptr;
 }
 
 bool TableIterator::operator==(const TableIterator &itr) const {
-    return this->row_->GetRowId() == itr.row_->GetRowId();
+    return this->GetRowId() == itr.GetRowId();
 }
 
 bool TableIterator::operator!=(const TableIterator &itr) const {
-    return !(this->row_->GetRowId() == itr.row_->GetRowId());
+    return !(this->GetRowId() == itr.GetRowId());
 }
 
 const Row &TableIterator::operator*() {
-    return *row_;
+    ASSERT(pos_ < batch_.size_, "Dereferencing the end iterator.");
+    return batch_.rows_[pos_];
 }
 
 Row *TableIterator::operator->() {
-    return row_;
+    ASSERT(pos_ < batch_.size_, "Dereferencing the end iterator.");
+    return &batch_.rows_[pos_];
 }
 
 TableIterator &TableIterator::operator=(const TableIterator &itr) noexcept {
-    this->row_ = new Row(*itr.row_);
+    if (this == &itr) return *this;
     this->table_heap_ = itr.table_heap_;
+    this->txn_ = itr.txn_;
+    this->batch_ = itr.batch_;
+    this->pos_ = itr.pos_;
     return *this;
 }
 
 // ++iter
 TableIterator &TableIterator::operator++() {
-    RowId rid = this->row_->GetRowId(), new_rid;
-    page_id_t page_id = rid.GetPageId();
-    if (page_id == INVALID_PAGE_ID) return this->row_->SetRowId(INVALID_ROWID), *this;
-    auto page = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(page_id));
-    page->RLatch();
-    if (page->GetNextTupleRid(rid, &new_rid)) {
-        page->RUnlatch();
-        this->row_->SetRowId(new_rid);
-        table_heap_->GetTuple(this->row_, nullptr);
-        table_heap_->buffer_pool_manager_->UnpinPage(page_id, false);
-        return *this;
-    }
-    page_id_t next_page_id = page->GetNextPageId();
-    while (next_page_id != INVALID_PAGE_ID) {
-        page->RUnlatch();
-        page = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(next_page_id));
-        page->RLatch();
-        if (page->GetFirstTupleRid(&new_rid)) {
-            page->RUnlatch();
-            this->row_->SetRowId(new_rid);
-            table_heap_->GetTuple(this->row_, nullptr);
-            table_heap_->buffer_pool_manager_->UnpinPage(next_page_id, false);
-            return *this;
-        }
-        next_page_id = page->GetNextPageId();
-        table_heap_->buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-    }
-    page->RUnlatch();
-    this->row_->SetRowId(INVALID_ROWID);
+    // the end iterator stays at the end
+    if (pos_ >= batch_.size_) return *this;
+    if (++pos_ < batch_.size_) return *this;
+    // the page is used up, read the next one with tuples
+    pos_ = 0;
+    table_heap_->NextBatch(batch_, txn_);
     return *this;
 }
 
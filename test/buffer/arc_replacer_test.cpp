@@ -0,0 +1,49 @@
+#include "buffer/arc_replacer.h"
+
+#include "gtest/gtest.h"
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer arc_replacer(4);
+
+  // Scenario: load pages 10..13 into frames 0..3 and release them. All of them sit in T1.
+  for (int i = 0; i < 4; i++) {
+    arc_replacer.Admit(i, 10 + i);
+    arc_replacer.Pin(i);
+    arc_replacer.Unpin(i);
+  }
+  EXPECT_EQ(4, arc_replacer.Size());
+
+  // Scenario: a second reference to page 11 promotes frame 1 to T2.
+  arc_replacer.Pin(1);
+  EXPECT_EQ(3, arc_replacer.Size());
+  arc_replacer.Unpin(1);
+
+  // Scenario: T1 is above its target (0), so its LRU frame goes first and page 10 becomes a ghost in B1.
+  int value;
+  ASSERT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  EXPECT_EQ(0, arc_replacer.GetGhostHitCount());
+
+  // Scenario: reloading page 10 is a ghost hit. T1 target grows and the page goes straight to T2.
+  arc_replacer.Admit(0, 10);
+  arc_replacer.Pin(0);
+  EXPECT_EQ(1, arc_replacer.GetGhostHitCount());
+  EXPECT_EQ(1, arc_replacer.GetTarget());
+  arc_replacer.Unpin(0);
+
+  // Scenario: pinned frames are never victimized.
+  arc_replacer.Pin(2);
+  arc_replacer.Pin(3);
+  ASSERT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  EXPECT_EQ(0, arc_replacer.Size());
+  EXPECT_FALSE(arc_replacer.Victim(&value));
+
+  // Scenario: page 11 was evicted from T2, reloading it is a B2 ghost hit and shrinks the target again.
+  arc_replacer.Admit(1, 11);
+  arc_replacer.Pin(1);
+  EXPECT_EQ(2, arc_replacer.GetGhostHitCount());
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+}
@@ -0,0 +1,89 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+/**
+ * Every thread creates its own pages and stamps them with their page id, then all threads fetch random pages and
+ * check the stamp. The pool is smaller than the working set, so fetches race with evictions and write-backs.
+ * @return the number of buffer pool operations per second
+ */
+static double RunConcurrentWorkload(size_t num_shards, size_t num_threads) {
+	const std::string db_name = "bpm_concurrent_test.db";
+	const size_t buffer_pool_size = 64;
+	const int pages_per_thread = 64;
+	const int fetches_per_thread = 4000;
+
+	remove(db_name.c_str());
+	auto* disk_manager = new DiskManager(db_name);
+	auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager, num_shards);
+
+	std::vector<std::vector<page_id_t>> thread_pages(num_threads);
+	std::atomic<size_t> ops{0};
+	std::atomic<size_t> mismatches{0};
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < num_threads; t++) {
+		threads.emplace_back([&, t]() {
+			for (int i = 0; i < pages_per_thread; i++) {
+				page_id_t page_id;
+				Page* page = bpm->NewPage(page_id);
+				if (page == nullptr) continue;
+				page->WLatch();
+				*reinterpret_cast<page_id_t*>(page->GetData() + PAGE_SIZE / 2) = page_id;
+				page->WUnlatch();
+				bpm->UnpinPage(page_id, true);
+				thread_pages[t].push_back(page_id);
+				ops++;
+			}
+		});
+	}
+	for (auto& thread : threads) thread.join();
+	threads.clear();
+
+	std::vector<page_id_t> all_pages;
+	for (auto& pages : thread_pages) all_pages.insert(all_pages.end(), pages.begin(), pages.end());
+	EXPECT_EQ(num_threads * pages_per_thread, all_pages.size());
+
+	for (size_t t = 0; t < num_threads; t++) {
+		threads.emplace_back([&, t]() {
+			std::mt19937 rng(t);
+			std::uniform_int_distribution<size_t> dist(0, all_pages.size() - 1);
+			for (int i = 0; i < fetches_per_thread; i++) {
+				page_id_t page_id = all_pages[dist(rng)];
+				Page* page = bpm->FetchPage(page_id);
+				if (page == nullptr) continue;
+				page->RLatch();
+				if (*reinterpret_cast<page_id_t*>(page->GetData() + PAGE_SIZE / 2) != page_id) mismatches++;
+				page->RUnlatch();
+				bpm->UnpinPage(page_id, false);
+				ops++;
+			}
+		});
+	}
+	for (auto& thread : threads) thread.join();
+	auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	EXPECT_EQ(0, mismatches.load());
+	EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+	delete bpm;
+	disk_manager->Close();
+	delete disk_manager;
+	remove(db_name.c_str());
+	return ops.load() / elapsed;
+}
+
+TEST(BufferPoolManagerConcurrentTest, ShardedStressTest) {
+	const size_t num_threads = 8;
+	double single = RunConcurrentWorkload(1, num_threads);
+	double sharded = RunConcurrentWorkload(8, num_threads);
+	printf("[ BPM      ] %zu threads, 1 shard: %.0f ops/s, 8 shards: %.0f ops/s\n", num_threads, single, sharded);
+}
@@ -3,6 +3,7 @@
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>
 
 #include "gtest/gtest.h"
 
@@ -33,7 +34,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
 
 	// Insert terminal characters both in the middle and at end
 	random_binary_data[PAGE_SIZE / 2] = '\0';
-	random_binary_data[PAGE_SIZE - 1] = '\0';
+	random_binary_data[PAGE_USABLE_SIZE - 1] = '\0';
 
 	// Scenario: Once we have a page, we should be able to read and write content.
 	std::memcpy(page0->GetData(), random_binary_data, PAGE_SIZE);
@@ -62,7 +63,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
 	}
 	// Scenario: We should be able to fetch the data we wrote a while ago.
 	page0 = bpm->FetchPage(0);
-	EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, PAGE_SIZE));
+	EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, PAGE_USABLE_SIZE));
 	EXPECT_EQ(true, bpm->UnpinPage(0, true));
 
 	// Shutdown the disk manager and remove the temporary file we created.
@@ -71,4 +72,151 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
 
 	delete bpm;
 	delete disk_manager;
-}
\ No newline at end of file
+}
+TEST(BufferPoolManagerTest, DirectIOTest) {
+	const std::string db_name = "bpm_direct_io_test.db";
+	const size_t buffer_pool_size = 4;
+
+	remove(db_name.c_str());
+	// falls back to buffered I/O if the file system has no O_DIRECT, the data path is the same otherwise
+	auto* disk_manager = new DiskManager(db_name, true);
+	auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+	// Scenario: every frame is carved from the aligned arena and starts zeroed.
+	page_id_t page_ids[buffer_pool_size * 2];
+	for (size_t i = 0; i < buffer_pool_size; i++) {
+		auto* page = bpm->NewPage(page_ids[i]);
+		ASSERT_NE(nullptr, page);
+		EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % PAGE_SIZE);
+		for (int j = 0; j < PAGE_SIZE; j++) {
+			ASSERT_EQ(0, page->GetData()[j]);
+		}
+		memset(page->GetData(), 'a' + i, PAGE_SIZE);
+		bpm->UnpinPage(page_ids[i], true);
+	}
+
+	// Scenario: pages evicted through aligned frames and victim copies are read back.
+	for (size_t i = buffer_pool_size; i < buffer_pool_size * 2; i++) {
+		auto* page = bpm->NewPage(page_ids[i]);
+		ASSERT_NE(nullptr, page);
+		memset(page->GetData(), 'a' + i, PAGE_SIZE);
+		bpm->UnpinPage(page_ids[i], true);
+	}
+	for (size_t i = 0; i < buffer_pool_size * 2; i++) {
+		auto* page = bpm->FetchPage(page_ids[i]);
+		ASSERT_NE(nullptr, page);
+		EXPECT_EQ(static_cast<char>('a' + i), page->GetData()[0]);
+		EXPECT_EQ(static_cast<char>('a' + i), page->GetData()[PAGE_USABLE_SIZE - 1]);
+		bpm->UnpinPage(page_ids[i], false);
+	}
+
+	delete bpm;
+	disk_manager->Close();
+	delete disk_manager;
+	remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, BackgroundFlusherTest) {
+	const std::string db_name = "bpm_flusher_test.db";
+	const size_t buffer_pool_size = 16;
+
+	remove(db_name.c_str());
+	auto* disk_manager = new DiskManager(db_name);
+	auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 2);
+
+	// Scenario: fill the pool with dirty pages and keep the first four pinned.
+	page_id_t page_id_temp;
+	for (size_t i = 0; i < buffer_pool_size; ++i) {
+		Page* page = bpm->NewPage(page_id_temp);
+		ASSERT_NE(nullptr, page);
+		snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+		if (i >= 4) {
+			EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+		}
+	}
+
+	// Scenario: with a target ratio of 1 the writer cleans every unpinned frame, but leaves pinned ones alone.
+	bpm->StartBackgroundFlusher(1.0, 1);
+	for (int retry = 0; retry < 1000 && bpm->GetBackgroundFlushCount() < buffer_pool_size - 4; ++retry) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	bpm->StopBackgroundFlusher();
+	EXPECT_EQ(buffer_pool_size - 4, bpm->GetBackgroundFlushCount());
+	for (size_t i = 4; i < buffer_pool_size; ++i) {
+		Page* page = bpm->FetchPage(i);
+		ASSERT_NE(nullptr, page);
+		EXPECT_FALSE(page->IsDirty());
+		EXPECT_TRUE(bpm->UnpinPage(i, false));
+	}
+
+	// Scenario: the cleaned frames can be reused without losing their content.
+	for (size_t i = 0; i < 4; ++i) {
+		EXPECT_TRUE(bpm->UnpinPage(i, false));
+	}
+	for (size_t i = 0; i < buffer_pool_size; ++i) {
+		EXPECT_NE(nullptr, bpm->NewPage(page_id_temp));
+		EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+	}
+	for (size_t i = 4; i < buffer_pool_size; ++i) {
+		Page* page = bpm->FetchPage(i);
+		ASSERT_NE(nullptr, page);
+		EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+		EXPECT_TRUE(bpm->UnpinPage(i, false));
+	}
+
+	delete bpm;
+	disk_manager->Close();
+	delete disk_manager;
+	remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, PrefetchTest) {
+	const std::string db_name = "bpm_prefetch_test.db";
+	const size_t buffer_pool_size = 32;
+	const page_id_t num_pages = 24;
+
+	remove(db_name.c_str());
+	auto* disk_manager = new DiskManager(db_name);
+	auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+	// Scenario: build a chain that runs backwards, page i links to page i - 1.
+	page_id_t page_id_temp;
+	for (page_id_t i = 0; i < num_pages; ++i) {
+		Page* page = bpm->NewPage(page_id_temp);
+		ASSERT_NE(nullptr, page);
+		*reinterpret_cast<page_id_t*>(page->GetData()) = page_id_temp - 1;
+		EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+	}
+	delete bpm;
+
+	// Scenario: read ahead 8 pages of the chain into a cold pool, then fetch them without any disk read.
+	bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+	auto next_page = [](const char* page_data) { return *reinterpret_cast<const page_id_t*>(page_data); };
+	bpm->PrefetchPages(num_pages - 1, 8, next_page);
+	for (int retry = 0; retry < 1000 && bpm->GetPrefetchCount() < 8; ++retry) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	EXPECT_EQ(8, bpm->GetPrefetchCount());
+	EXPECT_TRUE(bpm->CheckAllUnpinned());
+	for (page_id_t i = num_pages - 1; i >= num_pages - 8; --i) {
+		ASSERT_NE(nullptr, bpm->FetchPage(i));
+		EXPECT_TRUE(bpm->UnpinPage(i, false));
+	}
+	EXPECT_EQ(8, bpm->GetHitCount());
+	EXPECT_EQ(0, bpm->GetMissCount());
+
+	// Scenario: without a chain function pages are read ahead in id order and free pages stop the read-ahead.
+	bpm->PrefetchPages(0, 100);
+	for (int retry = 0; retry < 1000 && bpm->GetPrefetchCount() < num_pages; ++retry) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	EXPECT_EQ(num_pages, bpm->GetPrefetchCount());
+	ASSERT_NE(nullptr, bpm->FetchPage(0));
+	EXPECT_TRUE(bpm->UnpinPage(0, false));
+	EXPECT_EQ(0, bpm->GetMissCount());
+
+	delete bpm;
+	disk_manager->Close();
+	delete disk_manager;
+	remove(db_name.c_str());
+}
@@ -0,0 +1,71 @@
+#include "buffer/page_guard.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+TEST(PageGuardTest, SampleTest) {
+	const std::string db_name = "page_guard_test.db";
+	const size_t buffer_pool_size = 5;
+
+	remove(db_name.c_str());
+	auto* disk_manager = new DiskManager(db_name);
+	auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+	// Scenario: a guard unpins its page when it goes out of scope, and writes through AsMut mark it dirty.
+	page_id_t page_id;
+	{
+		BasicPageGuard guard = bpm->NewPageGuarded(page_id);
+		ASSERT_TRUE(guard.IsValid());
+		EXPECT_EQ(page_id, guard.PageId());
+		strcpy(guard.AsMut<char>(), "hello");
+		EXPECT_FALSE(bpm->CheckAllUnpinned());
+	}
+	EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+	// Scenario: moving a guard transfers the pin instead of duplicating it.
+	{
+		BasicPageGuard guard = bpm->FetchPageBasic(page_id);
+		BasicPageGuard moved = std::move(guard);
+		EXPECT_FALSE(guard.IsValid());
+		EXPECT_EQ(INVALID_PAGE_ID, guard.PageId());
+		EXPECT_STREQ("hello", moved.As<char>());
+		moved.Drop();
+		EXPECT_FALSE(moved.IsValid());
+		EXPECT_TRUE(bpm->CheckAllUnpinned());
+	}
+
+	// Scenario: read guards share the latch, a write guard can take it once they are dropped.
+	{
+		ReadPageGuard reader1 = bpm->FetchPageRead(page_id);
+		ReadPageGuard reader2 = bpm->FetchPageRead(page_id);
+		EXPECT_STREQ("hello", reader1.As<char>());
+		EXPECT_STREQ("hello", reader2.As<char>());
+	}
+	{
+		WritePageGuard writer = bpm->FetchPageWrite(page_id);
+		strcpy(writer.AsMut<char>(), "world");
+	}
+	EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+	// Scenario: the dirty flag survives eviction, so the content is read back from disk.
+	for (size_t i = 0; i < buffer_pool_size; i++) {
+		page_id_t temp;
+		EXPECT_TRUE(bpm->NewPageGuarded(temp).IsValid());
+	}
+	{
+		BasicPageGuard guard = bpm->FetchPageBasic(page_id);
+		ReadPageGuard reader = guard.UpgradeRead();
+		EXPECT_FALSE(guard.IsValid());
+		EXPECT_STREQ("world", reader.As<char>());
+	}
+	EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+	delete bpm;
+	disk_manager->Close();
+	delete disk_manager;
+	remove(db_name.c_str());
+}
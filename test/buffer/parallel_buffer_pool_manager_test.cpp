@@ -0,0 +1,125 @@
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <cstdio>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+/** A pool that owns no frames, as the base of a ParallelBufferPoolManager is. */
+class FramelessBufferPoolManager : public BufferPoolManager {
+	public:
+	explicit FramelessBufferPoolManager(DiskManager* disk_manager) : BufferPoolManager(disk_manager) {}
+};
+
+}  // namespace
+
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+	const std::string db_name = "parallel_bpm_test.db";
+	const size_t num_instances = 4;
+	const size_t buffer_pool_size = 16;
+
+	remove(db_name.c_str());
+	auto* disk_manager = new DiskManager(db_name);
+	BufferPoolManager* bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+	EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+
+	// Scenario: new pages are spread over all instances, so the whole pool can be filled.
+	page_id_t page_id_temp;
+	for (size_t i = 0; i < buffer_pool_size; ++i) {
+		Page* page = bpm->NewPage(page_id_temp);
+		ASSERT_NE(nullptr, page);
+		EXPECT_EQ(i, page_id_temp);
+		snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+	}
+
+	// Scenario: once every instance is full, no new page can be created and no page id is leaked.
+	EXPECT_EQ(nullptr, bpm->NewPage(page_id_temp));
+	EXPECT_TRUE(bpm->IsPageFree(buffer_pool_size));
+
+	// Scenario: freeing a frame in one instance only helps the page ids routed to that instance.
+	EXPECT_TRUE(bpm->UnpinPage(0, true));
+	ASSERT_NE(nullptr, bpm->NewPage(page_id_temp));
+	EXPECT_EQ(buffer_pool_size, page_id_temp);
+	EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+
+	// Scenario: pages evicted from one instance are read back with their content.
+	for (size_t i = 1; i < buffer_pool_size; ++i) {
+		EXPECT_TRUE(bpm->UnpinPage(i, true));
+	}
+	for (size_t i = 0; i < buffer_pool_size; ++i) {
+		Page* page = bpm->FetchPage(i);
+		ASSERT_NE(nullptr, page);
+		EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+		EXPECT_TRUE(bpm->UnpinPage(i, false));
+	}
+	EXPECT_TRUE(bpm->CheckAllUnpinned());
+	EXPECT_TRUE(bpm->DeletePage(buffer_pool_size));
+	EXPECT_TRUE(bpm->IsPageFree(buffer_pool_size));
+
+	delete bpm;
+	disk_manager->Close();
+	delete disk_manager;
+	remove(db_name.c_str());
+}
+
+TEST(ParallelBufferPoolManagerTest, NewPageFallbackTest) {
+	const std::string db_name = "parallel_bpm_fallback_test.db";
+	const size_t num_instances = 2;
+	const size_t buffer_pool_size = 4;
+
+	remove(db_name.c_str());
+	auto* disk_manager = new DiskManager(db_name);
+	BufferPoolManager* bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+	page_id_t page_id_temp;
+	for (size_t i = 0; i < buffer_pool_size; ++i) {
+		ASSERT_NE(nullptr, bpm->NewPage(page_id_temp));
+	}
+
+	// Scenario: the next page id belongs to a full instance, the page goes to the instance with a free frame.
+	EXPECT_TRUE(bpm->UnpinPage(1, false));
+	ASSERT_NE(nullptr, bpm->NewPage(page_id_temp));
+	EXPECT_EQ(buffer_pool_size + 1, page_id_temp);
+	EXPECT_TRUE(bpm->IsPageFree(buffer_pool_size));
+
+	// Scenario: every instance is full, the ids tried on the way are given back.
+	EXPECT_EQ(nullptr, bpm->NewPage(page_id_temp));
+	EXPECT_TRUE(bpm->IsPageFree(buffer_pool_size));
+	EXPECT_TRUE(bpm->IsPageFree(buffer_pool_size + 2));
+
+	for (page_id_t i : {0, 2, 3, 5}) {
+		EXPECT_TRUE(bpm->UnpinPage(i, false));
+	}
+	EXPECT_TRUE(bpm->CheckAllUnpinned());
+	delete bpm;
+	disk_manager->Close();
+	delete disk_manager;
+	remove(db_name.c_str());
+}
+
+TEST(ParallelBufferPoolManagerTest, FramelessBaseTest) {
+	const std::string db_name = "parallel_bpm_frameless_test.db";
+
+	remove(db_name.c_str());
+	auto* disk_manager = new DiskManager(db_name);
+	BufferPoolManager* bpm = new FramelessBufferPoolManager(disk_manager);
+
+	// Scenario: a pool without shards caches nothing instead of dividing by its zero shards.
+	page_id_t page_id_temp;
+	EXPECT_EQ(nullptr, bpm->NewPage(page_id_temp));
+	EXPECT_TRUE(bpm->IsPageFree(0));
+	EXPECT_EQ(nullptr, bpm->FetchPage(0));
+	EXPECT_FALSE(bpm->UnpinPage(0, false));
+	EXPECT_FALSE(bpm->FlushPage(0));
+	EXPECT_FALSE(bpm->DeletePage(0));
+	EXPECT_TRUE(bpm->CheckAllUnpinned());
+	bpm->StartBackgroundFlusher();
+	bpm->PrefetchPages(0, 4);
+	bpm->StopBackgroundFlusher();
+	EXPECT_EQ(0, bpm->GetHitCount() + bpm->GetMissCount());
+	delete bpm;
+	disk_manager->Close();
+	delete disk_manager;
+	remove(db_name.c_str());
+}
@@ -0,0 +1,72 @@
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+/**
+ * One thread runs point lookups that each touch a hot "index" page and a random cold "heap" page, while another
+ * thread repeatedly scans all heap pages in order. The pool only has room for a fraction of the heap.
+ * @return the hit rate of the whole run
+ */
+static double RunLookupWithScan(ReplacerType replacer_type, size_t* ghost_hits) {
+	const std::string db_name = "replacer_benchmark_test.db";
+	const size_t buffer_pool_size = 64;
+	const int num_hot_pages = 32;
+	const int num_cold_pages = 1024;
+	const int num_lookups = 20000;
+
+	remove(db_name.c_str());
+	auto* disk_manager = new DiskManager(db_name);
+	auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 1, replacer_type);
+	page_id_t page_id;
+	for (int i = 0; i < num_hot_pages + num_cold_pages; i++) {
+		bpm->NewPage(page_id);
+		bpm->UnpinPage(page_id, true);
+	}
+	size_t base_hits = bpm->GetHitCount(), base_misses = bpm->GetMissCount();
+
+	std::atomic<bool> done{false};
+	std::thread scanner([&]() {
+		while (!done) {
+			for (int i = num_hot_pages; i < num_hot_pages + num_cold_pages && !done; i++) {
+				if (bpm->FetchPage(i) != nullptr) bpm->UnpinPage(i, false);
+			}
+		}
+	});
+	std::mt19937 rng(0);
+	std::uniform_int_distribution<int> hot_dist(0, num_hot_pages - 1);
+	std::uniform_int_distribution<int> cold_dist(num_hot_pages, num_hot_pages + num_cold_pages - 1);
+	for (int i = 0; i < num_lookups; i++) {
+		for (page_id_t lookup : {hot_dist(rng), cold_dist(rng)}) {
+			if (bpm->FetchPage(lookup) != nullptr) bpm->UnpinPage(lookup, false);
+		}
+		if (i % 64 == 0) std::this_thread::yield();
+	}
+	done = true;
+	scanner.join();
+
+	size_t hits = bpm->GetHitCount() - base_hits, misses = bpm->GetMissCount() - base_misses;
+	*ghost_hits = bpm->GetGhostHitCount();
+	EXPECT_TRUE(bpm->CheckAllUnpinned());
+	delete bpm;
+	disk_manager->Close();
+	delete disk_manager;
+	remove(db_name.c_str());
+	return hits + misses == 0 ? 0 : static_cast<double>(hits) / (hits + misses);
+}
+
+TEST(ReplacerBenchmarkTest, LookupWithScanHitRate) {
+	const std::pair<ReplacerType, const char*> policies[] = {
+		{ReplacerType::kLRU, "LRU"}, {ReplacerType::kClock, "CLOCK"}, {ReplacerType::kLRUK, "LRU-2"},
+		{ReplacerType::kARC, "ARC"}};
+	for (auto& policy : policies) {
+		size_t ghost_hits = 0;
+		double hit_rate = RunLookupWithScan(policy.first, &ghost_hits);
+		printf("[ REPLACER ] %-6s hit rate: %.2f%%, ghost hits: %zu\n", policy.second, hit_rate * 100, ghost_hits);
+		EXPECT_GT(hit_rate, 0);
+	}
+}
@@ -0,0 +1,117 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory_resource>
+#include <numeric>
+
+#include "common/arena.h"
+#include "gtest/gtest.h"
+#include "record/row.h"
+
+/**
+ * Forwards to the heap and counts the allocations, so the allocations of an arena or of rows can be compared.
+ */
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  size_t allocations_{0};
+  size_t deallocations_{0};
+
+ protected:
+  void *do_allocate(size_t bytes, size_t alignment) override {
+    allocations_++;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+    deallocations_++;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+};
+
+TEST(ArenaTest, AllocateResetTest) {
+  CountingResource upstream;
+  {
+    Arena arena(256, &upstream);
+    // Scenario: allocations are aligned and do not overlap, blocks are only taken when one is full.
+    char *last = nullptr;
+    for (size_t alignment : {1, 2, 4, 8, 16, 1, 8}) {
+      auto p = static_cast<char *>(arena.allocate(24, alignment));
+      ASSERT_EQ(0, reinterpret_cast<uintptr_t>(p) % alignment);
+      if (last != nullptr) {
+        ASSERT_GE(p, last + 24);
+      }
+      last = p;
+    }
+    EXPECT_EQ(1, arena.GetBlockCount());
+    // Scenario: a request larger than a block gets one of its own.
+    auto large = static_cast<char *>(arena.allocate(10000, 8));
+    memset(large, 1, 10000);
+    EXPECT_EQ(2, arena.GetBlockCount());
+    EXPECT_EQ(7 * 24 + 10000, arena.GetBytesAllocated());
+    // Scenario: reset gives all blocks back, the arena can be used again.
+    arena.Reset();
+    EXPECT_EQ(upstream.allocations_, upstream.deallocations_);
+    EXPECT_EQ(0, arena.GetBlockCount());
+    std::pmr::vector<int> values(&arena);
+    for (int i = 0; i < 1000; i++) values.push_back(i);
+    EXPECT_EQ(499500, std::accumulate(values.begin(), values.end(), 0));
+  }
+  EXPECT_EQ(upstream.allocations_, upstream.deallocations_);
+}
+
+/**
+ * What the executors did per tuple: copy some fields of a row into a temporary vector, build the output row from it
+ * and copy that row. With reuse_row the output row is projected in place, as SeqScanExecutor::TupleTransfer does now.
+ * @return the number of allocations from upstream
+ */
+static size_t RunProjection(const std::vector<Row> &rows, const Schema *output_schema, bool reuse_row,
+                            double *seconds) {
+  CountingResource upstream;
+  auto start = std::chrono::steady_clock::now();
+  {
+    Row output(&upstream);
+    for (auto &row : rows) {
+      if (reuse_row) {
+        row.ProjectTo(output_schema, output);
+        continue;
+      }
+      std::pmr::vector<Field> dest_row(&upstream);
+      dest_row.reserve(2);
+      dest_row.emplace_back(*row.GetField(2));
+      dest_row.emplace_back(*row.GetField(0));
+      Row projected(dest_row, &upstream);
+      output = projected;
+    }
+  }
+  *seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(upstream.allocations_, upstream.deallocations_);
+  return upstream.allocations_;
+}
+
+TEST(ArenaTest, RowAllocationBenchmark) {
+  const int row_nums = 100000;
+  char name[] = "minisql";
+  std::vector<Row> rows;
+  rows.reserve(row_nums);
+  for (int i = 0; i < row_nums; i++) {
+    std::vector<Field> fields;
+    fields.emplace_back(TypeId::kTypeInt, i);
+    fields.emplace_back(TypeId::kTypeFloat, 1.5f * i);
+    fields.emplace_back(TypeId::kTypeChar, name, 1 + i % 7, true);
+    rows.emplace_back(fields);
+  }
+  // the name column followed by the id column
+  std::vector<Column *> columns = {new Column("name", TypeId::kTypeChar, 8, 2, true, false),
+                                   new Column("id", TypeId::kTypeInt, 0, false, false)};
+  Schema output_schema(columns);
+  double heap_seconds, reuse_seconds;
+  size_t heap_allocations = RunProjection(rows, &output_schema, false, &heap_seconds);
+  size_t reuse_allocations = RunProjection(rows, &output_schema, true, &reuse_seconds);
+  printf("rows: %d, temporaries: %zu allocations %.4f s, reused row: %zu allocations %.4f s\n", row_nums,
+         heap_allocations, heap_seconds, reuse_allocations, reuse_seconds);
+  // three temporaries per row, the reused row only grows its buffers to the largest row
+  EXPECT_GE(heap_allocations, 3 * row_nums);
+  EXPECT_LT(reuse_allocations, 16);
+}
@@ -112,6 +112,53 @@ TEST_F(ExecutorTest, SimpleRawInsertTest) {
   ASSERT_TRUE(result_set[0].GetField(2)->CompareEquals(Field(kTypeFloat, static_cast<float>(2.33))));
 }
 
+// INSERT INTO table-1 VALUES (2001, "a", 1.5), (2002, "b", 1.5), (2001, "c", 1.5), (2003, "d", 1.5);
+TEST_F(ExecutorTest, BulkInsertDuplicateKeyTest) {
+  IndexInfo *index_info;
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-id", {"id"}, GetTxn(),
+                                                                        index_info, "bptree"));
+  std::vector<std::vector<AbstractExpressionRef>> raw_values;
+  const char *names[] = {"a", "b", "c", "d"};
+  int ids[] = {2001, 2002, 2001, 2003};
+  for (int i = 0; i < 4; i++) {
+    raw_values.push_back({MakeConstantValueExpression(Field(kTypeInt, ids[i])),
+                          MakeConstantValueExpression(Field(kTypeChar, const_cast<char *>(names[i]), 1, false)),
+                          MakeConstantValueExpression(Field(kTypeFloat, 1.5f))});
+  }
+  auto value_plan = std::make_shared<ValuesPlanNode>(nullptr, raw_values);
+  auto insert_plan = std::make_shared<InsertPlanNode>(nullptr, value_plan, "table-1");
+
+  // the rows are inserted at once, the repeated key takes back itself and the rows after it
+  std::vector<Row> result_set{};
+  GetExecutionEngine()->ExecutePlan(insert_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(2, result_set.size());
+  result_set.clear();
+
+  // SELECT * FROM table-1 where id >= 2001;
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  const Schema *schema = table_info->GetSchema();
+  auto col_a = MakeColumnValueExpression(*schema, 0, "id");
+  auto const2001 = MakeConstantValueExpression(Field(kTypeInt, 2001));
+  auto predicate = MakeComparisonExpression(col_a, const2001, ">=");
+  auto scan_plan = make_shared<SeqScanPlanNode>(schema, table_info->GetTableName(), predicate);
+  GetExecutionEngine()->ExecutePlan(scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(2, result_set.size());
+
+  Fields key_fields{Field(kTypeInt, 2001)};
+  Row key(key_fields);
+  std::vector<RowId> rids;
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, rids, GetTxn()));
+  ASSERT_EQ(1, rids.size());
+  Row row(rids[0]);
+  ASSERT_TRUE(table_info->GetTableHeap()->GetTuple(&row, GetTxn()));
+  ASSERT_TRUE(row.GetField(1)->CompareEquals(Field(kTypeChar, const_cast<char *>("a"), 1, false)));
+  Fields missing_fields{Field(kTypeInt, 2003)};
+  Row missing_key(missing_fields);
+  rids.clear();
+  ASSERT_NE(DB_SUCCESS, index_info->GetIndex()->ScanKey(missing_key, rids, GetTxn()));
+}
+
 // UPDATE table-1 SET name = "minisql" where id = 500;
 TEST_F(ExecutorTest, SimpleUpdateTest) {
   // Construct a sequential scan of the table
@@ -78,4 +78,124 @@ TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
 	delete index;
 	delete bpm_;
 	delete disk_mgr_;
-}
\ No newline at end of file
+}
+
+TEST(BPlusTreeTests, MemcomparableKeyTest) {
+	std::vector<Column*> columns = { new Column("id", TypeId::kTypeInt, 0, false, false),
+									 new Column("name", TypeId::kTypeChar, 8, 1, true, false),
+									 new Column("account", TypeId::kTypeFloat, 2, true, false) };
+	TableSchema key_schema(columns);
+	ASSERT_EQ(5 + 13 + 5, KeyManager::GetMemcomparableSize(&key_schema));
+	KeyManager row_km(&key_schema, 64);
+	KeyManager mem_km(&key_schema, 32, KeyEncoding::kMemcomparable);
+	// Scenario: memcmp orders keys as their fields compare, negative numbers, -0, prefixes and '\0' in chars included.
+	char names[][3] = { "", "a", "a\0", "ab", "b", "\xff" };
+	uint32_t name_lens[] = { 0, 1, 2, 2, 1, 1 };
+	int32_t ids[] = { INT32_MIN, -7, 0, 3, INT32_MAX };
+	float accounts[] = { -1e30f, -2.5f, -0.0f, 0.0f, 1e-30f, 7.5f };
+	std::vector<GenericKey*> row_keys, mem_keys;
+	for (auto id : ids) {
+		for (size_t n = 0; n < 6; n++) {
+			for (auto account : accounts) {
+				std::vector<Field> fields;
+				fields.emplace_back(TypeId::kTypeInt, id);
+				fields.emplace_back(TypeId::kTypeChar, names[n], name_lens[n], true);
+				fields.emplace_back(TypeId::kTypeFloat, account);
+				Row key(fields);
+				row_keys.push_back(row_km.InitKey());
+				row_km.SerializeFromKey(row_keys.back(), key, &key_schema);
+				mem_keys.push_back(mem_km.InitKey());
+				mem_km.SerializeFromKey(mem_keys.back(), key, &key_schema);
+				// the key decodes to the same fields
+				Row decoded;
+				mem_km.DeserializeToKey(mem_keys.back(), decoded, &key_schema);
+				for (uint32_t i = 0; i < 3; i++) {
+					ASSERT_EQ(CmpBool::kTrue, decoded.GetField(i)->CompareEquals(fields[i]));
+				}
+			}
+		}
+	}
+	auto sign = [](int cmp) { return (cmp > 0) - (cmp < 0); };
+	for (size_t i = 0; i < row_keys.size(); i++) {
+		for (size_t j = 0; j < row_keys.size(); j++) {
+			int expected = sign(row_km.CompareKeys(row_keys[i], row_keys[j]));
+			ASSERT_EQ(expected, sign(mem_km.CompareKeys(mem_keys[i], mem_keys[j]))) << "keys " << i << " and " << j;
+		}
+	}
+	// Scenario: null sorts before any value.
+	std::vector<Field> null_fields;
+	null_fields.emplace_back(TypeId::kTypeInt);
+	null_fields.emplace_back(TypeId::kTypeChar);
+	null_fields.emplace_back(TypeId::kTypeFloat);
+	GenericKey* null_key = mem_km.InitKey();
+	mem_km.SerializeFromKey(null_key, Row(null_fields), &key_schema);
+	ASSERT_GT(0, mem_km.CompareKeys(null_key, mem_keys.front()));
+	Row decoded;
+	mem_km.DeserializeToKey(null_key, decoded, &key_schema);
+	for (uint32_t i = 0; i < 3; i++) {
+		ASSERT_TRUE(decoded.GetField(i)->IsNull());
+	}
+	free(null_key);
+	for (size_t i = 0; i < row_keys.size(); i++) {
+		free(row_keys[i]);
+		free(mem_keys[i]);
+	}
+}
+
+TEST(BPlusTreeTests, OversizedCharKeyTest) {
+	std::vector<Column*> columns = { new Column("name", TypeId::kTypeChar, 4, 0, true, false) };
+	const TableSchema table_schema(columns);
+	std::vector<uint32_t> index_key_map{ 0 };
+	auto* index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+	char names[][5] = { "ab", "abcd", "abce", "b" };
+	auto probe_row = [](const char* name) {
+		std::vector<Field> fields{ Field(TypeId::kTypeChar, const_cast<char*>(name), strlen(name), true) };
+		return Row(fields);
+	};
+	for (auto encoding : { KeyEncoding::kRow, KeyEncoding::kMemcomparable }) {
+		remove(db_name.c_str());
+		auto disk_mgr_ = new DiskManager(db_name);
+		auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+		page_id_t id;
+		ASSERT_NE(nullptr, bpm_->NewPage(id));
+		ASSERT_NE(nullptr, bpm_->NewPage(id));
+		auto* index = new BPlusTreeIndex(0, index_schema, 32, bpm_, encoding);
+		for (uint32_t i = 0; i < 4; i++) {
+			ASSERT_EQ(DB_SUCCESS, index->InsertEntry(probe_row(names[i]), RowId(1000, i), nullptr));
+		}
+		// Scenario: a string longer than CHAR(4) is rejected instead of overflowing the key slot.
+		ASSERT_EQ(DB_FAILED, index->InsertEntry(probe_row("abcde"), RowId(1000, 4), nullptr));
+		// Scenario: probing with it finds no equal key and orders it right after "abcd".
+		Row probe = probe_row("abcde");
+		auto scan = [&](const std::string& op) {
+			std::vector<RowId> ret;
+			index->ScanKey(probe, ret, nullptr, op);
+			std::vector<uint32_t> slots;
+			for (auto rid : ret) {
+				slots.push_back(rid.GetSlotNum());
+			}
+			std::sort(slots.begin(), slots.end());
+			return slots;
+		};
+		std::vector<RowId> ret;
+		ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(probe, ret, nullptr, "="));
+		ASSERT_TRUE(ret.empty());
+		ASSERT_EQ((std::vector<uint32_t>{ 2, 3 }), scan(">"));
+		ASSERT_EQ((std::vector<uint32_t>{ 2, 3 }), scan(">="));
+		ASSERT_EQ((std::vector<uint32_t>{ 0, 1 }), scan("<"));
+		ASSERT_EQ((std::vector<uint32_t>{ 0, 1 }), scan("<="));
+		ASSERT_EQ((std::vector<uint32_t>{ 0, 1, 2, 3 }), scan("<>"));
+		ASSERT_EQ(DB_KEY_NOT_FOUND, index->RemoveEntry(probe, RowId(1000, 1), nullptr));
+		// the stored keys are intact
+		for (uint32_t i = 0; i < 4; i++) {
+			ret.clear();
+			ASSERT_EQ(DB_SUCCESS, index->ScanKey(probe_row(names[i]), ret, nullptr));
+			ASSERT_EQ(1, ret.size());
+			ASSERT_EQ(i, ret[0].GetSlotNum());
+		}
+		index->Destroy();
+		delete index;
+		delete bpm_;
+		delete disk_mgr_;
+	}
+}
@@ -78,4 +78,57 @@ TEST(BPlusTreeTests, SampleTest) {
 		ASSERT_EQ(kv_map[delete_seq[i]], ans[ans.size() - 1]);
 	}
 	ASSERT_TRUE(tree.Check());
-}
\ No newline at end of file
+}
+TEST(BPlusTreeTests, FixedWidthKeyTest) {
+	DBStorageEngine engine(db_name);
+	std::vector<Column*> int_columns = { new Column("int", TypeId::kTypeInt, 0, false, false) };
+	std::vector<Column*> pair_columns = { new Column("int", TypeId::kTypeInt, 0, false, false),
+										  new Column("char", TypeId::kTypeChar, 16, 1, false, false) };
+	Schema int_schema(int_columns);
+	Schema pair_schema(pair_columns);
+	// Scenario: the single INT fast path, a fixed width memcmp and the row comparison keep the same order.
+	std::vector<KeyManager> managers = { KeyManager(&int_schema, 16, KeyEncoding::kMemcomparable),
+										 KeyManager(&pair_schema, 32, KeyEncoding::kMemcomparable),
+										 KeyManager(&pair_schema, 32) };
+	const int n = 3000;
+	char name[] = "minisql";
+	for (size_t m = 0; m < managers.size(); m++) {
+		KeyManager& KP = managers[m];
+		Schema* schema = m == 0 ? &int_schema : &pair_schema;
+		BPlusTree tree(static_cast<index_id_t>(m + 10), engine.bpm_, KP);
+		vector<GenericKey*> keys;
+		for (int i = 0; i < n; i++) {
+			// negative and positive values, their order differs from the order of their bytes
+			std::vector<Field> fields;
+			fields.emplace_back(TypeId::kTypeInt, (i - n / 2) * 7919);
+			if (m != 0) fields.emplace_back(TypeId::kTypeChar, name, static_cast<uint32_t>(i % 8), true);
+			keys.push_back(KP.InitKey());
+			KP.SerializeFromKey(keys.back(), Row(fields), schema);
+		}
+		vector<int> order(n);
+		for (int i = 0; i < n; i++) order[i] = i;
+		ShuffleArray(order);
+		for (int i : order) {
+			ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+		}
+		ASSERT_TRUE(tree.Check());
+		// the leaves hold the keys in order
+		int i = 0;
+		for (auto iter = tree.Begin(); iter != tree.End(); ++iter, ++i) {
+			ASSERT_EQ(0, KP.CompareKeys((*iter).first, keys[i]));
+			ASSERT_EQ(RowId(i), (*iter).second);
+		}
+		ASSERT_EQ(n, i);
+		for (int j = 0; j < n; j += 2) {
+			tree.Remove(keys[j]);
+		}
+		vector<RowId> ans;
+		for (int j = 0; j < n; j++) {
+			ASSERT_EQ(j % 2 == 1, tree.GetValue(keys[j], ans));
+		}
+		ASSERT_TRUE(tree.Check());
+		for (auto key : keys) {
+			free(key);
+		}
+	}
+}
@@ -0,0 +1,89 @@
+#include "page/table_page.h"
+
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+static Row MakeRow(int32_t id, const std::string &name) {
+  std::vector<Field> fields = {Field(TypeId::kTypeInt, id),
+                               Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+  return Row(fields);
+}
+
+static void CheckRow(TablePage &page, Schema *schema, const RowId &rid, int32_t id, const std::string &name) {
+  Row row(rid);
+  ASSERT_TRUE(page.GetTuple(&row, schema, nullptr, nullptr));
+  Field id_field(TypeId::kTypeInt, id);
+  Field name_field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), false);
+  EXPECT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(id_field));
+  EXPECT_EQ(CmpBool::kTrue, row.GetField(1)->CompareEquals(name_field));
+}
+
+TEST(PageTests, TablePageSlotReuseTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 256, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TablePage page;
+  memset(page.GetData(), 0, PAGE_SIZE);
+  page.Init(0, INVALID_PAGE_ID, nullptr, nullptr);
+
+  // Scenario: fill the page with rows of different sizes.
+  std::vector<RowId> rids;
+  std::vector<std::string> names;
+  for (int32_t i = 0;; i++) {
+    std::string name(1 + i % 50, 'a' + i % 26);
+    Row row = MakeRow(i, name);
+    if (!page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr)) break;
+    ASSERT_EQ(static_cast<uint32_t>(i), row.GetRowId().GetSlotNum());
+    rids.push_back(row.GetRowId());
+    names.push_back(name);
+  }
+
+  // Scenario: deleting rows leaves holes, the other rows keep their place and content.
+  uint32_t free_space = page.GetFreeSpaceRemaining();
+  for (size_t i = 1; i < rids.size(); i += 3) {
+    ASSERT_TRUE(page.MarkDelete(rids[i], nullptr, nullptr, nullptr));
+    page.ApplyDelete(rids[i], nullptr, nullptr);
+  }
+  ASSERT_GT(page.GetFreeSpaceRemaining(), free_space);
+  for (size_t i = 0; i < rids.size(); i++) {
+    if (i % 3 == 1) {
+      Row row(rids[i]);
+      ASSERT_FALSE(page.GetTuple(&row, schema.get(), nullptr, nullptr));
+    } else {
+      CheckRow(page, schema.get(), rids[i], static_cast<int32_t>(i), names[i]);
+    }
+  }
+
+  // Scenario: new rows take the freed slots, most recently freed first, and fill the holes through compaction.
+  size_t last_deleted = rids.size() - 1 - (rids.size() - 2) % 3;
+  for (size_t i = last_deleted;; i -= 3) {
+    std::string name(names[i].size(), 'z');
+    Row row = MakeRow(static_cast<int32_t>(1000 + i), name);
+    ASSERT_TRUE(page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+    ASSERT_EQ(rids[i], row.GetRowId());
+    names[i] = name;
+    if (i == 1) break;
+  }
+  for (size_t i = 0; i < rids.size(); i++) {
+    CheckRow(page, schema.get(), rids[i], static_cast<int32_t>(i % 3 == 1 ? 1000 + i : i), names[i]);
+  }
+
+  // Scenario: an update that needs the space of holes still succeeds.
+  Row old_row(rids[0]);
+  ASSERT_TRUE(page.MarkDelete(rids[2], nullptr, nullptr, nullptr));
+  page.ApplyDelete(rids[2], nullptr, nullptr);
+  uint32_t growth = page.GetFreeSpaceRemaining();
+  ASSERT_GE(growth, 10u);
+  std::string name = names[0] + std::string(growth - 10, 'y');
+  if (name.size() > 256) name.resize(256);
+  Row new_row = MakeRow(0, name);
+  ASSERT_EQ(TablePage::TUPLE_UPDATED, page.UpdateTuple(new_row, &old_row, schema.get(), nullptr, nullptr, nullptr));
+  CheckRow(page, schema.get(), rids[0], 0, name);
+  for (size_t i = 3; i < rids.size(); i++) {
+    CheckRow(page, schema.get(), rids[i], static_cast<int32_t>(i % 3 == 1 ? 1000 + i : i), names[i]);
+  }
+}
@@ -5,6 +5,7 @@
 #include "page/table_page.h"
 #include "record/field.h"
 #include "record/row.h"
+#include "record/row_codec.h"
 #include "record/schema.h"
 
 char *chars[] = {const_cast<char *>(""), const_cast<char *>("hello"), const_cast<char *>("world!"),
@@ -93,11 +94,145 @@ TEST(TupleTest, RowTest) {
   ASSERT_EQ(row.GetRowId(), first_tuple_rid);
   Row row2(row.GetRowId());
   ASSERT_TRUE(table_page.GetTuple(&row2, schema.get(), nullptr, nullptr));
-  std::vector<Field *> &row2_fields = row2.GetFields();
+  auto &row2_fields = row2.GetFields();
   ASSERT_EQ(3, row2_fields.size());
   for (size_t i = 0; i < row2_fields.size(); i++) {
-    ASSERT_EQ(CmpBool::kTrue, row2_fields[i]->CompareEquals(fields[i]));
+    ASSERT_EQ(CmpBool::kTrue, row2_fields[i].CompareEquals(fields[i]));
   }
   ASSERT_TRUE(table_page.MarkDelete(row.GetRowId(), nullptr, nullptr, nullptr));
   table_page.ApplyDelete(row.GetRowId(), nullptr, nullptr);
-}
\ No newline at end of file
+}
+TEST(TupleTest, RowViewTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 1, true, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 2, true, false),
+                                   new Column("age", TypeId::kTypeInt, 3, true, false),
+                                   new Column("city", TypeId::kTypeChar, 64, 4, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  RowLayout layout(schema.get());
+  ASSERT_EQ(3, layout.GetFixedPrefix());
+  // Scenario: no null, one null in the fixed prefix, nulls after it, all null.
+  std::vector<std::vector<Field *>> rows_values = {
+      {&int_fields[0], &float_fields[0], &char_fields[1], &int_fields[1], &char_fields[2]},
+      {&null_fields[0], &float_fields[1], &char_fields[2], &int_fields[2], &char_fields[0]},
+      {&int_fields[3], &float_fields[2], &null_fields[2], &int_fields[4], &char_fields[1]},
+      {&int_fields[4], &float_fields[3], &char_fields[3], &null_fields[0], &null_fields[2]},
+      {&null_fields[0], &null_fields[1], &null_fields[2], &null_fields[0], &null_fields[2]}};
+  char buffer[PAGE_SIZE];
+  for (auto &values : rows_values) {
+    std::vector<Field> fields;
+    for (auto value : values) {
+      fields.emplace_back(*value);
+    }
+    Row row(fields);
+    row.SerializeTo(buffer, schema.get());
+    RowView view(&layout, buffer, RowId(7, 3));
+    ASSERT_EQ(RowId(7, 3), view.GetRowId());
+    // columns read out of order, so offsets are found both from the table and by walking
+    for (uint32_t i : {4u, 2u, 0u, 3u, 1u}) {
+      ASSERT_EQ(fields[i].IsNull(), view.IsNull(i));
+      Field field = view.GetField(i);
+      ASSERT_EQ(fields[i].IsNull(), field.IsNull());
+      if (!field.IsNull()) {
+        ASSERT_EQ(CmpBool::kTrue, field.CompareEquals(fields[i]));
+      }
+    }
+    Row copy;
+    view.ToRow(&copy);
+    ASSERT_EQ(RowId(7, 3), copy.GetRowId());
+    ASSERT_EQ(fields.size(), copy.GetFieldCount());
+    for (size_t i = 0; i < fields.size(); i++) {
+      ASSERT_EQ(fields[i].IsNull(), copy.GetField(i)->IsNull());
+    }
+  }
+}
+
+TEST(TupleTest, RowCopyMoveTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, true, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("note", TypeId::kTypeChar, 64, 2, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 3, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  std::vector<Field> fields;
+  fields.emplace_back(int_fields[1]);
+  fields.emplace_back(char_fields[2]);
+  fields.emplace_back(char_fields[0]);
+  fields.emplace_back(float_fields[1]);
+  auto check = [&](const Row &row) {
+    ASSERT_EQ(fields.size(), row.GetFieldCount());
+    for (size_t i = 0; i < fields.size(); i++) {
+      ASSERT_EQ(CmpBool::kTrue, row.GetField(i)->CompareEquals(fields[i]));
+    }
+  };
+  // Scenario: a copy owns its char data, a move takes it along.
+  auto row = std::make_unique<Row>(fields);
+  Row copy(*row);
+  row.reset();
+  check(copy);
+  ASSERT_FALSE(copy.GetField(2)->IsNull());
+  ASSERT_EQ(0, copy.GetField(2)->GetLength());
+  Row moved(std::move(copy));
+  check(moved);
+  Row assigned;
+  assigned = moved;
+  check(assigned);
+  // Scenario: a row reused for deserialize takes the new values, whatever it held before.
+  char buffer[PAGE_SIZE];
+  uint32_t size = moved.SerializeTo(buffer, schema.get());
+  ASSERT_EQ(size, moved.GetSerializedSize(schema.get()));
+  std::vector<Field> null_row;
+  null_row.emplace_back(null_fields[0]);
+  null_row.emplace_back(null_fields[2]);
+  null_row.emplace_back(char_fields[1]);
+  null_row.emplace_back(null_fields[1]);
+  char null_buffer[PAGE_SIZE];
+  Row(null_row).SerializeTo(null_buffer, schema.get());
+  Row reused;
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(size, reused.DeserializeFrom(buffer, schema.get()));
+    check(reused);
+    reused.DeserializeFrom(null_buffer, schema.get());
+    ASSERT_TRUE(reused.GetField(0)->IsNull());
+    ASSERT_TRUE(reused.GetField(1)->IsNull());
+    ASSERT_EQ(CmpBool::kTrue, reused.GetField(2)->CompareEquals(char_fields[1]));
+    ASSERT_TRUE(reused.GetField(3)->IsNull());
+  }
+}
+
+TEST(TupleTest, RowCodecTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 1, true, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 2, true, false),
+                                   new Column("age", TypeId::kTypeInt, 3, true, false),
+                                   new Column("city", TypeId::kTypeChar, 64, 4, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  RowCodec codec(schema.get());
+  // Scenario: the codec writes the bytes of Row::SerializeTo and reads them back, with and without nulls.
+  std::vector<std::vector<Field *>> rows_values = {
+      {&int_fields[0], &float_fields[0], &char_fields[1], &int_fields[1], &char_fields[2]},
+      {&null_fields[0], &float_fields[1], &char_fields[0], &int_fields[2], &char_fields[3]},
+      {&int_fields[3], &float_fields[2], &null_fields[2], &int_fields[4], &char_fields[1]},
+      {&null_fields[0], &null_fields[1], &null_fields[2], &null_fields[0], &null_fields[2]}};
+  char expected[PAGE_SIZE];
+  char buffer[PAGE_SIZE];
+  Row decoded;
+  for (auto &values : rows_values) {
+    std::vector<Field> fields;
+    for (auto value : values) {
+      fields.emplace_back(*value);
+    }
+    Row row(fields);
+    uint32_t size = row.SerializeTo(expected, schema.get());
+    ASSERT_EQ(size, codec.GetSerializedSize(row));
+    ASSERT_EQ(size, codec.SerializeTo(row, buffer));
+    ASSERT_EQ(0, memcmp(expected, buffer, size));
+    ASSERT_EQ(size, codec.DeserializeFrom(buffer, decoded));
+    ASSERT_EQ(fields.size(), decoded.GetFieldCount());
+    for (size_t i = 0; i < fields.size(); i++) {
+      ASSERT_EQ(fields[i].IsNull(), decoded.GetField(i)->IsNull());
+      if (!fields[i].IsNull()) {
+        ASSERT_EQ(CmpBool::kTrue, decoded.GetField(i)->CompareEquals(fields[i]));
+      }
+    }
+  }
+}
@@ -1,6 +1,13 @@
 #include "storage/disk_manager.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <stdexcept>
+#include <thread>
 #include <unordered_set>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -56,4 +63,249 @@ TEST(DiskManagerTest, FreePageAllocationTest) {
 	EXPECT_EQ(extent_nums * DiskManager::BITMAP_SIZE - 5, meta_page->GetAllocatedPages());
 	EXPECT_EQ(DiskManager::BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(0));
 	EXPECT_EQ(DiskManager::BITMAP_SIZE - 3, meta_page->GetExtentUsedPage(1));
-}
\ No newline at end of file
+}
+
+TEST(DiskManagerTest, ConcurrentReadTest) {
+	std::string db_name = "disk_concurrent_test.db";
+	remove(db_name.c_str());
+	const int num_pages = 64;
+	const int num_threads = 8;
+	auto* disk_mgr = new DiskManager(db_name);
+	char data[PAGE_SIZE];
+	for (int i = 0; i < num_pages; i++) {
+		ASSERT_EQ(i, disk_mgr->AllocatePage());
+		memset(data, 'a' + i % 26, PAGE_SIZE);
+		disk_mgr->WritePage(i, data);
+	}
+	// Scenario: a page that was never written reads back as zeros.
+	disk_mgr->ReadPage(num_pages, data);
+	EXPECT_EQ(0, data[0]);
+	EXPECT_EQ(0, data[PAGE_SIZE - 1]);
+	disk_mgr->Close();
+	delete disk_mgr;
+
+	// Scenario: after reopening, readers run in parallel and see every page intact.
+	disk_mgr = new DiskManager(db_name);
+	std::vector<int> mismatches(num_threads, 0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < num_threads; t++) {
+		threads.emplace_back([&, t]() {
+			char buf[PAGE_SIZE];
+			for (int round = 0; round < 16; round++) {
+				for (int i = t; i < num_pages; i += 3) {
+					disk_mgr->ReadPage(i, buf);
+					if (buf[0] != 'a' + i % 26 || buf[PAGE_USABLE_SIZE - 1] != 'a' + i % 26) mismatches[t]++;
+				}
+			}
+		});
+	}
+	for (auto& thread : threads) thread.join();
+	for (int t = 0; t < num_threads; t++) EXPECT_EQ(0, mismatches[t]);
+	EXPECT_FALSE(disk_mgr->IsPageFree(num_pages - 1));
+	EXPECT_TRUE(disk_mgr->IsPageFree(num_pages));
+	disk_mgr->Close();
+	delete disk_mgr;
+	remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, BitmapCheckpointTest) {
+	std::string db_name = "disk_checkpoint_test.db";
+	remove(db_name.c_str());
+	auto* disk_mgr = new DiskManager(db_name);
+	int extent_nums = 3;
+	for (uint32_t i = 0; i < DiskManager::BITMAP_SIZE * extent_nums; i++) {
+		ASSERT_EQ(i, disk_mgr->AllocatePage());
+	}
+	// Scenario: freed pages in an earlier extent are reused before the last extent is touched again.
+	disk_mgr->DeAllocatePage(DiskManager::BITMAP_SIZE + 7);
+	disk_mgr->DeAllocatePage(5);
+	EXPECT_EQ(5, disk_mgr->AllocatePage());
+	EXPECT_EQ(DiskManager::BITMAP_SIZE + 7, disk_mgr->AllocatePage());
+	EXPECT_EQ(DiskManager::BITMAP_SIZE * extent_nums, disk_mgr->AllocatePage());
+	disk_mgr->DeAllocatePage(10);
+	disk_mgr->Checkpoint();
+	disk_mgr->DeAllocatePage(11);
+	disk_mgr->Close();
+	delete disk_mgr;
+
+	// Scenario: bitmaps written back by the checkpoint and by close are read back after reopening.
+	disk_mgr = new DiskManager(db_name);
+	DiskFileMetaPage* meta_page = reinterpret_cast<DiskFileMetaPage*>(disk_mgr->GetMetaData());
+	EXPECT_EQ(extent_nums + 1, meta_page->GetExtentNums());
+	EXPECT_EQ(DiskManager::BITMAP_SIZE * extent_nums - 1, meta_page->GetAllocatedPages());
+	EXPECT_TRUE(disk_mgr->IsPageFree(10));
+	EXPECT_TRUE(disk_mgr->IsPageFree(11));
+	EXPECT_FALSE(disk_mgr->IsPageFree(12));
+	EXPECT_FALSE(disk_mgr->IsPageFree(DiskManager::BITMAP_SIZE * extent_nums));
+	EXPECT_TRUE(disk_mgr->IsPageFree(DiskManager::BITMAP_SIZE * (extent_nums + 2)));
+	EXPECT_EQ(10, disk_mgr->AllocatePage());
+	EXPECT_EQ(11, disk_mgr->AllocatePage());
+	disk_mgr->Close();
+	delete disk_mgr;
+	remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, PageRunTest) {
+	std::string db_name = "disk_run_test.db";
+	remove(db_name.c_str());
+	auto* disk_mgr = new DiskManager(db_name);
+	// Scenario: a run skips the holes that are too small for it, single pages still fill them.
+	for (int i = 0; i < 10; i++) {
+		ASSERT_EQ(i, disk_mgr->AllocatePage());
+	}
+	disk_mgr->DeAllocatePage(3);
+	disk_mgr->DeAllocatePage(4);
+	page_id_t start = disk_mgr->AllocatePageRun(DEFAULT_PAGE_RUN_SIZE);
+	EXPECT_EQ(10, start);
+	for (page_id_t i = start; i < start + static_cast<page_id_t>(DEFAULT_PAGE_RUN_SIZE); i++) {
+		EXPECT_FALSE(disk_mgr->IsPageFree(i));
+	}
+	EXPECT_EQ(3, disk_mgr->AllocatePage());
+	EXPECT_EQ(4, disk_mgr->AllocatePage());
+	EXPECT_EQ(start + DEFAULT_PAGE_RUN_SIZE, disk_mgr->AllocatePage());
+
+	// Scenario: a run that does not fit into the rest of an extent starts the next one.
+	page_id_t big_start = disk_mgr->AllocatePageRun(DiskManager::BITMAP_SIZE - 32);
+	EXPECT_EQ(DiskManager::BITMAP_SIZE, big_start);
+	DiskFileMetaPage* meta_page = reinterpret_cast<DiskFileMetaPage*>(disk_mgr->GetMetaData());
+	EXPECT_EQ(2, meta_page->GetExtentNums());
+	EXPECT_EQ(DiskManager::BITMAP_SIZE - 32, meta_page->GetExtentUsedPage(1));
+	EXPECT_EQ(INVALID_PAGE_ID, disk_mgr->AllocatePageRun(DiskManager::BITMAP_SIZE + 1));
+	disk_mgr->Close();
+	delete disk_mgr;
+	remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, ExtentGroupTest) {
+	std::string db_name = "disk_group_test.db";
+	remove(db_name.c_str());
+	const uint32_t extents_per_meta = 2;
+	auto* disk_mgr = new DiskManager(db_name, false, PageChecksumPolicy::kLog, extents_per_meta);
+	// Scenario: once the first meta page is full, extents are recorded by the next one in the chain.
+	const uint32_t num_pages = DiskManager::BITMAP_SIZE * 3 + 5;
+	for (uint32_t i = 0; i < num_pages; i++) {
+		ASSERT_EQ(i, disk_mgr->AllocatePage());
+	}
+	DiskFileMetaPage* meta_page = reinterpret_cast<DiskFileMetaPage*>(disk_mgr->GetMetaData());
+	EXPECT_EQ(extents_per_meta, meta_page->GetExtentNums());
+	EXPECT_EQ(DiskManager::BITMAP_SIZE * extents_per_meta, meta_page->GetAllocatedPages());
+	EXPECT_EQ(4, disk_mgr->GetExtentNums());
+	EXPECT_EQ(num_pages, disk_mgr->GetAllocatedPages());
+	// the second group starts with its meta page after the last extent of the first one
+	size_t group_pages = 1 + extents_per_meta * (DiskManager::BITMAP_SIZE + 1);
+	EXPECT_EQ((group_pages + 2) * PAGE_SIZE, disk_mgr->GetPageOffset(DiskManager::BITMAP_SIZE * extents_per_meta));
+	char data[PAGE_SIZE];
+	memset(data, 'g', PAGE_SIZE);
+	disk_mgr->WritePage(num_pages - 1, data);
+	disk_mgr->DeAllocatePage(DiskManager::BITMAP_SIZE * 3);
+	disk_mgr->Close();
+	delete disk_mgr;
+
+	// Scenario: the chain is followed when the file is opened again.
+	disk_mgr = new DiskManager(db_name, false, PageChecksumPolicy::kLog, extents_per_meta);
+	EXPECT_EQ(4, disk_mgr->GetExtentNums());
+	EXPECT_EQ(num_pages - 1, disk_mgr->GetAllocatedPages());
+	EXPECT_TRUE(disk_mgr->IsPageFree(DiskManager::BITMAP_SIZE * 3));
+	EXPECT_FALSE(disk_mgr->IsPageFree(num_pages - 1));
+	memset(data, 0, PAGE_SIZE);
+	disk_mgr->ReadPage(num_pages - 1, data);
+	EXPECT_EQ('g', data[0]);
+	EXPECT_EQ(0, disk_mgr->GetChecksumFailureCount());
+	EXPECT_EQ(DiskManager::BITMAP_SIZE * 3, disk_mgr->AllocatePage());
+	disk_mgr->Close();
+	delete disk_mgr;
+	remove(db_name.c_str());
+
+	// Scenario: offsets of page ids far beyond 4 GB do not overflow.
+	disk_mgr = new DiskManager(db_name);
+	EXPECT_GT(disk_mgr->GetPageOffset(MAX_VALID_PAGE_ID - 1), static_cast<size_t>(MAX_VALID_PAGE_ID) * PAGE_SIZE);
+	disk_mgr->Close();
+	delete disk_mgr;
+	remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, ShrinkFileTest) {
+	std::string db_name = "disk_shrink_test.db";
+	remove(db_name.c_str());
+	const uint32_t extents_per_meta = 1;
+	auto* disk_mgr = new DiskManager(db_name, false, PageChecksumPolicy::kLog, extents_per_meta);
+	const uint32_t num_pages = DiskManager::BITMAP_SIZE * 2 + 3;
+	for (uint32_t i = 0; i < num_pages; i++) {
+		ASSERT_EQ(i, disk_mgr->AllocatePage());
+	}
+	char data[PAGE_SIZE];
+	memset(data, 's', PAGE_SIZE);
+	disk_mgr->WritePage(num_pages - 1, data);
+	disk_mgr->WritePage(DiskManager::BITMAP_SIZE + 9, data);
+	disk_mgr->Checkpoint();
+	// Scenario: nothing is freed at the end of the file.
+	EXPECT_EQ(0, disk_mgr->ShrinkFile());
+	// Scenario: the last extent becomes empty and the one before it only keeps its first pages.
+	for (uint32_t i = DiskManager::BITMAP_SIZE + 10; i < num_pages; i++) {
+		disk_mgr->DeAllocatePage(i);
+	}
+	size_t old_size = std::filesystem::file_size(db_name);
+	size_t end = disk_mgr->GetPageOffset(DiskManager::BITMAP_SIZE + 9) + PAGE_SIZE;
+	EXPECT_EQ(old_size - end, disk_mgr->ShrinkFile());
+	EXPECT_EQ(end, std::filesystem::file_size(db_name));
+	EXPECT_EQ(2, disk_mgr->GetExtentNums());
+	memset(data, 0, PAGE_SIZE);
+	disk_mgr->ReadPage(DiskManager::BITMAP_SIZE + 9, data);
+	EXPECT_EQ('s', data[0]);
+	disk_mgr->Close();
+	delete disk_mgr;
+
+	// Scenario: the shrunk file opens with the remaining extents and grows again.
+	disk_mgr = new DiskManager(db_name, false, PageChecksumPolicy::kLog, extents_per_meta);
+	EXPECT_EQ(2, disk_mgr->GetExtentNums());
+	EXPECT_EQ(DiskManager::BITMAP_SIZE + 10, disk_mgr->GetAllocatedPages());
+	EXPECT_EQ(DiskManager::BITMAP_SIZE + 10, disk_mgr->AllocatePage());
+	EXPECT_EQ(0, disk_mgr->GetChecksumFailureCount());
+	disk_mgr->Close();
+	delete disk_mgr;
+	remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, FormatVersionTest) {
+	std::string db_name = "disk_version_test.db";
+	remove(db_name.c_str());
+	auto* disk_mgr = new DiskManager(db_name);
+	ASSERT_EQ(0, disk_mgr->AllocatePage());
+	EXPECT_EQ(DISK_FILE_FORMAT_VERSION, reinterpret_cast<DiskFileMetaPage*>(disk_mgr->GetMetaData())->GetFormatVersion());
+	disk_mgr->Close();
+	delete disk_mgr;
+	// Scenario: a file of the current version opens again.
+	disk_mgr = new DiskManager(db_name);
+	EXPECT_EQ(1, disk_mgr->GetAllocatedPages());
+	disk_mgr->Close();
+	delete disk_mgr;
+
+	// Scenario: a file written before the format was versioned, one extent with one page, is refused.
+	char meta[PAGE_SIZE];
+	memset(meta, 0, PAGE_SIZE);
+	auto* meta_page = reinterpret_cast<DiskFileMetaPage*>(meta);
+	meta_page->num_allocated_pages_ = 1;
+	meta_page->num_extents_ = 1;
+	int fd = open(db_name.c_str(), O_RDWR | O_TRUNC);
+	ASSERT_GE(fd, 0);
+	ASSERT_EQ(PAGE_SIZE, pwrite(fd, meta, PAGE_SIZE, 0));
+	close(fd);
+	EXPECT_THROW(DiskManager legacy(db_name), std::runtime_error);
+
+	// Scenario: so is a file of a newer version.
+	meta_page->SetFormatVersion(DISK_FILE_FORMAT_VERSION + 1);
+	fd = open(db_name.c_str(), O_RDWR);
+	ASSERT_GE(fd, 0);
+	ASSERT_EQ(PAGE_SIZE, pwrite(fd, meta, PAGE_SIZE, 0));
+	close(fd);
+	EXPECT_THROW(DiskManager newer(db_name), std::runtime_error);
+
+	// Scenario: and one of the previous version, whose table pages have a shorter header.
+	meta_page->SetFormatVersion(DISK_FILE_FORMAT_VERSION - 1);
+	fd = open(db_name.c_str(), O_RDWR);
+	ASSERT_GE(fd, 0);
+	ASSERT_EQ(PAGE_SIZE, pwrite(fd, meta, PAGE_SIZE, 0));
+	close(fd);
+	EXPECT_THROW(DiskManager older(db_name), std::runtime_error);
+	remove(db_name.c_str());
+}
@@ -0,0 +1,61 @@
+#include "storage/disk_scheduler.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(DiskSchedulerTest, ScheduleTest) {
+	const std::string db_name = "disk_scheduler_test.db";
+	const int num_pages = 64;
+	remove(db_name.c_str());
+	auto* disk_manager = new DiskManager(db_name);
+	for (int i = 0; i < num_pages; i++) {
+		ASSERT_EQ(i, disk_manager->AllocatePage());
+	}
+
+	{
+		DiskScheduler scheduler(disk_manager, 4);
+		// Scenario: writes of many pages are in flight at once, the caller's buffer may be reused after a copy.
+		char data[PAGE_SIZE];
+		std::vector<std::future<bool>> writes;
+		for (int i = 0; i < num_pages; i++) {
+			memset(data, 'a' + i % 26, PAGE_SIZE);
+			writes.push_back(scheduler.ScheduleWriteCopy(i, data));
+		}
+		for (auto& write : writes) EXPECT_TRUE(write.get());
+
+		// Scenario: a read scheduled after a write of the same page sees the written data.
+		std::vector<std::vector<char>> buffers(num_pages, std::vector<char>(PAGE_SIZE));
+		std::vector<std::future<bool>> reads;
+		for (int i = 0; i < num_pages; i++) {
+			memset(data, 'A' + i % 26, PAGE_SIZE);
+			scheduler.ScheduleWriteCopy(i, data);
+			reads.push_back(scheduler.ScheduleRead(i, buffers[i].data()));
+		}
+		for (int i = 0; i < num_pages; i++) {
+			EXPECT_TRUE(reads[i].get());
+			EXPECT_EQ('A' + i % 26, buffers[i][0]);
+			EXPECT_EQ('A' + i % 26, buffers[i][PAGE_USABLE_SIZE - 1]);
+		}
+
+		// Scenario: a synchronous read waits for the asynchronous write of the same page.
+		memset(data, 'z', PAGE_SIZE);
+		scheduler.ScheduleWriteCopy(0, data);
+		scheduler.ReadPage(0, buffers[0].data());
+		EXPECT_EQ('z', buffers[0][PAGE_SIZE / 2]);
+
+		// Scenario: the destructor completes requests that nobody waited for.
+		memset(data, 'y', PAGE_SIZE);
+		scheduler.ScheduleWriteCopy(1, data);
+	}
+	char data[PAGE_SIZE];
+	disk_manager->ReadPage(1, data);
+	EXPECT_EQ('y', data[0]);
+
+	disk_manager->Close();
+	delete disk_manager;
+	remove(db_name.c_str());
+}
@@ -0,0 +1,73 @@
+#include "storage/free_space_map.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+static std::string db_file_name = "free_space_map_test.db";
+
+TEST(FreeSpaceMapTest, FindUpdateRemoveTest) {
+	remove(db_file_name.c_str());
+	auto disk_mgr = new DiskManager(db_file_name);
+	auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+	FreeSpaceMap map(bpm);
+	page_id_t first_page_id = map.Create();
+	ASSERT_NE(INVALID_PAGE_ID, first_page_id);
+	EXPECT_EQ(INVALID_PAGE_ID, map.FindPage(1));
+
+	// Scenario: more heap pages than one map page holds, page i has i % 50 categories of free space.
+	const uint32_t num_pages = FreeSpaceMapPage::CAPACITY * 2 + 10;
+	for (uint32_t i = 0; i < num_pages; i++) {
+		map.Update(100000 + i, (i % 50) * FreeSpaceMap::CATEGORY_SIZE);
+	}
+	EXPECT_EQ(num_pages, map.GetPageCount());
+	page_id_t page_id = map.FindPage(30 * FreeSpaceMap::CATEGORY_SIZE - 1);
+	ASSERT_NE(INVALID_PAGE_ID, page_id);
+	EXPECT_EQ(30, (page_id - 100000) % 50);
+	EXPECT_EQ(INVALID_PAGE_ID, map.FindPage(50 * FreeSpaceMap::CATEGORY_SIZE));
+
+	// Scenario: a page filled up is no longer returned, one that gained room is.
+	for (uint32_t i = 0; i < num_pages; i++) {
+		if ((i % 50) >= 40) map.Update(100000 + i, 0);
+	}
+	EXPECT_EQ(INVALID_PAGE_ID, map.FindPage(40 * FreeSpaceMap::CATEGORY_SIZE));
+	map.Update(100000 + 7, PAGE_SIZE);
+	EXPECT_EQ(100000 + 7, map.FindPage(60 * FreeSpaceMap::CATEGORY_SIZE));
+
+	// Scenario: removed pages are forgotten, the chain shrinks.
+	for (uint32_t i = FreeSpaceMapPage::CAPACITY; i < num_pages; i++) {
+		map.Remove(100000 + i);
+	}
+	EXPECT_EQ(FreeSpaceMapPage::CAPACITY, map.GetPageCount());
+	map.Remove(100000 + 7);
+	EXPECT_EQ(INVALID_PAGE_ID, map.FindPage(60 * FreeSpaceMap::CATEGORY_SIZE));
+
+	// Scenario: the map is read back from its pages.
+	FreeSpaceMap loaded(bpm);
+	ASSERT_TRUE(loaded.Load(first_page_id));
+	EXPECT_EQ(FreeSpaceMapPage::CAPACITY - 1, loaded.GetPageCount());
+	page_id = loaded.FindPage(39 * FreeSpaceMap::CATEGORY_SIZE);
+	ASSERT_NE(INVALID_PAGE_ID, page_id);
+	EXPECT_EQ(39, (page_id - 100000) % 50);
+	EXPECT_EQ(INVALID_PAGE_ID, loaded.FindPage(40 * FreeSpaceMap::CATEGORY_SIZE));
+
+	// Scenario: a page id that does not lead to a map page, e.g. read from a page of another layout, is not trusted.
+	page_id_t other_page_id;
+	ASSERT_NE(nullptr, bpm->NewPage(other_page_id));
+	memset(bpm->FetchPage(other_page_id)->GetData(), 0x7f, PAGE_USABLE_SIZE);
+	bpm->UnpinPage(other_page_id, true);
+	bpm->UnpinPage(other_page_id, true);
+	FreeSpaceMap other(bpm);
+	EXPECT_FALSE(other.Load(other_page_id));
+	EXPECT_FALSE(other.Load(other_page_id + 100));
+	EXPECT_FALSE(other.Load(-7));
+	other.Destroy(other_page_id);
+	EXPECT_FALSE(bpm->IsPageFree(other_page_id));
+
+	loaded.Destroy(first_page_id);
+	EXPECT_TRUE(bpm->IsPageFree(first_page_id));
+	EXPECT_TRUE(bpm->CheckAllUnpinned());
+	delete bpm;
+	delete disk_mgr;
+	remove(db_file_name.c_str());
+}
@@ -0,0 +1,114 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/crc32c.h"
+#include "gtest/gtest.h"
+#include "storage/disk_manager.h"
+
+TEST(PageChecksumTest, Crc32cTest) {
+	// Scenario: the standard check value and the test vectors of RFC 3720.
+	const char* check = "123456789";
+	EXPECT_EQ(0xE3069283u, Crc32c(check, strlen(check)));
+	EXPECT_EQ(0xE3069283u, Crc32cSoftware(check, strlen(check)));
+	char zeros[32] = {0};
+	EXPECT_EQ(0x8A9136AAu, Crc32c(zeros, sizeof(zeros)));
+	char ones[32];
+	memset(ones, 0xFF, sizeof(ones));
+	EXPECT_EQ(0x62A8AB43u, Crc32c(ones, sizeof(ones)));
+
+	// Scenario: hardware and software agree on any length and alignment, and checksums can be continued.
+	std::mt19937 rng(0);
+	std::vector<char> data(PAGE_SIZE + 16);
+	for (char& c : data) c = static_cast<char>(rng());
+	for (size_t offset = 0; offset < 8; offset++) {
+		for (size_t len : {0, 1, 7, 8, 9, 63, 1000, PAGE_SIZE}) {
+			ASSERT_EQ(Crc32cSoftware(data.data() + offset, len), Crc32c(data.data() + offset, len));
+		}
+	}
+	EXPECT_EQ(Crc32c(data.data(), PAGE_SIZE), Crc32c(data.data() + 100, PAGE_SIZE - 100, Crc32c(data.data(), 100)));
+}
+
+TEST(PageChecksumTest, TornWriteTest) {
+	std::string db_name = "page_checksum_test.db";
+	remove(db_name.c_str());
+	auto* disk_mgr = new DiskManager(db_name);
+	char data[PAGE_SIZE];
+	for (int i = 0; i < 4; i++) {
+		ASSERT_EQ(i, disk_mgr->AllocatePage());
+		memset(data, 'a' + i, PAGE_SIZE);
+		disk_mgr->WritePage(i, data);
+		// Scenario: the checksum is written to disk only, the caller's buffer is left as it is.
+		ASSERT_EQ('a' + i, data[PAGE_SIZE - 1]);
+	}
+
+	// Scenario: intact pages and pages that were never written pass verification.
+	for (int i = 0; i < 5; i++) {
+		disk_mgr->ReadPage(i, data);
+	}
+	EXPECT_EQ(0, disk_mgr->GetChecksumFailureCount());
+
+	// Scenario: only the first half of a new version of page 1 reaches the disk.
+	memset(data, 'x', PAGE_SIZE);
+	DiskManager::StampChecksum(data);
+	int fd = open(db_name.c_str(), O_RDWR);
+	ASSERT_GE(fd, 0);
+	ASSERT_EQ(PAGE_SIZE / 2, pwrite(fd, data, PAGE_SIZE / 2, disk_mgr->GetPageOffset(1)));
+	// Scenario: a single bit flips in page 2.
+	char byte;
+	ASSERT_EQ(1, pread(fd, &byte, 1, disk_mgr->GetPageOffset(2) + 100));
+	byte ^= 0x10;
+	ASSERT_EQ(1, pwrite(fd, &byte, 1, disk_mgr->GetPageOffset(2) + 100));
+	close(fd);
+
+	disk_mgr->ReadPage(1, data);
+	EXPECT_EQ(1, disk_mgr->GetChecksumFailureCount());
+	disk_mgr->ReadPage(2, data);
+	EXPECT_EQ(2, disk_mgr->GetChecksumFailureCount());
+	disk_mgr->ReadPage(3, data);
+	EXPECT_EQ(2, disk_mgr->GetChecksumFailureCount());
+
+	// Scenario: with kIgnore the corrupted pages are not verified, rewriting a page repairs it.
+	disk_mgr->SetChecksumPolicy(PageChecksumPolicy::kIgnore);
+	disk_mgr->ReadPage(1, data);
+	EXPECT_EQ(2, disk_mgr->GetChecksumFailureCount());
+	disk_mgr->SetChecksumPolicy(PageChecksumPolicy::kLog);
+	disk_mgr->WritePage(1, data);
+	disk_mgr->ReadPage(1, data);
+	EXPECT_EQ(2, disk_mgr->GetChecksumFailureCount());
+	disk_mgr->Close();
+	delete disk_mgr;
+	remove(db_name.c_str());
+}
+
+TEST(PageChecksumTest, ChecksumCostBenchmark) {
+	const int num_pages = 64;
+	const int rounds = 2000;
+	std::mt19937 rng(0);
+	std::vector<char> pages(static_cast<size_t>(num_pages) * PAGE_SIZE);
+	for (char& c : pages) c = static_cast<char>(rng());
+
+	auto measure = [&](uint32_t (*crc)(const char*, size_t, uint32_t)) {
+		uint32_t sink = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int r = 0; r < rounds; r++) {
+			for (int i = 0; i < num_pages; i++) {
+				sink ^= crc(pages.data() + static_cast<size_t>(i) * PAGE_SIZE, PAGE_USABLE_SIZE, 0);
+			}
+		}
+		auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		EXPECT_NE(0xFFFFFFFFu, sink);
+		return elapsed / (static_cast<double>(rounds) * num_pages);
+	};
+	double hardware_ns = measure(&Crc32c);
+	double software_ns = measure(&Crc32cSoftware);
+	printf("[ CHECKSUM ] CRC32C per 4 KB page: %.0f ns (%s), table driven: %.0f ns\n", hardware_ns,
+	       Crc32cIsHardwareAccelerated() ? "crc32 instruction" : "table driven", software_ns);
+	EXPECT_GT(hardware_ns, 0);
+}
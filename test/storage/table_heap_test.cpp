@@ -62,3 +62,401 @@ TEST(TableHeapTest, TableHeapSampleTest) {
 	}
 	ASSERT_EQ(size, 0);
 }
+
+TEST(TableHeapTest, VacuumTest) {
+	remove(db_file_name.c_str());
+	auto disk_mgr_ = new DiskManager(db_file_name);
+	auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+	const int row_nums = 3000;
+	std::vector<Column*> columns = { new Column("id", TypeId::kTypeInt, 0, false, false),
+									 new Column("name", TypeId::kTypeChar, 64, 1, true, false) };
+	auto schema = std::make_shared<Schema>(columns);
+	TableHeap* table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+	auto count_pages = [&]() {
+		uint32_t pages = 0;
+		for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID; pages++) {
+			ReadPageGuard guard = bpm_->FetchPageRead(page_id);
+			page_id = reinterpret_cast<TablePage*>(guard.GetPage())->GetNextPageId();
+		}
+		return pages;
+	};
+	std::vector<RowId> rids;
+	char characters[64];
+	memset(characters, 'v', sizeof(characters));
+	for (int i = 0; i < row_nums; i++) {
+		Fields fields{ Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 64, true) };
+		Row row(fields);
+		ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+		rids.push_back(row.GetRowId());
+	}
+	uint32_t old_pages = count_pages();
+	// keep every fourth row, the kept rows are spread over all pages
+	for (int i = 0; i < row_nums; i++) {
+		if (i % 4 != 0) {
+			ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+		}
+	}
+	std::unordered_map<int64_t, int64_t> moved;
+	auto on_move = [&](const RowId& old_rid, Row& row) { moved[old_rid.Get()] = row.GetRowId().Get(); };
+	TableHeap::VacuumCursor cursor;
+	uint32_t steps = 0;
+	// reclaim the deleted tuples, which finds the tail
+	while (!cursor.started_ || cursor.reclaim_page_id_ != INVALID_PAGE_ID) {
+		ASSERT_TRUE(table_heap->VacuumStep(cursor, on_move, nullptr));
+	}
+	// Scenario: a tail someone pins is emptied but stays in the chain until a later step can delete it.
+	page_id_t tail_page_id = cursor.tail_page_id_;
+	ASSERT_NE(nullptr, bpm_->FetchPage(tail_page_id));
+	ASSERT_TRUE(table_heap->VacuumStep(cursor, on_move, nullptr));
+	EXPECT_EQ(0, cursor.freed_pages_);
+	EXPECT_EQ(tail_page_id, cursor.tail_page_id_);
+	EXPECT_EQ(old_pages, count_pages());
+	EXPECT_FALSE(bpm_->IsPageFree(tail_page_id));
+	bpm_->UnpinPage(tail_page_id, false);
+	while (table_heap->VacuumStep(cursor, on_move, nullptr)) {
+		steps++;
+		ASSERT_LT(steps, 10 * old_pages);
+	}
+	uint32_t new_pages = count_pages();
+	EXPECT_EQ(old_pages - cursor.freed_pages_, new_pages);
+	EXPECT_LE(new_pages, old_pages / 3);
+	EXPECT_TRUE(bpm_->CheckAllUnpinned());
+	// every kept row is still there, possibly under a new row id
+	int found = 0;
+	for (int i = 0; i < row_nums; i += 4) {
+		RowId rid = rids[i];
+		if (moved.count(rid.Get())) rid = RowId(moved[rid.Get()]);
+		Row row(rid);
+		ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+		ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+		found++;
+	}
+	int scanned = 0;
+	for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it) scanned++;
+	EXPECT_EQ(found, scanned);
+	// the heap keeps working after the vacuum
+	Fields fields{ Field(TypeId::kTypeInt, row_nums), Field(TypeId::kTypeChar, characters, 64, true) };
+	Row row(fields);
+	ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+	EXPECT_EQ(new_pages, count_pages());
+	delete table_heap;
+	delete bpm_;
+	delete disk_mgr_;
+	remove(db_file_name.c_str());
+}
+
+TEST(TableHeapTest, VacuumResumeAfterGrowthTest) {
+	remove(db_file_name.c_str());
+	auto disk_mgr_ = new DiskManager(db_file_name);
+	auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+	const int row_nums = 2000;
+	std::vector<Column*> columns = { new Column("id", TypeId::kTypeInt, 0, false, false),
+									 new Column("name", TypeId::kTypeChar, 64, 1, true, false) };
+	auto schema = std::make_shared<Schema>(columns);
+	TableHeap* table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+	std::unordered_map<int64_t, int> ids;
+	char characters[64];
+	memset(characters, 'v', sizeof(characters));
+	auto insert = [&](int id) {
+		Fields fields{ Field(TypeId::kTypeInt, id), Field(TypeId::kTypeChar, characters, 64, true) };
+		Row row(fields);
+		ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+		ids[row.GetRowId().Get()] = id;
+	};
+	for (int i = 0; i < row_nums; i++) insert(i);
+	for (auto it = ids.begin(); it != ids.end();) {
+		if (it->second % 2 != 0) {
+			ASSERT_TRUE(table_heap->MarkDelete(RowId(it->first), nullptr));
+			it = ids.erase(it);
+		} else {
+			++it;
+		}
+	}
+	auto on_move = [&](const RowId& old_rid, Row& row) {
+		ids[row.GetRowId().Get()] = ids[old_rid.Get()];
+		ids.erase(old_rid.Get());
+	};
+	TableHeap::VacuumCursor cursor;
+	while (!cursor.started_ || cursor.reclaim_page_id_ != INVALID_PAGE_ID) {
+		ASSERT_TRUE(table_heap->VacuumStep(cursor, on_move, nullptr));
+	}
+	ASSERT_TRUE(table_heap->VacuumStep(cursor, on_move, nullptr));
+	// Scenario: the heap grows past the tail of a paused vacuum, which starts over instead of cutting off new pages.
+	for (int i = row_nums; i < 3 * row_nums; i++) insert(i);
+	// and frees room in front for the tuples of the tail
+	for (auto it = ids.begin(); it != ids.end();) {
+		if (it->second < 200) {
+			table_heap->ApplyDelete(RowId(it->first), nullptr);
+			it = ids.erase(it);
+		} else {
+			++it;
+		}
+	}
+	uint32_t steps = 0;
+	while (table_heap->VacuumStep(cursor, on_move, nullptr)) {
+		ASSERT_LT(++steps, 10000);
+	}
+	EXPECT_TRUE(bpm_->CheckAllUnpinned());
+	size_t scanned = 0;
+	for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it) {
+		ASSERT_EQ(1, ids.count(it->GetRowId().Get()));
+		ASSERT_EQ(CmpBool::kTrue, it->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, ids[it->GetRowId().Get()])));
+		scanned++;
+	}
+	EXPECT_EQ(ids.size(), scanned);
+	EXPECT_EQ(row_nums / 2 - 100 + 2 * row_nums, scanned);
+	delete table_heap;
+	delete bpm_;
+	delete disk_mgr_;
+	remove(db_file_name.c_str());
+}
+
+TEST(TableHeapTest, FreeSpaceReuseTest) {
+	remove(db_file_name.c_str());
+	auto disk_mgr_ = new DiskManager(db_file_name);
+	auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+	const int row_nums = 2000;
+	std::vector<Column*> columns = { new Column("id", TypeId::kTypeInt, 0, false, false),
+									 new Column("name", TypeId::kTypeChar, 64, 1, true, false) };
+	auto schema = std::make_shared<Schema>(columns);
+	TableHeap* table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+	auto count_pages = [&]() {
+		uint32_t pages = 0;
+		for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID; pages++) {
+			ReadPageGuard guard = bpm_->FetchPageRead(page_id);
+			page_id = reinterpret_cast<TablePage*>(guard.GetPage())->GetNextPageId();
+		}
+		return pages;
+	};
+	char characters[64];
+	memset(characters, 'f', sizeof(characters));
+	auto insert_rows = [&](int from, int to, std::vector<RowId>& rids) {
+		for (int i = from; i < to; i++) {
+			Fields fields{ Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 64, true) };
+			Row row(fields);
+			ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+			rids.push_back(row.GetRowId());
+		}
+	};
+	auto delete_rows = [&](std::vector<RowId>& rids, size_t from, size_t to) {
+		for (size_t i = from; i < to; i++) {
+			ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+			table_heap->ApplyDelete(rids[i], nullptr);
+		}
+	};
+	std::vector<RowId> rids;
+	insert_rows(0, row_nums, rids);
+	uint32_t pages = count_pages();
+	// Scenario: rows deleted from the front pages make room for new rows, the heap does not grow.
+	delete_rows(rids, 0, row_nums / 2);
+	std::vector<RowId> new_rids;
+	insert_rows(row_nums, row_nums + row_nums / 2, new_rids);
+	EXPECT_EQ(pages, count_pages());
+	page_id_t first_page_id = table_heap->GetFirstPageId();
+	delete table_heap;
+	delete bpm_;
+	delete disk_mgr_;
+
+	// Scenario: the map persists, a reopened heap reuses space freed before and after reopening.
+	disk_mgr_ = new DiskManager(db_file_name);
+	bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+	table_heap = TableHeap::Create(bpm_, first_page_id, schema.get(), nullptr, nullptr);
+	delete_rows(rids, row_nums / 2, row_nums);
+	std::vector<RowId> more_rids;
+	insert_rows(row_nums * 2, row_nums * 2 + row_nums / 2, more_rids);
+	EXPECT_EQ(pages, count_pages());
+	int scanned = 0;
+	for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it) scanned++;
+	EXPECT_EQ(row_nums, scanned);
+	EXPECT_TRUE(bpm_->CheckAllUnpinned());
+	delete table_heap;
+	delete bpm_;
+	delete disk_mgr_;
+	remove(db_file_name.c_str());
+}
+
+TEST(TableHeapTest, ReopenThenModifyTest) {
+	remove(db_file_name.c_str());
+	auto disk_mgr_ = new DiskManager(db_file_name);
+	auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+	std::vector<Column*> columns = { new Column("id", TypeId::kTypeInt, 0, false, false),
+									 new Column("name", TypeId::kTypeChar, 64, 1, true, false) };
+	auto schema = std::make_shared<Schema>(columns);
+	TableHeap* table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+	char characters[64];
+	memset(characters, 'r', sizeof(characters));
+	std::vector<RowId> rids;
+	for (int i = 0; i < 4; i++) {
+		Fields fields{ Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 8, true) };
+		Row row(fields);
+		ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+		rids.push_back(row.GetRowId());
+	}
+	ASSERT_EQ(table_heap->GetFirstPageId(), rids[0].GetPageId());
+	ASSERT_TRUE(table_heap->MarkDelete(rids[0], nullptr));
+	page_id_t first_page_id = table_heap->GetFirstPageId();
+	auto reopen = [&]() {
+		delete table_heap;
+		delete bpm_;
+		delete disk_mgr_;
+		disk_mgr_ = new DiskManager(db_file_name);
+		bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+		table_heap = TableHeap::Create(bpm_, first_page_id, schema.get(), nullptr, nullptr);
+	};
+
+	// Scenario: the first operation of a reopened heap deletes a tuple of its first page, the page that holds the
+	// free space map id.
+	reopen();
+	table_heap->ApplyDelete(rids[0], nullptr);
+	EXPECT_TRUE(bpm_->CheckAllUnpinned());
+
+	// Scenario: the same for an update that fits into the page, and one that has to move the tuple.
+	reopen();
+	Fields fields{ Field(TypeId::kTypeInt, 11), Field(TypeId::kTypeChar, characters, 8, true) };
+	Row row(fields);
+	ASSERT_TRUE(table_heap->UpdateTuple(row, rids[1], nullptr));
+	reopen();
+	Fields large_fields{ Field(TypeId::kTypeInt, 12), Field(TypeId::kTypeChar, characters, 64, true) };
+	Row large_row(large_fields);
+	ASSERT_TRUE(table_heap->UpdateTuple(large_row, rids[2], nullptr));
+	Row updated(rids[1]);
+	ASSERT_TRUE(table_heap->GetTuple(&updated, nullptr));
+	EXPECT_EQ(CmpBool::kTrue, updated.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, 11)));
+	EXPECT_TRUE(bpm_->CheckAllUnpinned());
+	delete table_heap;
+	delete bpm_;
+	delete disk_mgr_;
+	remove(db_file_name.c_str());
+}
+
+TEST(TableHeapTest, BulkInsertTest) {
+	remove(db_file_name.c_str());
+	auto disk_mgr_ = new DiskManager(db_file_name);
+	auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+	const int row_nums = 10000;
+	std::vector<Column*> columns = { new Column("id", TypeId::kTypeInt, 0, false, false),
+									 new Column("name", TypeId::kTypeChar, 64, 1, true, false) };
+	auto schema = std::make_shared<Schema>(columns);
+	char characters[64];
+	memset(characters, 'b', sizeof(characters));
+	std::vector<Row> rows;
+	for (int i = 0; i < row_nums; i++) {
+		Fields fields{ Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 1 + i % 64, true) };
+		rows.emplace_back(fields);
+	}
+	// rows inserted one by one and in bulk end up on the same number of pages
+	TableHeap* single_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+	for (auto row : rows) {
+		ASSERT_TRUE(single_heap->InsertTuple(row, nullptr));
+	}
+	TableHeap* bulk_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+	ASSERT_EQ(row_nums, bulk_heap->InsertTuples(rows, nullptr));
+	EXPECT_TRUE(bpm_->CheckAllUnpinned());
+	auto count_pages = [&](TableHeap* table_heap) {
+		uint32_t pages = 0;
+		for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID; pages++) {
+			ReadPageGuard guard = bpm_->FetchPageRead(page_id);
+			page_id = reinterpret_cast<TablePage*>(guard.GetPage())->GetNextPageId();
+		}
+		return pages;
+	};
+	EXPECT_EQ(count_pages(single_heap), count_pages(bulk_heap));
+	for (int i = 0; i < row_nums; i++) {
+		Row row(rows[i].GetRowId());
+		ASSERT_TRUE(bulk_heap->GetTuple(&row, nullptr));
+		ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+	}
+	int scanned = 0;
+	for (auto it = bulk_heap->Begin(nullptr); it != bulk_heap->End(); ++it) scanned++;
+	EXPECT_EQ(row_nums, scanned);
+	// a row that does not fit into any page ends the bulk insert
+	const uint32_t max_len = VARCHAR_MAX_LEN - 1;
+	std::vector<char> large(max_len, 'l');
+	std::vector<Column*> large_columns = { new Column("a", TypeId::kTypeChar, max_len, 0, true, false),
+										   new Column("b", TypeId::kTypeChar, max_len, 1, true, false) };
+	auto large_schema = std::make_shared<Schema>(large_columns);
+	TableHeap* large_heap = TableHeap::Create(bpm_, large_schema.get(), nullptr, nullptr, nullptr);
+	std::vector<Row> large_rows;
+	for (uint32_t len : { 10U, max_len, 10U }) {
+		Fields fields{ Field(TypeId::kTypeChar, large.data(), len, true),
+					   Field(TypeId::kTypeChar, large.data(), len, true) };
+		large_rows.emplace_back(fields);
+	}
+	EXPECT_EQ(1, large_heap->InsertTuples(large_rows, nullptr));
+	delete single_heap;
+	delete bulk_heap;
+	delete large_heap;
+	delete bpm_;
+	delete disk_mgr_;
+	remove(db_file_name.c_str());
+}
+
+TEST(TableHeapTest, BatchScanTest) {
+	remove(db_file_name.c_str());
+	auto disk_mgr_ = new DiskManager(db_file_name);
+	auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+	const int row_nums = 5000;
+	std::vector<Column*> columns = { new Column("id", TypeId::kTypeInt, 0, false, false),
+									 new Column("name", TypeId::kTypeChar, 64, 1, true, false) };
+	auto schema = std::make_shared<Schema>(columns);
+	TableHeap* table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+	char characters[64];
+	memset(characters, 'c', sizeof(characters));
+	std::vector<RowId> rids;
+	std::unordered_map<int64_t, int> id_of;
+	for (int i = 0; i < row_nums; i++) {
+		Fields fields{ Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 1 + i % 64, true) };
+		Row row(fields);
+		ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+		rids.push_back(row.GetRowId());
+		id_of[row.GetRowId().Get()] = i;
+	}
+	// deleted rows are left out, every third one
+	for (int i = 0; i < row_nums; i += 3) {
+		ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+		if (i % 2 == 0) table_heap->ApplyDelete(rids[i], nullptr);
+	}
+	// every live row is read once, page by page in slot order
+	TableBatch batch;
+	std::vector<bool> seen(row_nums, false);
+	int scanned = 0;
+	while (table_heap->NextBatch(batch, nullptr)) {
+		ASSERT_GT(batch.size_, 0);
+		for (size_t j = 0; j < batch.size_; j++) {
+			Row& row = batch.rows_[j];
+			ASSERT_EQ(1, id_of.count(row.GetRowId().Get()));
+			int id = id_of[row.GetRowId().Get()];
+			ASSERT_NE(0, id % 3);
+			ASSERT_FALSE(seen[id]);
+			seen[id] = true;
+			ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, id)));
+			ASSERT_EQ(1 + id % 64, row.GetField(1)->GetLength());
+			if (j > 0) {
+				ASSERT_LT(batch.rows_[j - 1].GetRowId().GetSlotNum(), row.GetRowId().GetSlotNum());
+			}
+			scanned++;
+		}
+	}
+	EXPECT_EQ(row_nums - (row_nums + 2) / 3, scanned);
+	EXPECT_EQ(0, batch.size_);
+	EXPECT_TRUE(bpm_->CheckAllUnpinned());
+	// the iterator yields the same rows, also when it starts in the middle of the heap
+	int iterated = 0;
+	for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it) {
+		ASSERT_TRUE(seen[id_of[it->GetRowId().Get()]]);
+		iterated++;
+	}
+	EXPECT_EQ(scanned, iterated);
+	int from_middle = 0;
+	for (TableIterator it(table_heap, rids[row_nums / 2], nullptr); it != table_heap->End(); ++it) from_middle++;
+	EXPECT_GT(from_middle, 0);
+	EXPECT_LT(from_middle, scanned);
+	EXPECT_EQ(rids[row_nums / 2], (*TableIterator(table_heap, rids[row_nums / 2], nullptr)).GetRowId());
+	// a deleted row id starts at the next live row
+	ASSERT_EQ(0, (row_nums / 2 + 2) % 3);
+	EXPECT_EQ(rids[row_nums / 2 + 3], (*TableIterator(table_heap, rids[row_nums / 2 + 2], nullptr)).GetRowId());
+	delete table_heap;
+	delete bpm_;
+	delete disk_mgr_;
+	remove(db_file_name.c_str());
+}